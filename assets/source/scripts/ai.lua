@@ -34,6 +34,19 @@ function AI_FindAttractant(Buff, Enemies)
 	return EnemyIndex
 end
 
+-- Run AI for all monsters on one side that are ready for an action
+
+AI_Batch = {}
+
+function AI_Batch.Update(self, Ready, Enemies, Allies)
+	for i = 1, #Ready do
+		local AI = _G[Ready[i].AI]
+		if type(AI) == "table" and type(AI.Update) == "function" then
+			AI:Update(Allies[Ready[i].Index], Enemies, Allies)
+		end
+	end
+end
+
 -- Attack random target
 
 AI_Dumb = {}
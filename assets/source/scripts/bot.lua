@@ -31,94 +31,6 @@ function GetDirection(InputState)
 	return { 0, 0 }
 end
 
--- Return a list of map ids in Path that get from Current to Target. Return true on found
-function FindMap(Current, Target, Path)
-
-	local Set = {}
-	local Parents = {}
-	local Queue = {}
-
-	-- Add root node
-	Set[Current] = 1
-	table.insert(Queue, 1, Current)
-
-	-- Iterate over queue
-	while next(Queue) ~= nil do
-		Next = table.remove(Queue, 1)
-
-		-- Found target
-		if Next == Target then
-
-			-- Build path
-			Parent = Parents[Next]
-			while Parent ~= nil do
-				table.insert(Path, 1, Parent)
-				Parent = Parents[Parent]
-			end
-			table.insert(Path, Target)
-
-			return true
-		end
-
-		-- Add adjacent nodes
-		local Connected = Paths[Next]
-		if Connected ~= nil then
-			for i = 1, #Connected do
-				Adjacent = Connected[i]
-				if Set[Adjacent] == nil then
-					Set[Adjacent] = 1
-					Parents[Adjacent] = Next
-					table.insert(Queue, 1, Adjacent)
-				end
-			end
-		end
-
-	end
-
-	return false
-end
-
--- Paths is a structure that stores map connections --
-
-Paths = {
-	[1] = { 2, 4, 5, 6, 7, 8, 10 },
-	[2] = { 1, 3 },
-	[3] = { 2, 34 },
-	[4] = { 1 },
-	[5] = { 1 },
-	[6] = { 1 },
-	[7] = { 1 },
-	[8] = { 1 },
-	[10] = { 1, 11, 12, 14, 16, 18, 20, 30, 41, 44, 47, 50 },
-	[11] = { 10, 44 },
-	[12] = { 10, 14 },
-	[14] = { 10, 12, 15 },
-	[15] = { 14 },
-	[16] = { 10, 17, 34 },
-	[17] = { 16 },
-	[18] = { 10, 11 },
-	[20] = { 10, 21, 22 },
-	[21] = { 20 },
-	[22] = { 20, 23, 26 },
-	[23] = { 22, 24 },
-	[24] = { 23, 25 },
-	[25] = { 24, 26 },
-	[26] = { 22, 25 },
-	[30] = { 10, 31, 32, 33 },
-	[31] = { 30 },
-	[32] = { 30 },
-	[33] = { 30 },
-	[34] = { 3, 20, 30 },
-	[41] = { 10, 42 },
-	[42] = { 41 },
-	[44] = { 10, 11, 46 },
-	[45] = { 1, 20, 30, 50, 51 },
-	[46] = { 44 },
-	[47] = { 10, 51 },
-	[50] = { 10, 51 },
-	[51] = { 45, 47, 50 },
-}
-
 -- Vendor to MapID --
 
 Vendors = {
@@ -180,23 +92,22 @@ Builds = {
 	}
 }
 
--- Bot that runs on the server --
+-- Bot behavior and starting state --
 
-Bot_Server = {}
-Bot_Server.GoalState = GOAL_NONE
-Bot_Server.MoveState = MOVE_IDLE
-Bot_Server.SellSlot = -1
-Bot_Server.BuyID = 0
-Bot_Server.VendorID = 0
-Bot_Server.UpgradeID = 0
-Bot_Server.Timer = 0
-Bot_Server.MoveCount = 0
-Bot_Server.TargetMapID = 0
-Bot_Server.MapPath = nil
-Bot_Server.Build = Builds[1]
+Bot_Base = {}
+Bot_Base.GoalState = GOAL_NONE
+Bot_Base.MoveState = MOVE_IDLE
+Bot_Base.SellSlot = -1
+Bot_Base.BuyID = 0
+Bot_Base.VendorID = 0
+Bot_Base.UpgradeID = 0
+Bot_Base.Timer = 0
+Bot_Base.MoveCount = 0
+Bot_Base.TargetMapID = 0
+Bot_Base.Build = Builds[1]
 
 -- Update bot behavior when outside of battle
-function Bot_Server.Update(self, FrameTime, Object)
+function Bot_Base.Update(self, FrameTime, Object)
 	--print("goal=" .. self.GoalState .. " gold=" .. Object.Gold .. " map=" .. Object.MapID .. " x=" .. Object.X .. " y=" .. Object.Y .. " timer=" .. self.Timer)
 
 	if Object.Health <= 0 then
@@ -251,16 +162,26 @@ function Bot_Server.Update(self, FrameTime, Object)
 	self.Timer = self.Timer + FrameTime
 end
 
--- Pathfind to next map in MapPath
-function Bot_Server.TraverseMap(self, Object)
-	if Object.MapID == self.TargetMapID or self.MapPath == nil or next(self.MapPath) == nil then
+-- Pathfind to next map on the route to TargetMapID
+function Bot_Base.TraverseMap(self, Object)
+	if Object.MapID == self.TargetMapID then
 		return true
 	end
 
-	i, NextMapID = next(self.MapPath)
-	if Object.MapID == NextMapID then
-		table.remove(self.MapPath, 1)
-		i, NextMapID = next(self.MapPath)
+	-- Wait for routes to finish building
+	NextMapID = Object.NextMapHop(self.TargetMapID)
+	if NextMapID == 0 then
+		return false
+	end
+
+	-- Report bots that can't leave their map
+	if NextMapID == nil then
+		if self.NoRouteMapID ~= self.TargetMapID then
+			print("Bot has no route from map " .. Object.MapID .. " to map " .. self.TargetMapID)
+			self.NoRouteMapID = self.TargetMapID
+		end
+
+		return true
 	end
 
 	X, Y = Object.FindEvent(3, NextMapID)
@@ -274,19 +195,13 @@ function Bot_Server.TraverseMap(self, Object)
 	end
 end
 
--- Build MapPath list of MapIDs
-function Bot_Server.GoToMap(self, Object, MapID)
-	self.MapPath = {}
+-- Set target map
+function Bot_Base.GoToMap(self, Object, MapID)
 	self.TargetMapID = MapID
-	local Last = FindMap(Object.MapID, self.TargetMapID, self.MapPath)
-	if Last ~= nil then
-		table.insert(self.MapPath, Last)
-		--for i = 1, #self.MapPath do print(self.MapPath[i]) end
-	end
 end
 
 -- Return the next direction the bot will move
-function Bot_Server.GetInputState(self, Object)
+function Bot_Base.GetInputState(self, Object)
 	InputState = DIRECTION_NONE
 
 	if self.MoveState == MOVE_IDLE then
@@ -308,7 +223,7 @@ function Bot_Server.GetInputState(self, Object)
 end
 
 -- Get next goal
-function Bot_Server.DetermineNextGoal(self, Object)
+function Bot_Base.DetermineNextGoal(self, Object)
 
 	-- Check skill points
 	SkillPointsAvailable = Object.GetSkillPointsAvailable()
@@ -374,13 +289,48 @@ function Bot_Server.DetermineNextGoal(self, Object)
 	--print("DetermineNextGoal ( goal=" .. self.GoalState .. " gold=" .. Object.Gold .. " buyid=" .. self.BuyID .. " map=" .. Object.MapID .. " x=" .. Object.X .. " y=" .. Object.Y .. " )")
 end
 
--- Bot that simulates a connected client --
+-- Copy starting state and behavior into a new bot
+function CreateBot()
+	Bot = {}
+	for Key, Value in pairs(Bot_Base) do
+		Bot[Key] = Value
+	end
+
+	return Bot
+end
+
+-- Bots that run on the server, each with its own state --
+
+Bot_Server = {}
+Bot_Server.Bots = {}
+
+-- Get state of a bot by character id
+function Bot_Server.Get(self, Object)
+	Bot = self.Bots[Object.CharacterID]
+	if Bot == nil then
+		Bot = CreateBot()
+		self.Bots[Object.CharacterID] = Bot
+	end
 
-Bot_Client = {}
-for Key, Value in pairs(Bot_Server) do
-	Bot_Client[Key] = Value
+	return Bot
 end
 
+function Bot_Server.Update(self, FrameTime, Object)
+	self:Get(Object):Update(FrameTime, Object)
+end
+
+function Bot_Server.GetInputState(self, Object)
+	return self:Get(Object):GetInputState(Object)
+end
+
+function Bot_Server.DetermineNextGoal(self, Object)
+	self:Get(Object):DetermineNextGoal(Object)
+end
+
+-- Bot that simulates a connected client --
+
+Bot_Client = CreateBot()
+
 function Bot_Client.DetermineNextGoal(self, Object)
 	self.GoalState = GOAL_FARMING
 	self:GoToMap(Object, 10)
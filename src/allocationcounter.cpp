@@ -0,0 +1,61 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <allocationcounter.h>
+#include <cstdlib>
+#include <new>
+
+// Counters are per thread so the server tick only sees its own allocations
+static thread_local uint64_t Allocations = 0;
+static thread_local uint64_t Bytes = 0;
+
+// Get counts for the calling thread
+_AllocationCount GetAllocationCount() {
+	return { Allocations, Bytes };
+}
+
+// Count global allocations
+void *operator new(std::size_t Size) {
+	Allocations++;
+	Bytes += Size;
+
+	void *Pointer = std::malloc(Size ? Size : 1);
+	if(!Pointer)
+		throw std::bad_alloc();
+
+	return Pointer;
+}
+
+void *operator new[](std::size_t Size) {
+	return operator new(Size);
+}
+
+void operator delete(void *Pointer) noexcept {
+	std::free(Pointer);
+}
+
+void operator delete[](void *Pointer) noexcept {
+	std::free(Pointer);
+}
+
+void operator delete(void *Pointer, std::size_t Size) noexcept {
+	std::free(Pointer);
+}
+
+void operator delete[](void *Pointer, std::size_t Size) noexcept {
+	std::free(Pointer);
+}
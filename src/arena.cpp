@@ -0,0 +1,81 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <arena.h>
+#include <algorithm>
+#include <cstdint>
+
+// Constructor
+_Arena::_Arena(std::size_t BlockSize) :
+	BytesUsed(0),
+	MaxBytesUsed(0),
+	BlockSize(BlockSize),
+	BlockIndex(0),
+	Offset(0) {
+}
+
+// Destructor
+_Arena::~_Arena() {
+	for(auto &Block : Blocks)
+		delete[] Block.Data;
+}
+
+// Return aligned memory, adding a block when the current one is full
+void *_Arena::Allocate(std::size_t Size, std::size_t Alignment) {
+	while(BlockIndex < Blocks.size()) {
+		_Block &Block = Blocks[BlockIndex];
+		std::uintptr_t Address = (std::uintptr_t)(Block.Data + Offset);
+		std::size_t Padding = (Alignment - Address % Alignment) % Alignment;
+		if(Offset + Padding + Size <= Block.Size) {
+			void *Pointer = Block.Data + Offset + Padding;
+			Offset += Padding + Size;
+			BytesUsed += Padding + Size;
+			MaxBytesUsed = std::max(MaxBytesUsed, BytesUsed);
+
+			return Pointer;
+		}
+
+		BlockIndex++;
+		Offset = 0;
+	}
+
+	// Oversized requests get a block of their own
+	_Block Block;
+	Block.Size = std::max(BlockSize, Size + Alignment);
+	Block.Data = new char[Block.Size];
+	Blocks.push_back(Block);
+	BlockIndex = Blocks.size() - 1;
+	Offset = 0;
+
+	return Allocate(Size, Alignment);
+}
+
+// Release everything allocated since the last reset
+void _Arena::Reset() {
+	BlockIndex = 0;
+	Offset = 0;
+	BytesUsed = 0;
+}
+
+// Get bytes held by all blocks
+std::size_t _Arena::GetCapacity() const {
+	std::size_t Capacity = 0;
+	for(const auto &Block : Blocks)
+		Capacity += Block.Size;
+
+	return Capacity;
+}
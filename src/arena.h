@@ -0,0 +1,79 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <cstddef>
+#include <vector>
+#include <list>
+
+// Bump allocator for scratch data that lives until the next reset
+class _Arena {
+
+	public:
+
+		_Arena(std::size_t BlockSize);
+		~_Arena();
+
+		void *Allocate(std::size_t Size, std::size_t Alignment);
+		void Reset();
+
+		// Stats
+		std::size_t BytesUsed;
+		std::size_t MaxBytesUsed;
+
+		std::size_t GetCapacity() const;
+
+	private:
+
+		struct _Block {
+			char *Data;
+			std::size_t Size;
+		};
+
+		// Blocks are kept between resets
+		std::vector<_Block> Blocks;
+		std::size_t BlockSize;
+		std::size_t BlockIndex;
+		std::size_t Offset;
+
+};
+
+// Standard allocator that takes memory from an arena and never frees it
+template<typename T> class _ArenaAllocator {
+
+	public:
+
+		using value_type = T;
+
+		_ArenaAllocator(_Arena &Arena) : Arena(&Arena) { }
+		template<typename U> _ArenaAllocator(const _ArenaAllocator<U> &Allocator) : Arena(Allocator.Arena) { }
+
+		T *allocate(std::size_t Count) { return (T *)Arena->Allocate(Count * sizeof(T), alignof(T)); }
+		void deallocate(T *Pointer, std::size_t Count) { }
+
+		template<typename U> bool operator==(const _ArenaAllocator<U> &Allocator) const { return Arena == Allocator.Arena; }
+		template<typename U> bool operator!=(const _ArenaAllocator<U> &Allocator) const { return Arena != Allocator.Arena; }
+
+		_Arena *Arena;
+
+};
+
+// Containers for scratch data
+template<typename T> using _ScratchVector = std::vector<T, _ArenaAllocator<T>>;
+template<typename T> using _ScratchList = std::list<T, _ArenaAllocator<T>>;
@@ -34,6 +34,7 @@
 #include <constants.h>
 #include <actiontype.h>
 #include <scripting.h>
+#include <navigation.h>
 #include <iostream>
 #include <iomanip>
 
@@ -53,11 +54,16 @@ _Bot::_Bot(const std::string &Username, const std::string &Password, const std::
 	Scripting->Setup(Stats, SCRIPTS_GAME);
 	Script = "Bot_Client";
 
+	// Build routes between maps in the background
+	Navigation = std::make_unique<_Navigation>(Stats);
+	Scripting->Navigation = Navigation.get();
+
 	Network->Connect(HostAddress, Port);
 }
 
 // Destructor
 _Bot::~_Bot() {
+	Navigation.reset();
 	delete Stats;
 	delete ObjectManager;
 	delete Battle;
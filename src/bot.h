@@ -30,6 +30,7 @@ class _Battle;
 class _Map;
 class _Stats;
 class _Scripting;
+class _Navigation;
 struct _Event;
 class _StatChange;
 
@@ -62,6 +63,7 @@ class _Bot {
 		ae::_Manager<_Object> *ObjectManager;
 
 		_Scripting *Scripting;
+		std::unique_ptr<_Navigation> Navigation;
 		_Map *Map;
 		_Stats *Stats;
 		_Battle *Battle;
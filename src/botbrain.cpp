@@ -0,0 +1,279 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <botbrain.h>
+#include <objects/components/character.h>
+#include <objects/components/inventory.h>
+#include <objects/components/controller.h>
+#include <objects/object.h>
+#include <objects/item.h>
+#include <objects/map.h>
+#include <ae/buffer.h>
+#include <ae/random.h>
+#include <config.h>
+#include <navigation.h>
+#include <server.h>
+#include <stats.h>
+
+// Skills to spend points on
+static const uint32_t BOT_SKILL_TOUGHNESS = 5;
+static const uint32_t BOT_SKILL_ATTACK = 1;
+
+// Map to farm and heal in
+static const uint32_t BOT_FARM_MAP = 10;
+static const uint32_t BOT_HEAL_MAP = 1;
+static const uint32_t BOT_HEAL_SCRIPT = 1;
+
+// Constructor
+_BotBrain::_BotBrain(_Object *Object, const _BotData *Data) :
+	GoalState(GOAL_NONE),
+	MoveState(MOVE_IDLE),
+	SellSlot(NOSLOT),
+	BuyID(0),
+	VendorID(0),
+	TargetMapID(0),
+	Object(Object),
+	Data(Data),
+	PathTarget(0, 0),
+	PathMapID(0),
+	DecisionTimer(0.0) {
+}
+
+// Update bot behavior when outside of battle, battles pick the next goal when they end
+void _BotBrain::Update(double FrameTime) {
+	if(Object->Character->Battle)
+		return;
+
+	// Only make decisions at a fixed rate
+	DecisionTimer += FrameTime;
+	if(DecisionTimer < Config.BotDecisionPeriod)
+		return;
+
+	DecisionTimer = 0.0;
+	Think();
+}
+
+// Run goal state machine
+void _BotBrain::Think() {
+	if(!Object->Character->IsAlive()) {
+		Respawn();
+		return;
+	}
+
+	bool Reached = false;
+	switch(GoalState) {
+		case GOAL_NONE:
+			DetermineNextGoal();
+		break;
+		case GOAL_FARMING:
+			if(TraverseMap())
+				MoveState = MOVE_RANDOM;
+		break;
+		case GOAL_HEALING:
+			if(!TraverseMap())
+				break;
+
+			if(Object->Character->GetHealthPercent() < 1.0f) {
+				if(MoveToEvent(_Map::EVENT_SCRIPT, BOT_HEAL_SCRIPT, Reached) && Reached)
+					Object->Controller->UseCommand = true;
+			}
+			else
+				DetermineNextGoal();
+		break;
+		case GOAL_BUY:
+			if(!TraverseMap() || !MoveToEvent(_Map::EVENT_VENDOR, VendorID, Reached) || !Reached)
+				break;
+
+			if(Object->Character->Status != _Character::STATUS_VENDOR) {
+				Object->Controller->UseCommand = true;
+			}
+			else {
+				SellItem(SellSlot);
+				BuyItem(BuyID);
+				CloseWindows();
+				DetermineNextGoal();
+			}
+		break;
+	}
+}
+
+// Return the next direction the bot will move
+int _BotBrain::GetInputState() {
+	int InputState = 0;
+	switch(MoveState) {
+		case MOVE_IDLE:
+		break;
+		case MOVE_PATH:
+			InputState = Object->GetInputStateFromPath();
+			if(!InputState)
+				MoveState = MOVE_IDLE;
+		break;
+		case MOVE_RANDOM: {
+			InputState = 1 << ae::GetRandomInt(0, 3);
+
+			// Stay away from events
+			glm::ivec2 Direction(0, 0);
+			Object->GetDirectionFromInput(InputState, Direction);
+			if(Object->Map && Object->Map->GetEvent(Object->Position + Direction).Type != _Map::EVENT_NONE)
+				InputState = 0;
+		} break;
+	}
+
+	return InputState;
+}
+
+// Get next goal
+void _BotBrain::DetermineNextGoal() {
+
+	// Spend skill points
+	_Character *Character = Object->Character;
+	if(Character->GetSkillPointsAvailable() > 0) {
+		Character->AdjustSkillLevel(BOT_SKILL_TOUGHNESS, Character->GetSkillPointsAvailable(), false);
+		if(Character->GetSkillPointsAvailable() > 0)
+			Character->AdjustSkillLevel(BOT_SKILL_ATTACK, Character->GetSkillPointsAvailable(), false);
+		Character->CalculateStats();
+	}
+
+	// Check health
+	if(Character->GetHealthPercent() <= 0.5f) {
+		GoalState = GOAL_HEALING;
+		TargetMapID = BOT_HEAL_MAP;
+		return;
+	}
+
+	// Check item progression
+	BuyID = 0;
+	VendorID = 0;
+	SellSlot = NOSLOT;
+	for(const auto &BuildSlot : Data->Build) {
+		const _Item *Item = Object->Inventory->GetSlot(_Slot(BagType::EQUIPMENT, BuildSlot.Slot)).Item;
+
+		// Find best item that can be afforded
+		for(auto Iterator = BuildSlot.Items.rbegin(); Iterator != BuildSlot.Items.rend(); ++Iterator) {
+			if(Item && Item->ID == Iterator->first)
+				break;
+
+			const auto &BuildItem = Object->Stats->Items.find(Iterator->first);
+			if(BuildItem != Object->Stats->Items.end() && Character->Attributes["Gold"].Int64 >= BuildItem->second->Cost) {
+				BuyID = Iterator->first;
+				VendorID = Iterator->second;
+				SellSlot = BuildSlot.Slot;
+				break;
+			}
+		}
+	}
+
+	const auto &VendorMap = Data->VendorMaps.find(VendorID);
+	if(BuyID && VendorMap != Data->VendorMaps.end()) {
+		GoalState = GOAL_BUY;
+		TargetMapID = VendorMap->second;
+	}
+	else {
+		GoalState = GOAL_FARMING;
+		TargetMapID = BOT_FARM_MAP;
+	}
+}
+
+// Move to next map on the route to TargetMapID, return true when there
+bool _BotBrain::TraverseMap() {
+	if(Object->GetMapID() == TargetMapID)
+		return true;
+
+	// Wait for routes to finish building
+	const _Navigation *Navigation = Object->Server->Navigation.get();
+	if(!Navigation || !Navigation->IsReady())
+		return false;
+
+	uint32_t NextMapID = Navigation->GetNextHop(Object->GetMapID(), TargetMapID);
+	if(!NextMapID)
+		return true;
+
+	bool Reached = false;
+	if(MoveToEvent(_Map::EVENT_MAPCHANGE, NextMapID, Reached) && Reached)
+		Object->Controller->UseCommand = true;
+
+	return false;
+}
+
+// Path to closest event, return false if the map doesn't have it
+bool _BotBrain::MoveToEvent(uint32_t Type, uint32_t Data, bool &Reached) {
+	if(!Object->Map)
+		return false;
+
+	glm::ivec2 Position = Object->Position;
+	if(!Object->Map->FindEvent(_Event(Type, Data), Position))
+		return false;
+
+	// Find new path when the target changes
+	Reached = Object->Position == Position;
+	if(!Reached && (MoveState != MOVE_PATH || PathTarget != Position || PathMapID != Object->GetMapID())) {
+		Object->Pathfind(Object->Position, Position);
+		MoveState = MOVE_PATH;
+		PathTarget = Position;
+		PathMapID = Object->GetMapID();
+	}
+
+	return true;
+}
+
+// Send respawn command
+void _BotBrain::Respawn() {
+	ae::_Buffer Packet;
+	Object->Server->HandleRespawn(Packet, Object->Peer);
+}
+
+// Sell an equipped item to the open vendor
+void _BotBrain::SellItem(std::size_t Slot) {
+	if(!Object->Character->Vendor || Slot == NOSLOT)
+		return;
+
+	ae::_Buffer Packet;
+	Packet.WriteBit(false);
+	Packet.Write<uint16_t>(1);
+	_Slot(BagType::EQUIPMENT, Slot).Serialize(Packet);
+
+	Packet.StartRead();
+	Object->Server->HandleVendorExchange(Packet, Object->Peer);
+}
+
+// Buy an item from the open vendor
+void _BotBrain::BuyItem(uint32_t ItemID) {
+	if(!Object->Character->Vendor)
+		return;
+
+	_Slot VendorSlot;
+	_Slot TargetSlot;
+	VendorSlot.Index = Object->Character->Vendor->GetSlotFromID(ItemID);
+
+	ae::_Buffer Packet;
+	Packet.WriteBit(true);
+	Packet.Write<uint16_t>(1);
+	VendorSlot.Serialize(Packet);
+	TargetSlot.Serialize(Packet);
+
+	Packet.StartRead();
+	Object->Server->HandleVendorExchange(Packet, Object->Peer);
+}
+
+// Close all open windows
+void _BotBrain::CloseWindows() {
+	ae::_Buffer Packet;
+	Packet.Write<uint8_t>(_Character::STATUS_NONE);
+
+	Packet.StartRead();
+	Object->Server->HandlePlayerStatus(Packet, Object->Peer);
+}
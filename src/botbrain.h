@@ -0,0 +1,91 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <glm/vec2.hpp>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Forward Declarations
+class _Object;
+
+// Item progression for an equipment slot
+struct _BotBuildSlot {
+	std::size_t Slot;
+	std::vector<std::pair<uint32_t, uint32_t> > Items;
+};
+
+// Vendor maps and build read from Vendors and Builds in bot.lua
+struct _BotData {
+	std::unordered_map<uint32_t, uint32_t> VendorMaps;
+	std::vector<_BotBuildSlot> Build;
+};
+
+// Native version of the server bot in bot.lua
+class _BotBrain {
+
+	public:
+
+		enum GoalType {
+			GOAL_NONE,
+			GOAL_FARMING,
+			GOAL_HEALING,
+			GOAL_BUY,
+		};
+
+		enum MoveType {
+			MOVE_IDLE,
+			MOVE_PATH,
+			MOVE_RANDOM,
+		};
+
+		_BotBrain(_Object *Object, const _BotData *Data);
+
+		void Update(double FrameTime);
+		void DetermineNextGoal();
+		int GetInputState();
+
+		// State
+		GoalType GoalState;
+		MoveType MoveState;
+		std::size_t SellSlot;
+		uint32_t BuyID;
+		uint32_t VendorID;
+		uint32_t TargetMapID;
+
+	private:
+
+		void Think();
+		bool TraverseMap();
+		bool MoveToEvent(uint32_t Type, uint32_t Data, bool &Reached);
+
+		void Respawn();
+		void SellItem(std::size_t Slot);
+		void BuyItem(uint32_t ItemID);
+		void CloseWindows();
+
+		_Object *Object;
+		const _BotData *Data;
+		glm::ivec2 PathTarget;
+		uint32_t PathMapID;
+		double DecisionTimer;
+
+};
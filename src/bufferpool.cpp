@@ -0,0 +1,48 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <bufferpool.h>
+#include <ae/buffer.h>
+#include <algorithm>
+
+// Constructor
+_BufferPool::_BufferPool() :
+	MaxUsed(0),
+	Used(0) {
+}
+
+// Destructor
+_BufferPool::~_BufferPool() {
+}
+
+// Return an empty buffer that stays valid until the next reset
+ae::_Buffer &_BufferPool::Get() {
+	if(Used == Buffers.size())
+		Buffers.push_back(std::make_unique<ae::_Buffer>());
+
+	// Rewind the cursor so old contents get overwritten
+	ae::_Buffer &Buffer = *Buffers[Used++];
+	Buffer.StartRead();
+	MaxUsed = std::max(MaxUsed, Used);
+
+	return Buffer;
+}
+
+// Make every buffer available again
+void _BufferPool::Reset() {
+	Used = 0;
+}
@@ -0,0 +1,50 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Forward Declarations
+namespace ae {
+	class _Buffer;
+}
+
+// Packet buffers that keep their storage between resets
+class _BufferPool {
+
+	public:
+
+		_BufferPool();
+		~_BufferPool();
+
+		ae::_Buffer &Get();
+		void Reset();
+
+		// Stats
+		std::size_t GetCapacity() const { return Buffers.size(); }
+		std::size_t MaxUsed;
+
+	private:
+
+		std::vector<std::unique_ptr<ae::_Buffer>> Buffers;
+		std::size_t Used;
+
+};
@@ -0,0 +1,196 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <capture.h>
+#include <ae/network.h>
+#include <ae/buffer.h>
+#include <constants.h>
+#include <stdexcept>
+
+// Write a value to a binary stream
+template<typename Type> static void WriteValue(std::fstream &File, Type Value) {
+	File.write((const char *)&Value, sizeof(Value));
+}
+
+// Read a value from a binary stream
+template<typename Type> static Type ReadValue(std::fstream &File) {
+	Type Value = Type();
+	File.read((char *)&Value, sizeof(Value));
+
+	return Value;
+}
+
+// Constructor
+_Capture::_Capture() :
+	Settings(),
+	Tick(0),
+	NextPeerID(1) {
+}
+
+// Create capture file and store initial state
+void _Capture::StartRecording(const std::string &Path, const std::string &RandomState, const _CaptureSettings &Settings, const std::string &SavePath) {
+	this->Settings = Settings;
+	this->RandomState = RandomState;
+	Tick = 0;
+
+	File.open(Path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!File)
+		throw std::runtime_error("Error opening capture file: " + Path);
+
+	// Read save database
+	std::ifstream SaveFile(SavePath, std::ios::in | std::ios::binary);
+	std::vector<char> SaveData((std::istreambuf_iterator<char>(SaveFile)), std::istreambuf_iterator<char>());
+
+	// Write header
+	WriteValue<uint32_t>(File, CAPTURE_MAGIC);
+	WriteValue<uint32_t>(File, CAPTURE_VERSION);
+	WriteString(RandomState);
+
+	// Write settings
+	WriteValue<uint8_t>(File, Settings.IsTesting);
+	WriteValue<uint8_t>(File, Settings.Hardcore);
+	WriteValue<uint8_t>(File, Settings.NoPVP);
+	WriteValue<double>(File, Settings.NetworkRate);
+	WriteValue<double>(File, Settings.AutoSavePeriod);
+	WriteValue<double>(File, Settings.MapIdleTimeout);
+	WriteValue<double>(File, Settings.BotDecisionPeriod);
+	WriteValue<int32_t>(File, Settings.PathThreads);
+	WriteValue<uint64_t>(File, Settings.PathBudget);
+	WriteValue<int32_t>(File, Settings.MinigameThreads);
+	WriteValue<uint8_t>(File, Settings.ObjectPool);
+	WriteValue<uint8_t>(File, Settings.UpdateTiers);
+	WriteValue<uint8_t>(File, Settings.NativeBots);
+	WriteValue<uint8_t>(File, Settings.BatchMonsterAI);
+	WriteString(Settings.PreloadMaps);
+
+	WriteValue<uint32_t>(File, (uint32_t)SaveData.size());
+	File.write(SaveData.data(), (std::streamsize)SaveData.size());
+	File.flush();
+}
+
+// Append a network event to the capture
+void _Capture::WriteEvent(const ae::_NetworkEvent &Event) {
+	if(!File.is_open())
+		return;
+
+	uint32_t PeerID = GetPeerID(Event.Peer);
+
+	WriteValue<uint32_t>(File, Tick);
+	WriteValue<uint8_t>(File, (uint8_t)Event.Type);
+	WriteValue<uint32_t>(File, PeerID);
+	WriteValue<uint32_t>(File, (uint32_t)Event.EventData);
+	if(Event.Type == ae::_NetworkEvent::PACKET && Event.Data) {
+		WriteValue<uint32_t>(File, Event.Data->GetCurrentSize());
+		File.write(Event.Data->GetData(), Event.Data->GetCurrentSize());
+	}
+	else
+		WriteValue<uint32_t>(File, 0);
+
+	// Forget disconnected peers
+	if(Event.Type == ae::_NetworkEvent::DISCONNECT)
+		PeerIDs.erase(Event.Peer);
+}
+
+// Open capture file and extract save database
+void _Capture::StartPlayback(const std::string &Path, const std::string &SavePath) {
+	File.open(Path, std::ios::in | std::ios::binary);
+	if(!File)
+		throw std::runtime_error("Error opening capture file: " + Path);
+
+	// Check header
+	if(ReadValue<uint32_t>(File) != CAPTURE_MAGIC)
+		throw std::runtime_error("Bad capture file: " + Path);
+	if(ReadValue<uint32_t>(File) != CAPTURE_VERSION)
+		throw std::runtime_error("Wrong capture version: " + Path);
+
+	// Read random generator state
+	ReadString(RandomState, CAPTURE_MAX_RANDOM_STATE);
+
+	// Read settings
+	Settings.IsTesting = ReadValue<uint8_t>(File);
+	Settings.Hardcore = ReadValue<uint8_t>(File);
+	Settings.NoPVP = ReadValue<uint8_t>(File);
+	Settings.NetworkRate = ReadValue<double>(File);
+	Settings.AutoSavePeriod = ReadValue<double>(File);
+	Settings.MapIdleTimeout = ReadValue<double>(File);
+	Settings.BotDecisionPeriod = ReadValue<double>(File);
+	Settings.PathThreads = ReadValue<int32_t>(File);
+	Settings.PathBudget = ReadValue<uint64_t>(File);
+	Settings.MinigameThreads = ReadValue<int32_t>(File);
+	Settings.ObjectPool = ReadValue<uint8_t>(File);
+	Settings.UpdateTiers = ReadValue<uint8_t>(File);
+	Settings.NativeBots = ReadValue<uint8_t>(File);
+	Settings.BatchMonsterAI = ReadValue<uint8_t>(File);
+	ReadString(Settings.PreloadMaps, CAPTURE_MAX_STRING);
+	if(!File)
+		throw std::runtime_error("Bad settings in capture file: " + Path);
+
+	// Write save database
+	std::vector<char> SaveData(ReadValue<uint32_t>(File));
+	File.read(SaveData.data(), (std::streamsize)SaveData.size());
+	std::ofstream SaveFile(SavePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!SaveFile)
+		throw std::runtime_error("Error writing save file: " + SavePath);
+	SaveFile.write(SaveData.data(), (std::streamsize)SaveData.size());
+}
+
+// Read next event, return false at end of capture
+bool _Capture::ReadEvent(_CaptureEvent &Event) {
+	Event.Tick = ReadValue<uint32_t>(File);
+	Event.Type = ReadValue<uint8_t>(File);
+	Event.PeerID = ReadValue<uint32_t>(File);
+	Event.EventData = ReadValue<uint32_t>(File);
+	uint32_t Size = ReadValue<uint32_t>(File);
+	if(!File)
+		return false;
+
+	// Reject sizes no client could send before allocating
+	if(Size > CAPTURE_MAX_PACKET_SIZE)
+		throw std::runtime_error("Bad packet size in capture: " + std::to_string(Size));
+
+	Event.Data.resize(Size);
+	File.read(Event.Data.data(), (std::streamsize)Event.Data.size());
+
+	return (bool)File;
+}
+
+// Write a length prefixed string
+void _Capture::WriteString(const std::string &Value) {
+	WriteValue<uint32_t>(File, (uint32_t)Value.size());
+	File.write(Value.data(), (std::streamsize)Value.size());
+}
+
+// Read a length prefixed string, rejecting sizes over the limit before allocating
+void _Capture::ReadString(std::string &Value, uint32_t MaxSize) {
+	uint32_t Size = ReadValue<uint32_t>(File);
+	if(!File || Size > MaxSize)
+		throw std::runtime_error("Bad string size in capture: " + std::to_string(Size));
+
+	Value.resize(Size);
+	File.read(&Value[0], (std::streamsize)Value.size());
+}
+
+// Get stable id for a peer
+uint32_t _Capture::GetPeerID(const ae::_Peer *Peer) {
+	const auto &Iterator = PeerIDs.find(Peer);
+	if(Iterator != PeerIDs.end())
+		return Iterator->second;
+
+	PeerIDs[Peer] = NextPeerID;
+
+	return NextPeerID++;
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <unordered_map>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward Declarations
+namespace ae {
+	struct _NetworkEvent;
+	class _Peer;
+}
+
+// Server flags and config options that change the simulation
+struct _CaptureSettings {
+	bool IsTesting;
+	bool Hardcore;
+	bool NoPVP;
+	double NetworkRate;
+	double AutoSavePeriod;
+	double MapIdleTimeout;
+	double BotDecisionPeriod;
+	int PathThreads;
+	std::size_t PathBudget;
+	int MinigameThreads;
+	bool ObjectPool;
+	bool UpdateTiers;
+	bool NativeBots;
+	bool BatchMonsterAI;
+	std::string PreloadMaps;
+};
+
+// Captured network event
+struct _CaptureEvent {
+	uint32_t Tick;
+	uint8_t Type;
+	uint32_t PeerID;
+	uint32_t EventData;
+	std::vector<char> Data;
+};
+
+// Binary capture of inbound network events
+class _Capture {
+
+	public:
+
+		_Capture();
+
+		// Recording
+		void StartRecording(const std::string &Path, const std::string &RandomState, const _CaptureSettings &Settings, const std::string &SavePath);
+		void WriteEvent(const ae::_NetworkEvent &Event);
+		void EndTick() { Tick++; }
+
+		// Playback
+		void StartPlayback(const std::string &Path, const std::string &SavePath);
+		bool ReadEvent(_CaptureEvent &Event);
+
+		// Attributes
+		_CaptureSettings Settings;
+		std::string RandomState;
+		uint32_t Tick;
+
+	private:
+
+		uint32_t GetPeerID(const ae::_Peer *Peer);
+		void WriteString(const std::string &Value);
+		void ReadString(std::string &Value, uint32_t MaxSize);
+
+		// File
+		std::fstream File;
+
+		// Peers
+		std::unordered_map<const ae::_Peer *, uint32_t> PeerIDs;
+		uint32_t NextPeerID;
+
+};
@@ -0,0 +1,65 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <commandqueue.h>
+
+// Destructor
+_CommandQueue::~_CommandQueue() {
+	Clear();
+}
+
+// Drop queued commands without running them
+void _CommandQueue::Clear() {
+	_Node *Node = Head.exchange(nullptr, std::memory_order_acquire);
+	while(Node) {
+		_Node *Next = Node->Next;
+		delete Node;
+		Node = Next;
+	}
+}
+
+// Add a command from any thread
+void _CommandQueue::Push(std::function<void()> Command) {
+	_Node *Node = new _Node;
+	Node->Command = std::move(Command);
+	Node->Next = Head.load(std::memory_order_relaxed);
+	while(!Head.compare_exchange_weak(Node->Next, Node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Run all queued commands in order from the consumer thread
+void _CommandQueue::Run() {
+	_Node *Node = Head.exchange(nullptr, std::memory_order_acquire);
+	if(!Node)
+		return;
+
+	// Reverse into push order
+	_Node *Ordered = nullptr;
+	while(Node) {
+		_Node *Next = Node->Next;
+		Node->Next = Ordered;
+		Ordered = Node;
+		Node = Next;
+	}
+
+	// Run commands
+	while(Ordered) {
+		_Node *Next = Ordered->Next;
+		Ordered->Command();
+		delete Ordered;
+		Ordered = Next;
+	}
+}
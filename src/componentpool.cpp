@@ -0,0 +1,106 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <componentpool.h>
+#include <objects/object.h>
+#include <objects/components/character.h>
+#include <objects/components/inventory.h>
+#include <objects/components/fighter.h>
+#include <objects/components/controller.h>
+#include <objects/components/monster.h>
+#include <constants.h>
+
+// Constructor
+_ComponentPool::_ComponentPool(bool Enabled) :
+	Allocated(0),
+	Reused(0),
+	Battles(0),
+	Enabled(Enabled) {
+
+	if(Enabled)
+		Free.reserve(OBJECT_POOL_MAX);
+}
+
+// Destructor
+_ComponentPool::~_ComponentPool() {
+	for(auto &Components : Free)
+		DeleteComponents(Components);
+}
+
+// Give an object recycled components, or new ones if none are free
+void _ComponentPool::CreateComponents(_Object *Object) {
+	Object->ComponentPool = this;
+	if(Free.empty()) {
+		Object->CreateComponents();
+		Allocated++;
+		return;
+	}
+
+	_Components &Components = Free.back();
+	Object->Inventory = Components.Inventory;
+	Object->Character = Components.Character;
+	Object->Fighter = Components.Fighter;
+	Object->Controller = Components.Controller;
+	Object->Monster = Components.Monster;
+	Free.pop_back();
+
+	Object->Inventory->Object = Object;
+	Object->Character->Object = Object;
+	Object->Fighter->Object = Object;
+	Object->Controller->Object = Object;
+	Object->Monster->Object = Object;
+	Reused++;
+}
+
+// Take components from a deleted object
+void _ComponentPool::ReleaseComponents(_Object *Object) {
+	_Components Components = { Object->Inventory, Object->Character, Object->Fighter, Object->Controller, Object->Monster };
+	Object->Inventory = nullptr;
+	Object->Character = nullptr;
+	Object->Fighter = nullptr;
+	Object->Controller = nullptr;
+	Object->Monster = nullptr;
+	Object->ComponentPool = nullptr;
+
+	if(!Enabled || Free.size() >= OBJECT_POOL_MAX || !Components.Inventory || !Components.Character || !Components.Fighter || !Components.Controller || !Components.Monster) {
+		DeleteComponents(Components);
+		return;
+	}
+
+	Components.Inventory->Reset();
+	Components.Character->Reset();
+	Components.Fighter->Reset();
+	Components.Controller->Reset();
+	Components.Monster->Reset();
+	Free.push_back(Components);
+}
+
+// Reset stats
+void _ComponentPool::ResetStats() {
+	Allocated = 0;
+	Reused = 0;
+	Battles = 0;
+}
+
+// Free a set of components
+void _ComponentPool::DeleteComponents(_Components &Components) {
+	delete Components.Monster;
+	delete Components.Controller;
+	delete Components.Fighter;
+	delete Components.Character;
+	delete Components.Inventory;
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <cstddef>
+#include <vector>
+
+// Forward Declarations
+class _Object;
+class _Character;
+class _Inventory;
+class _Fighter;
+class _Controller;
+class _Monster;
+
+// Recycles the components of short lived battle objects
+class _ComponentPool {
+
+	public:
+
+		_ComponentPool(bool Enabled);
+		~_ComponentPool();
+
+		void CreateComponents(_Object *Object);
+		void ReleaseComponents(_Object *Object);
+		void ResetStats();
+
+		// Stats
+		std::size_t Allocated;
+		std::size_t Reused;
+		std::size_t Battles;
+
+		std::size_t GetFreeCount() const { return Free.size(); }
+
+	private:
+
+		struct _Components {
+			_Inventory *Inventory;
+			_Character *Character;
+			_Fighter *Fighter;
+			_Controller *Controller;
+			_Monster *Monster;
+		};
+
+		static void DeleteComponents(_Components &Components);
+
+		// Components ready for reuse
+		std::vector<_Components> Free;
+		bool Enabled;
+
+};
@@ -115,6 +115,17 @@ void _Config::SetDefaults() {
 	NetworkRate = DEFAULT_NETWORKRATE;
 	NetworkPort = DEFAULT_NETWORKPORT;
 	Offline = false;
+	NetworkThread = false;
+	PreloadMaps = "";
+	MapIdleTimeout = DEFAULT_MAP_IDLE_TIMEOUT;
+	PathThreads = DEFAULT_PATH_THREADS;
+	PathBudget = DEFAULT_PATH_BUDGET;
+	ObjectPool = DEFAULT_OBJECT_POOL;
+	UpdateTiers = DEFAULT_UPDATE_TIERS;
+	NativeBots = DEFAULT_NATIVE_BOTS;
+	BotDecisionPeriod = DEFAULT_BOT_DECISION_PERIOD;
+	BatchMonsterAI = DEFAULT_BATCH_MONSTER_AI;
+	MinigameThreads = DEFAULT_MINIGAME_THREADS;
 	ShowTutorial = true;
 	RightClickSell = false;
 	HighlightTarget = false;
@@ -251,6 +262,17 @@ void _Config::Load() {
 	GetValue("max_clients", MaxClients);
 	GetValue("network_rate", NetworkRate);
 	GetValue("network_port", NetworkPort);
+	GetValue("network_thread", NetworkThread);
+	GetValue("preload_maps", PreloadMaps);
+	GetValue("map_idle_timeout", MapIdleTimeout);
+	GetValue("path_threads", PathThreads);
+	GetValue("path_budget", PathBudget);
+	GetValue("object_pool", ObjectPool);
+	GetValue("update_tiers", UpdateTiers);
+	GetValue("native_bots", NativeBots);
+	GetValue("bot_decision_period", BotDecisionPeriod);
+	GetValue("batch_monster_ai", BatchMonsterAI);
+	GetValue("minigame_threads", MinigameThreads);
 	GetValue("browser_command", BrowserCommand);
 	GetValue("designtool_url", DesignToolURL);
 	GetValue("showtutorial", ShowTutorial);
@@ -317,6 +339,17 @@ void _Config::Save() {
 	File << "max_clients=" << MaxClients << std::endl;
 	File << "network_rate=" << NetworkRate << std::endl;
 	File << "network_port=" << NetworkPort << std::endl;
+	File << "network_thread=" << NetworkThread << std::endl;
+	File << "preload_maps=" << PreloadMaps << std::endl;
+	File << "map_idle_timeout=" << MapIdleTimeout << std::endl;
+	File << "path_threads=" << PathThreads << std::endl;
+	File << "path_budget=" << PathBudget << std::endl;
+	File << "object_pool=" << ObjectPool << std::endl;
+	File << "update_tiers=" << UpdateTiers << std::endl;
+	File << "native_bots=" << NativeBots << std::endl;
+	File << "bot_decision_period=" << BotDecisionPeriod << std::endl;
+	File << "batch_monster_ai=" << BatchMonsterAI << std::endl;
+	File << "minigame_threads=" << MinigameThreads << std::endl;
 	File << "browser_command=" << BrowserCommand << std::endl;
 	File << "designtool_url=" << DesignToolURL << std::endl;
 	File << "showtutorial=" << ShowTutorial << std::endl;
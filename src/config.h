@@ -65,8 +65,21 @@ class _Config {
 		double FakeLag;
 		double NetworkRate;
 		bool Offline;
+		bool NetworkThread;
 		uint16_t NetworkPort;
 
+		// Server
+		std::string PreloadMaps;
+		double MapIdleTimeout;
+		int PathThreads;
+		std::size_t PathBudget;
+		bool ObjectPool;
+		bool UpdateTiers;
+		bool NativeBots;
+		double BotDecisionPeriod;
+		bool BatchMonsterAI;
+		int MinigameThreads;
+
 		// Editor
 		std::string BrowserCommand;
 		std::string DesignToolURL;
@@ -35,8 +35,45 @@ const  uint16_t     DEFAULT_NETWORKPORT                =  31234;
 const  uint16_t     DEFAULT_NETWORKPINGPORT            =  31235;
 const  double       DEFAULT_TIMESTEP                   =  1/100.0;
 const  double       DEFAULT_AUTOSAVE_PERIOD            =  60.0;
+const  double       DEFAULT_MAP_IDLE_TIMEOUT           =  300.0;
+const  int          DEFAULT_PATH_THREADS               =  0;
+const  std::size_t  DEFAULT_PATH_BUDGET                =  64;
+const  bool         DEFAULT_OBJECT_POOL                =  false;
+const  bool         DEFAULT_UPDATE_TIERS               =  false;
+const  bool         DEFAULT_NATIVE_BOTS                =  false;
+const  double       DEFAULT_BOT_DECISION_PERIOD        =  0.1;
+const  bool         DEFAULT_BATCH_MONSTER_AI           =  false;
+const  int          DEFAULT_MINIGAME_THREADS           =  1;
+//     Network
+const  std::size_t  NETWORK_QUEUE_SIZE                 =  4096;
+const  int          NETWORK_THREAD_MIN_WAIT            =  250;
+const  int          NETWORK_THREAD_MAX_WAIT            =  4000;
+//     Server
+const  int          SERVER_MAX_CATCHUP_STEPS           =  25;
+const  double       SERVER_DRIFT_REPORT_PERIOD         =  60.0;
+const  std::size_t  OBJECT_POOL_MAX                    =  512;
+const  std::size_t  SERVER_ARENA_BLOCK_SIZE            =  64 * 1024;
+const  double       SERVER_TIMER_RESOLUTION            =  0.1;
+const  double       SERVER_QUERY_TIMEOUT               =  5.0;
+const  double       SERVER_WAIT_SLICE                  =  0.001;
+const  int          OBJECT_IDLE_UPDATE_TICKS           =  10;
+const  int          OBJECT_DORMANT_UPDATE_TICKS        =  50;
+//     Path finding
+const  std::size_t  PATH_QUEUE_MAX                     =  1024;
+const  uint64_t     PATH_DELIVER_TICKS                 =  2;
+const  double       PATH_RETRY_DELAY                   =  1.0;
+//     Minigames
+const  std::size_t  MINIGAME_QUEUE_MAX                 =  256;
+const  int          MINIGAME_MAX_PENDING               =  4;
+const  double       MINIGAME_MAX_TIME                  =  30.0;
 //     Debug
 const  double       DEBUG_STALL_THRESHOLD              =  1.0;
+//     Capture
+const  uint32_t     CAPTURE_MAGIC                      =  0x43524843;
+const  uint32_t     CAPTURE_VERSION                    =  3;
+const  uint32_t     CAPTURE_MAX_PACKET_SIZE            =  1024 * 1024;
+const  uint32_t     CAPTURE_MAX_RANDOM_STATE           =  64 * 1024;
+const  uint32_t     CAPTURE_MAX_STRING                 =  64 * 1024;
 //     Camera
 const  float        CAMERA_DISTANCE                    =  8.4375f;
 const  float        CAMERA_DIVISOR                     =  30.0f;
@@ -52,6 +89,8 @@ const  std::size_t  ACCOUNT_MAX_PASSWORD_SIZE          =  20;
 const  int          ACCOUNT_MAX_CHARACTER_SLOTS        =  10;
 //     Map
 const  int          MAP_VERSION                        =  1;
+const  uint32_t     MAP_BINARY_MAGIC                   =  0x424D4843;
+const  uint32_t     MAP_BINARY_VERSION                 =  1;
 const  int          MAP_TILE_WIDTH                     =  128;
 const  int          MAP_TILE_HEIGHT                    =  128;
 const  double       MAP_CLOCK_START                    =  8.0*60.0;
@@ -22,6 +22,12 @@
 #include <states/bots.h>
 #include <states/test.h>
 #include <states/benchmark.h>
+#include <states/replay.h>
+#include <states/maptool.h>
+#include <states/botbench.h>
+#include <states/netbench.h>
+#include <states/simulate.h>
+#include <states/battlesim.h>
 #include <ae/network.h>
 #include <ae/clientnetwork.h>
 #include <ae/graphics.h>
@@ -55,6 +61,7 @@ void _Framework::Init(int ArgumentCount, char **Arguments) {
 	State = (ae::_State *)&PlayState;
 	Done = false;
 	IgnoreNextInputEvent = false;
+	ExitCode = 0;
 
 	// Settings
 	bool LoadClientAssets = true;
@@ -122,11 +129,56 @@ void _Framework::Init(int ArgumentCount, char **Arguments) {
 		else if(Token == "-test") {
 			State = &TestState;
 		}
+		else if(Token == "-testverify") {
+			State = &TestState;
+			TestState.Verify = true;
+		}
 		else if(Token == "-benchmark") {
 			State = &BenchmarkState;
 			Config.Vsync = false;
 			Config.MaxFPS = 0;
 		}
+		else if(Token == "-record" && TokensRemaining > 0) {
+			DedicatedState.SetRecordPath(Arguments[++i]);
+		}
+		else if(Token == "-replay" && TokensRemaining > 0) {
+			State = &ReplayState;
+			ReplayState.SetCapturePath(Arguments[++i]);
+			LoadClientAssets = false;
+		}
+		else if(Token == "-convertmaps") {
+			State = &MapToolState;
+			MapToolState.SetMode(_MapToolState::MODE_CONVERT);
+			LoadClientAssets = false;
+		}
+		else if(Token == "-benchmarkmaps") {
+			State = &MapToolState;
+			MapToolState.SetMode(_MapToolState::MODE_BENCHMARK);
+			LoadClientAssets = false;
+		}
+		else if(Token == "-benchmarkbots" && TokensRemaining > 0) {
+			State = &BotBenchState;
+			BotBenchState.SetBotCount(ae::ToNumber<int>(Arguments[++i]));
+			LoadClientAssets = false;
+		}
+		else if(Token == "-benchmarknetwork" && TokensRemaining > 0) {
+			State = &NetBenchState;
+			NetBenchState.SetPeerCount(ae::ToNumber<int>(Arguments[++i]));
+			LoadClientAssets = false;
+		}
+		else if(Token == "-simulate") {
+			State = &SimulateState;
+			if(TokensRemaining && Arguments[i+1][0] != '-')
+				SimulateState.SetCount(ae::ToNumber<int>(Arguments[++i]));
+			LoadClientAssets = false;
+		}
+		else if(Token == "-battlesim" && TokensRemaining > 2) {
+			State = &BattleSimState;
+			BattleSimState.SetZone(ae::ToNumber<uint32_t>(Arguments[++i]));
+			BattleSimState.SetBattleCount(ae::ToNumber<int>(Arguments[++i]));
+			BattleSimState.SetParty(Arguments[++i]);
+			LoadClientAssets = false;
+		}
 		else if(Token == "-noaudio") {
 			AudioEnabled = false;
 		}
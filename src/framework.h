@@ -65,6 +65,7 @@ class _Framework {
 		// State
 		bool Done;
 		bool IgnoreNextInputEvent;
+		int ExitCode;
 
 	private:
 
@@ -1415,11 +1415,12 @@ void _HUD::DrawCooldown(const ae::_Element *Button, const _Item *Item) {
 	if(CooldownIterator == Player->Character->Cooldowns.end())
 		return;
 
-	if(CooldownIterator->second.MaxDuration <= 0.0)
+	double Duration = Player->Character->GetCooldown(Item->ID);
+	if(Duration <= 0.0 || CooldownIterator->second.MaxDuration <= 0.0)
 		return;
 
 	// Draw cooldown
-	double CooldownPercent = CooldownIterator->second.Duration / CooldownIterator->second.MaxDuration;
+	double CooldownPercent = Duration / CooldownIterator->second.MaxDuration;
 
 	// Set up graphics
 	ae::Graphics.SetProgram(ae::Assets.Programs["ortho_pos"]);
@@ -1431,7 +1432,6 @@ void _HUD::DrawCooldown(const ae::_Element *Button, const _Item *Item) {
 
 	// Get size
 	std::stringstream Buffer;
-	double Duration = CooldownIterator->second.Duration;
 	if(Duration > 60.0)
 		Buffer << std::fixed << std::setprecision(1) << (int)(Duration / 60.0) << "m";
 	else
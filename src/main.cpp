@@ -33,5 +33,5 @@ int main(int ArgumentCount, char **Arguments) {
 	// Shut down the system
 	Framework.Close();
 
-	return 0;
+	return Framework.ExitCode;
 }
@@ -0,0 +1,94 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <maploader.h>
+#include <objects/map.h>
+#include <SDL_timer.h>
+
+// Constructor
+_MapLoader::_MapLoader() :
+	Thread(nullptr),
+	Done(false) {
+
+	Thread = new std::thread(&_MapLoader::Run, this);
+}
+
+// Destructor
+_MapLoader::~_MapLoader() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Done = true;
+	}
+	Condition.notify_one();
+
+	Thread->join();
+	delete Thread;
+}
+
+// Queue a map to be loaded, the map must not be touched until its result is returned
+void _MapLoader::Load(_Map *Map, const _MapStat *MapStat) {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Requests.push_back({ Map, MapStat });
+	}
+	Condition.notify_one();
+}
+
+// Get next finished load
+bool _MapLoader::GetResult(_MapLoadResult &Result) {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	if(Results.empty())
+		return false;
+
+	Result = Results.front();
+	Results.pop_front();
+
+	return true;
+}
+
+// Thread loop
+void _MapLoader::Run() {
+	while(true) {
+
+		// Wait for request
+		_MapLoadRequest Request;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this] { return Done || !Requests.empty(); });
+			if(Done)
+				return;
+
+			Request = Requests.front();
+			Requests.pop_front();
+		}
+
+		// Load map
+		_MapLoadResult Result;
+		Result.Map = Request.Map;
+		Uint64 StartTime = SDL_GetPerformanceCounter();
+		try {
+			Request.Map->Load(Request.MapStat);
+		}
+		catch(std::exception &Error) {
+			Result.Error = Error.what();
+		}
+		Result.Time = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Results.push_back(Result);
+	}
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <string>
+#include <list>
+
+// Forward Declarations
+class _Map;
+struct _MapStat;
+
+// Finished map load
+struct _MapLoadResult {
+	_Map *Map;
+	std::string Error;
+	double Time;
+};
+
+// Loads maps on a background thread
+class _MapLoader {
+
+	public:
+
+		_MapLoader();
+		~_MapLoader();
+
+		void Load(_Map *Map, const _MapStat *MapStat);
+		bool GetResult(_MapLoadResult &Result);
+
+	private:
+
+		struct _MapLoadRequest {
+			_Map *Map;
+			const _MapStat *MapStat;
+		};
+
+		void Run();
+
+		// Queues
+		std::list<_MapLoadRequest> Requests;
+		std::list<_MapLoadResult> Results;
+
+		// Threading
+		std::thread *Thread;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		bool Done;
+
+};
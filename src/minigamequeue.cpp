@@ -0,0 +1,165 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <minigamequeue.h>
+#include <objects/minigame.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <algorithm>
+
+// Constructor
+_MinigameQueue::_MinigameQueue(int ThreadCount) :
+	Done(false) {
+
+	ResetStats();
+	for(int i = 0; i < ThreadCount; i++)
+		Threads.emplace_back(&_MinigameQueue::Run, this);
+}
+
+// Destructor
+_MinigameQueue::~_MinigameQueue() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Done = true;
+	}
+	Condition.notify_all();
+
+	for(auto &Thread : Threads)
+		Thread.join();
+}
+
+// Queue a drop to verify, simulate in place if there are no workers or the queue is full
+void _MinigameQueue::Submit(const _MinigameType *Minigame, uint32_t Seed, float DropX, MinigameCallbackType Callback) {
+	_MinigameRequest Request{ Minigame, Seed, DropX, Callback, SDL_GetPerformanceCounter() };
+	Submitted++;
+
+	if(!Threads.empty()) {
+		bool Queued = false;
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Queued = Requests.size() < MINIGAME_QUEUE_MAX;
+			if(Queued)
+				Requests.push_back(std::move(Request));
+			else
+				Overflowed++;
+		}
+
+		if(Queued) {
+			Condition.notify_one();
+			return;
+		}
+	}
+
+	// Solve before taking the lock
+	_MinigameResult Result = Solve(Request);
+
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Results.push_back(std::move(Result));
+}
+
+// Run callbacks for finished drops
+void _MinigameQueue::Update() {
+	std::list<_MinigameResult> Finished;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Finished.swap(Results);
+	}
+
+	uint64_t Time = SDL_GetPerformanceCounter();
+	for(auto &Result : Finished) {
+		double Latency = (Time - Result.SubmitTime) / (double)SDL_GetPerformanceFrequency();
+		TotalLatency += Latency;
+		MaxLatency = std::max(MaxLatency, Latency);
+		TotalSimulateTime += Result.SimulateTime;
+		Delivered++;
+
+		Result.Callback(Result.Prize);
+	}
+}
+
+// Reset stats
+void _MinigameQueue::ResetStats() {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Submitted = 0;
+	Overflowed = 0;
+	Delivered = 0;
+	TotalLatency = 0.0;
+	MaxLatency = 0.0;
+	TotalSimulateTime = 0.0;
+	StatsStartTime = SDL_GetPerformanceCounter();
+}
+
+// Get seconds since stats were reset
+double _MinigameQueue::GetStatsTime() const {
+	return (SDL_GetPerformanceCounter() - StatsStartTime) / (double)SDL_GetPerformanceFrequency();
+}
+
+// Play out a drop and return the prize won
+const _MinigameItem *_MinigameQueue::Simulate(const _MinigameType *Minigame, uint32_t Seed, float DropX) {
+	_Minigame Game(Minigame, true);
+	Game.StartGame(Seed);
+	Game.Drop(DropX);
+
+	double Time = 0;
+	while(Time < MINIGAME_MAX_TIME) {
+		Game.Update(DEFAULT_TIMESTEP);
+		if(Game.State == _Minigame::StateType::DONE)
+			break;
+
+		Time += DEFAULT_TIMESTEP;
+	}
+
+	if(Game.Bucket < Game.Prizes.size())
+		return Game.Prizes[Game.Bucket];
+
+	return nullptr;
+}
+
+// Simulate a request and time it
+_MinigameQueue::_MinigameResult _MinigameQueue::Solve(_MinigameRequest &Request) {
+	_MinigameResult Result;
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+	Result.Prize = Simulate(Request.Minigame, Request.Seed, Request.DropX);
+	Result.SimulateTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+	Result.Callback = std::move(Request.Callback);
+	Result.SubmitTime = Request.SubmitTime;
+
+	return Result;
+}
+
+// Thread loop
+void _MinigameQueue::Run() {
+	while(true) {
+
+		// Wait for request
+		_MinigameRequest Request;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this] { return Done || !Requests.empty(); });
+			if(Done)
+				return;
+
+			Request = std::move(Requests.front());
+			Requests.pop_front();
+		}
+
+		_MinigameResult Result = Solve(Request);
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Results.push_back(std::move(Result));
+	}
+}
@@ -0,0 +1,92 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <list>
+#include <cstdint>
+
+// Forward Declarations
+struct _MinigameType;
+struct _MinigameItem;
+
+// Called from Update on the server thread with the prize won, or null
+typedef std::function<void(const _MinigameItem *Prize)> MinigameCallbackType;
+
+// Verifies minigame drops on worker threads
+class _MinigameQueue {
+
+	public:
+
+		_MinigameQueue(int ThreadCount);
+		~_MinigameQueue();
+
+		void Submit(const _MinigameType *Minigame, uint32_t Seed, float DropX, MinigameCallbackType Callback);
+		void Update();
+		void ResetStats();
+		double GetStatsTime() const;
+
+		static const _MinigameItem *Simulate(const _MinigameType *Minigame, uint32_t Seed, float DropX);
+
+		// Stats
+		std::size_t Submitted;
+		std::size_t Overflowed;
+		std::size_t Delivered;
+		double TotalLatency;
+		double MaxLatency;
+		double TotalSimulateTime;
+
+	private:
+
+		struct _MinigameRequest {
+			const _MinigameType *Minigame;
+			uint32_t Seed;
+			float DropX;
+			MinigameCallbackType Callback;
+			uint64_t SubmitTime;
+		};
+
+		struct _MinigameResult {
+			const _MinigameItem *Prize;
+			MinigameCallbackType Callback;
+			uint64_t SubmitTime;
+			double SimulateTime;
+		};
+
+		void Run();
+		_MinigameResult Solve(_MinigameRequest &Request);
+
+		// Queues
+		std::list<_MinigameRequest> Requests;
+		std::list<_MinigameResult> Results;
+
+		// Stats
+		uint64_t StatsStartTime;
+
+		// Threading
+		std::vector<std::thread> Threads;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		bool Done;
+
+};
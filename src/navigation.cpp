@@ -0,0 +1,141 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <navigation.h>
+#include <objects/map.h>
+#include <stats.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <list>
+
+// Constructor
+_Navigation::_Navigation(const _Stats *Stats) :
+	EdgeCount(0),
+	FailedCount(0),
+	BuildTime(0.0),
+	Ready(false),
+	Done(false) {
+
+	Thread = std::thread(&_Navigation::Build, this, Stats);
+}
+
+// Destructor
+_Navigation::~_Navigation() {
+	Done = true;
+	Thread.join();
+}
+
+// Load every map and build next hop tables
+void _Navigation::Build(const _Stats *Stats) {
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+
+	// Assign dense indices
+	for(const auto &MapStat : Stats->Maps)
+		MapIDs.push_back(MapStat.first);
+	std::sort(MapIDs.begin(), MapIDs.end());
+	for(std::size_t i = 0; i < MapIDs.size(); i++)
+		MapIndex[MapIDs[i]] = i;
+
+	// Get map change events from each map
+	std::vector<std::vector<std::size_t>> Edges(MapIDs.size());
+	for(std::size_t i = 0; i < MapIDs.size(); i++) {
+		if(Done)
+			return;
+
+		_Map Map;
+		Map.Headless = true;
+		try {
+			Map.LoadTiles(Stats->Maps.at(MapIDs[i]).File);
+		}
+		catch(std::exception &Error) {
+			FailedCount++;
+			continue;
+		}
+		Map.IndexEvents();
+
+		for(const auto &IndexedEvent : Map.IndexedEvents) {
+			if(IndexedEvent.first.Type != _Map::EVENT_MAPCHANGE)
+				continue;
+
+			const auto &Iterator = MapIndex.find(IndexedEvent.first.Data);
+			if(Iterator == MapIndex.end() || Iterator->second == i)
+				continue;
+
+			if(std::find(Edges[i].begin(), Edges[i].end(), Iterator->second) == Edges[i].end()) {
+				Edges[i].push_back(Iterator->second);
+				EdgeCount++;
+			}
+		}
+
+		// Keep routes independent of hash order
+		std::sort(Edges[i].begin(), Edges[i].end());
+	}
+
+	BuildRoutes(Edges);
+
+	BuildTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+	Ready = true;
+}
+
+// Breadth first search from every map, storing the first step toward each target
+void _Navigation::BuildRoutes(const std::vector<std::vector<std::size_t>> &Edges) {
+	std::size_t Count = MapIDs.size();
+	NextHops.assign(Count * Count, 0);
+
+	std::vector<std::size_t> FirstHops(Count);
+	std::vector<bool> Visited(Count);
+	std::list<std::size_t> Queue;
+	for(std::size_t Source = 0; Source < Count; Source++) {
+		std::fill(Visited.begin(), Visited.end(), false);
+		Visited[Source] = true;
+
+		// Neighbors are their own first hop
+		for(std::size_t Adjacent : Edges[Source]) {
+			Visited[Adjacent] = true;
+			FirstHops[Adjacent] = Adjacent;
+			Queue.push_back(Adjacent);
+		}
+
+		while(!Queue.empty()) {
+			std::size_t Current = Queue.front();
+			Queue.pop_front();
+			NextHops[Source * Count + Current] = MapIDs[FirstHops[Current]];
+
+			for(std::size_t Adjacent : Edges[Current]) {
+				if(Visited[Adjacent])
+					continue;
+
+				Visited[Adjacent] = true;
+				FirstHops[Adjacent] = FirstHops[Current];
+				Queue.push_back(Adjacent);
+			}
+		}
+	}
+}
+
+// Get next map on the shortest route, return 0 if none or still building
+uint32_t _Navigation::GetNextHop(uint32_t SourceMapID, uint32_t TargetMapID) const {
+	if(!Ready)
+		return 0;
+
+	const auto &SourceIterator = MapIndex.find(SourceMapID);
+	const auto &TargetIterator = MapIndex.find(TargetMapID);
+	if(SourceIterator == MapIndex.end() || TargetIterator == MapIndex.end())
+		return 0;
+
+	return NextHops[SourceIterator->second * MapIDs.size() + TargetIterator->second];
+}
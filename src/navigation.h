@@ -0,0 +1,65 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <vector>
+
+// Forward Declarations
+class _Stats;
+
+// Shortest routes between maps built from map change events on a background thread
+class _Navigation {
+
+	public:
+
+		_Navigation(const _Stats *Stats);
+		~_Navigation();
+
+		uint32_t GetNextHop(uint32_t SourceMapID, uint32_t TargetMapID) const;
+		bool IsReady() const { return Ready; }
+
+		// Attributes
+		std::size_t EdgeCount;
+		std::size_t FailedCount;
+		double BuildTime;
+
+		std::size_t GetMapCount() const { return MapIDs.size(); }
+
+	private:
+
+		void Build(const _Stats *Stats);
+		void BuildRoutes(const std::vector<std::vector<std::size_t>> &Edges);
+
+		// Maps
+		std::vector<uint32_t> MapIDs;
+		std::unordered_map<uint32_t, std::size_t> MapIndex;
+
+		// Next map id for each source and target pair, 0 when unreachable
+		std::vector<uint32_t> NextHops;
+
+		// Threading
+		std::thread Thread;
+		std::atomic<bool> Ready;
+		std::atomic<bool> Done;
+
+};
@@ -0,0 +1,262 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <networkthread.h>
+#include <ae/servernetwork.h>
+#include <ae/buffer.h>
+#include <constants.h>
+#include <packet.h>
+#include <algorithm>
+#include <SDL_timer.h>
+
+// Constructor
+_NetworkThread::_NetworkThread(ae::_ServerNetwork *Network, bool AnswerPings) :
+	PeerCount(0),
+	Hardcore(false),
+	EventStalls(0),
+	CommandStalls(0),
+	ServiceTime(0),
+	ServicePasses(0),
+	Network(Network),
+	PingPacket(1024),
+	AnswerPings(AnswerPings),
+	Events(NETWORK_QUEUE_SIZE),
+	Commands(NETWORK_QUEUE_SIZE),
+	FreeData(NETWORK_QUEUE_SIZE),
+	Thread(nullptr),
+	Done(false),
+	HasEvents(false),
+	Waiting(false) {
+
+	Thread = new std::thread(&_NetworkThread::Run, this);
+}
+
+// Destructor
+_NetworkThread::~_NetworkThread() {
+	{
+		std::lock_guard<std::mutex> Lock(WorkMutex);
+		Done = true;
+	}
+	WorkSignal.notify_one();
+	Thread->join();
+	delete Thread;
+
+	// Free unhandled packets
+	ae::_NetworkEvent Event;
+	while(Events.Pop(Event))
+		FreeEvent(Event);
+}
+
+// Free packet data of an event that won't be handled
+void _NetworkThread::FreeEvent(ae::_NetworkEvent &Event) {
+	if(Event.Type == ae::_NetworkEvent::PACKET) {
+		delete Event.Data;
+		Event.Data = nullptr;
+	}
+}
+
+// Block until events arrive or timeout in seconds expires, return true if events are waiting
+bool _NetworkThread::WaitForEvents(double Timeout) {
+	std::unique_lock<std::mutex> Lock(SignalMutex);
+	if(Timeout > 0.0)
+		Signal.wait_for(Lock, std::chrono::duration<double>(Timeout), [this] { return HasEvents; });
+
+	bool Result = HasEvents;
+	HasEvents = false;
+
+	return Result;
+}
+
+// Queue a copy of a packet for sending, reusing storage from sent packets
+void _NetworkThread::SendPacket(ae::_Buffer &Buffer, ae::_Peer *Peer, ae::_Network::SendType Type, uint8_t Channel) {
+	_NetworkCommand Command;
+	Command.Type = _NetworkCommand::SEND;
+	Command.Peer = Peer;
+	FreeData.Pop(Command.Data);
+	Command.Data.assign(Buffer.GetData(), Buffer.GetData() + Buffer.GetCurrentSize());
+	Command.SendType = Type;
+	Command.Channel = Channel;
+	Queue(Command);
+}
+
+// Queue peer disconnect
+void _NetworkThread::DisconnectPeer(ae::_Peer *Peer, uint32_t Value) {
+	_NetworkCommand Command;
+	Command.Type = _NetworkCommand::DISCONNECT;
+	Command.Peer = Peer;
+	Command.Value = Value;
+	Queue(Command);
+}
+
+// Queue disconnect of all peers
+void _NetworkThread::DisconnectAll(uint32_t Value) {
+	_NetworkCommand Command;
+	Command.Type = _NetworkCommand::DISCONNECT_ALL;
+	Command.Peer = nullptr;
+	Command.Value = Value;
+	Queue(Command);
+}
+
+// Queue peer deletion after its disconnect event has been handled
+void _NetworkThread::DeletePeer(ae::_Peer *Peer) {
+	_NetworkCommand Command;
+	Command.Type = _NetworkCommand::DELETE_PEER;
+	Command.Peer = Peer;
+	Queue(Command);
+}
+
+// Add command to queue, waiting for space if full
+void _NetworkThread::Queue(_NetworkCommand &Command) {
+	if(!Commands.Push(std::move(Command))) {
+		CommandStalls++;
+		while(!Commands.Push(std::move(Command)))
+			std::this_thread::yield();
+	}
+
+	// Wake network thread if it's waiting
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(Waiting) {
+		std::lock_guard<std::mutex> Lock(WorkMutex);
+		WorkSignal.notify_one();
+	}
+}
+
+// Answer server info pings
+void _NetworkThread::HandlePings(ae::_ServerNetwork *Network, ae::_Buffer &PingPacket, uint16_t PeerCount, bool Hardcore) {
+	ae::_NetworkAddress PingAddress;
+	while(Network->CheckPings(PingPacket, PingAddress)) {
+		PingType Type = PingPacket.Read<PingType>();
+
+		// Handle ping types
+		switch(Type) {
+			case PingType::SERVER_INFO: {
+				ae::_Buffer PongPacket;
+				PongPacket.Write<PingType>(PingType::SERVER_INFO_RESPONSE);
+				PongPacket.Write<uint16_t>(Network->GetListenPort());
+				PongPacket.Write<uint16_t>(PeerCount);
+				PongPacket.Write<uint16_t>(Network->GetMaxPeers());
+				PongPacket.WriteBit(Hardcore);
+				Network->SendPingPacket(PongPacket, ae::_NetworkAddress(PingAddress.Host, PingAddress.Port));
+			} break;
+			default:
+			break;
+		}
+
+		// Reset packet
+		PingPacket.StartRead();
+	}
+}
+
+// Run a queued command against the network
+void _NetworkThread::HandleCommand(_NetworkCommand &Command) {
+	switch(Command.Type) {
+		case _NetworkCommand::SEND: {
+			SendBuffer.StartRead();
+			SendBuffer.WriteData(Command.Data.data(), (unsigned int)Command.Data.size());
+			Network->SendPacket(SendBuffer, Command.Peer, Command.SendType, Command.Channel);
+
+			// Hand storage back to the simulation thread, drop it if the queue is full
+			FreeData.Push(std::move(Command.Data));
+		} break;
+		case _NetworkCommand::DISCONNECT:
+			Network->DisconnectPeer(Command.Peer, Command.Value);
+		break;
+		case _NetworkCommand::DISCONNECT_ALL:
+			Network->DisconnectAll(Command.Value);
+		break;
+		case _NetworkCommand::DELETE_PEER:
+			Network->DeletePeer(Command.Peer);
+		break;
+	}
+}
+
+// Thread loop
+void _NetworkThread::Run() {
+	Uint64 Timer = SDL_GetPerformanceCounter();
+	int Wait = NETWORK_THREAD_MIN_WAIT;
+	while(!Done) {
+		Uint64 ServiceStart = SDL_GetPerformanceCounter();
+
+		// Send outbound packets
+		bool Sent = false;
+		_NetworkCommand Command;
+		while(Commands.Pop(Command)) {
+			HandleCommand(Command);
+			Sent = true;
+		}
+
+		// Service host
+		double FrameTime = (ServiceStart - Timer) / (double)SDL_GetPerformanceFrequency();
+		Timer = ServiceStart;
+		Network->Update(FrameTime);
+
+		// Pings use the host's sockets so they are answered here
+		if(AnswerPings)
+			HandlePings(Network, PingPacket, PeerCount, Hardcore);
+
+		// Pass events to simulation thread
+		bool Received = false;
+		ae::_NetworkEvent Event;
+		while(Network->GetNetworkEvent(Event)) {
+			if(!Events.Push(std::move(Event))) {
+
+				// Wait for the simulation thread to catch up
+				EventStalls++;
+				bool Queued = false;
+				while(!Done && !(Queued = Events.Push(std::move(Event))))
+					std::this_thread::yield();
+
+				// Shutting down with a full queue
+				if(!Queued)
+					FreeEvent(Event);
+			}
+
+			Received = true;
+		}
+
+		// Wake simulation thread
+		if(Received) {
+			{
+				std::lock_guard<std::mutex> Lock(SignalMutex);
+				HasEvents = true;
+			}
+			Signal.notify_one();
+		}
+
+		ServiceTime += (SDL_GetPerformanceCounter() - ServiceStart) * 1000000 / SDL_GetPerformanceFrequency();
+		ServicePasses++;
+
+		// Poll less often while idle, commands wake the thread right away
+		Wait = (Sent || Received) ? NETWORK_THREAD_MIN_WAIT : std::min(Wait * 2, NETWORK_THREAD_MAX_WAIT);
+		std::unique_lock<std::mutex> Lock(WorkMutex);
+		Waiting = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		WorkSignal.wait_for(Lock, std::chrono::microseconds(Wait), [this] { return Done || Commands.Size() > 0; });
+		Waiting = false;
+	}
+
+	// Flush remaining sends
+	_NetworkCommand Command;
+	while(Commands.Pop(Command))
+		HandleCommand(Command);
+	Network->Update(0);
+
+	// Free events that arrived after the last handoff
+	ae::_NetworkEvent Event;
+	while(Network->GetNetworkEvent(Event))
+		FreeEvent(Event);
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <ae/network.h>
+#include <ae/buffer.h>
+#include <ringbuffer.h>
+#include <condition_variable>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Forward Declarations
+namespace ae {
+	class _ServerNetwork;
+	class _Buffer;
+	class _Peer;
+}
+
+// Request from the simulation thread to the network thread
+struct _NetworkCommand {
+	enum CommandType {
+		SEND,
+		DISCONNECT,
+		DISCONNECT_ALL,
+		DELETE_PEER,
+	};
+
+	CommandType Type;
+	ae::_Peer *Peer;
+	std::vector<char> Data;
+	ae::_Network::SendType SendType;
+	uint8_t Channel;
+	uint32_t Value;
+};
+
+// Services the ENet host on its own thread
+class _NetworkThread {
+
+	public:
+
+		_NetworkThread(ae::_ServerNetwork *Network, bool AnswerPings);
+		~_NetworkThread();
+
+		// Simulation thread interface
+		bool GetNetworkEvent(ae::_NetworkEvent &Event) { return Events.Pop(Event); }
+		bool WaitForEvents(double Timeout);
+		void SendPacket(ae::_Buffer &Buffer, ae::_Peer *Peer, ae::_Network::SendType Type, uint8_t Channel);
+		void DisconnectPeer(ae::_Peer *Peer, uint32_t Value);
+		void DisconnectAll(uint32_t Value);
+		void DeletePeer(ae::_Peer *Peer);
+
+		// Answer server info pings
+		static void HandlePings(ae::_ServerNetwork *Network, ae::_Buffer &PingPacket, uint16_t PeerCount, bool Hardcore);
+
+		// Server info for ping responses, set by the simulation thread
+		std::atomic<uint16_t> PeerCount;
+		std::atomic<bool> Hardcore;
+
+		// Stats
+		std::size_t GetEventQueueSize() const { return Events.Size(); }
+		std::size_t GetCommandQueueSize() const { return Commands.Size(); }
+		std::atomic<uint64_t> EventStalls;
+		std::atomic<uint64_t> CommandStalls;
+		std::atomic<uint64_t> ServiceTime;
+		std::atomic<uint64_t> ServicePasses;
+
+	private:
+
+		void Run();
+		void Queue(_NetworkCommand &Command);
+		void HandleCommand(_NetworkCommand &Command);
+		static void FreeEvent(ae::_NetworkEvent &Event);
+
+		// Network
+		ae::_ServerNetwork *Network;
+		ae::_Buffer PingPacket;
+		bool AnswerPings;
+		ae::_Buffer SendBuffer;
+
+		// Queues
+		_RingBuffer<ae::_NetworkEvent> Events;
+		_RingBuffer<_NetworkCommand> Commands;
+		_RingBuffer<std::vector<char>> FreeData;
+
+		// Threading
+		std::thread *Thread;
+		std::atomic<bool> Done;
+
+		// Event signal
+		std::mutex SignalMutex;
+		std::condition_variable Signal;
+		bool HasEvents;
+
+		// Command signal, only sent while the network thread is waiting
+		std::mutex WorkMutex;
+		std::condition_variable WorkSignal;
+		std::atomic<bool> Waiting;
+
+};
@@ -27,7 +27,6 @@
 #include <objects/battle.h>
 #include <ae/manager.h>
 #include <ae/buffer.h>
-#include <ae/random.h>
 #include <packet.h>
 #include <constants.h>
 #include <server.h>
@@ -100,7 +99,7 @@ bool _Action::Resolve(ae::_Buffer &Data, _Object *Source, ScopeType Scope) {
 			}
 			else {
 				if(Source->Character->Battle)
-					ConsumeRoll = ae::GetRandomInt(1, 100);
+					ConsumeRoll = std::uniform_int_distribution<int>(1, 100)(Source->Character->Battle->Random);
 			}
 
 			// Roll to consume item
@@ -112,8 +111,8 @@ bool _Action::Resolve(ae::_Buffer &Data, _Object *Source, ScopeType Scope) {
 
 		// Set cooldown
 		if(!SkillUnlocked && ItemUsed->Cooldown > 0.0) {
-			Source->Character->Cooldowns[ItemUsed->ID].Duration = ItemUsed->Cooldown * Source->Character->Attributes["Cooldowns"].Mult();
-			Source->Character->Cooldowns[ItemUsed->ID].MaxDuration = ItemUsed->Cooldown * Source->Character->Attributes["Cooldowns"].Mult();
+			double Duration = ItemUsed->Cooldown * Source->Character->Attributes["Cooldowns"].Mult();
+			Source->Character->SetCooldown(ItemUsed->ID, Duration, Duration);
 		}
 	}
 
@@ -38,11 +38,11 @@
 #include <ae/program.h>
 #include <ae/assets.h>
 #include <ae/font.h>
-#include <ae/random.h>
 #include <ae/input.h>
 #include <constants.h>
 #include <server.h>
 #include <actiontype.h>
+#include <botbrain.h>
 #include <scripting.h>
 #include <stats.h>
 #include <config.h>
@@ -71,6 +71,7 @@ _Battle::_Battle() :
 	BountyEarned(0.0f),
 	BountyClaimed(0.0f),
 	Boss(false),
+	Seed(0),
 
 	Time(0),
 	WaitTimer(0),
@@ -101,6 +102,11 @@ void _Battle::Update(double FrameTime) {
 
 	// Check for end
 	if(Server) {
+		Scripting->Random = &Random;
+
+		// Get actions for monsters
+		if(Config.BatchMonsterAI)
+			UpdateMonsterAI();
 
 		// Count alive objects for each side
 		int AliveCount[2] = { 0, 0 };
@@ -115,6 +121,8 @@ void _Battle::Update(double FrameTime) {
 			if(WaitTimer >= BATTLE_WAITDEADTIME)
 				ServerEndBattle();
 		}
+
+		Scripting->Random = nullptr;
 	}
 	else {
 
@@ -148,6 +156,59 @@ void _Battle::Update(double FrameTime) {
 	Time += FrameTime;
 }
 
+// Return true if a monster is waiting for its AI to pick an action
+static bool IsWaitingOnAI(const _Object *Object) {
+	return Object->IsMonster() && Object->Monster->AI.length() && Object->Character->IsAlive() && Object->Fighter->TurnTimer >= 1.0 && !Object->Character->Action.IsSet();
+}
+
+// Run AI for every monster ready to act with one script call per side
+void _Battle::UpdateMonsterAI() {
+	for(uint8_t Side = 0; Side < 2; Side++) {
+
+		// Check for monsters waiting on an action
+		bool HasReady = false;
+		for(const auto &Object : Objects) {
+			if(Object->Fighter->BattleSide == Side && !Object->Deleted && IsWaitingOnAI(Object)) {
+				HasReady = true;
+				break;
+			}
+		}
+		if(!HasReady)
+			continue;
+
+		// Separate object list
+		std::vector<_Object *> Allies, Enemies;
+		Allies.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
+		Enemies.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
+		GetSeparateObjectList(Side, Allies, Enemies);
+		if(!Enemies.size())
+			continue;
+
+		// Get ready monsters as indexes into ally list
+		std::vector<int> Ready;
+		for(std::size_t i = 0; i < Allies.size(); i++) {
+			if(IsWaitingOnAI(Allies[i])) {
+				Allies[i]->Character->Targets.clear();
+				Ready.push_back((int)i);
+			}
+		}
+
+		// Call lua script
+		uint64_t PushedObjects = Scripting->PushedObjects;
+		if(Scripting->StartMethodCall("AI_Batch", "Update")) {
+			Scripting->PushReadyMonsters(Allies, Ready);
+			Scripting->PushObjectList(Enemies);
+			Scripting->PushObjectList(Allies);
+			Scripting->MethodCall(3, 0);
+			Scripting->FinishMethodCall();
+			Server->MonsterAICalls++;
+		}
+
+		Server->MonsterAITurns += Ready.size();
+		Server->MonsterAIPushes += Scripting->PushedObjects - PushedObjects;
+	}
+}
+
 // Render the battle screen
 void _Battle::Render(double BlendFactor) {
 	BattleElement->Render();
@@ -488,7 +549,7 @@ void _Battle::AddObject(_Object *Object, uint8_t Side, bool Join) {
 	Object->Fighter->Corpse = 1;
 	if(Server) {
 		Object->Character->GenerateNextBattle();
-		Object->Fighter->TurnTimer = std::clamp(ae::GetRandomReal(0, BATTLE_MAX_START_TURNTIMER) + Object->Character->Attributes["Initiative"].Mult(), 0.0, 1.0);
+		Object->Fighter->TurnTimer = std::clamp(std::uniform_real_distribution<double>(0, BATTLE_MAX_START_TURNTIMER)(Random) + Object->Character->Attributes["Initiative"].Mult(), 0.0, 1.0);
 
 		// Send player join packet to current objects
 		if(Join) {
@@ -715,7 +776,7 @@ void _Battle::ServerEndBattle() {
 
 				// Get shuffled copy of reward objects
 				std::vector<_Object *> ShuffledRewardObjects { std::begin(RewardObjects), std::end(RewardObjects) };
-				std::shuffle(ShuffledRewardObjects.begin(), ShuffledRewardObjects.end(), ae::RandomGenerator);
+				std::shuffle(ShuffledRewardObjects.begin(), ShuffledRewardObjects.end(), Random);
 
 				// Iterate through monsters
 				std::size_t PlayerIndex = 0;
@@ -728,7 +789,7 @@ void _Battle::ServerEndBattle() {
 						// Generate item
 						std::vector<uint32_t> ItemDrops;
 						ItemDrops.reserve(10);
-						Stats->GenerateItemDrops(Object->Monster->DatabaseID, 1, ItemDrops, Player->Character->Attributes["DropRate"].Mult());
+						Stats->GenerateItemDrops(Object->Monster->DatabaseID, 1, ItemDrops, Player->Character->Attributes["DropRate"].Mult(), Random);
 						for(auto &ItemID : ItemDrops)
 							Player->Fighter->ItemDropsReceived.push_back(ItemID);
 					}
@@ -765,7 +826,7 @@ void _Battle::ServerEndBattle() {
 
 					// Start cooldown timer
 					if(Cooldown > 0.0)
-						Object->Character->BossCooldowns[Zone] = std::max(Cooldown * Object->Character->Attributes["BossCooldowns"].Mult(), 10.0);
+						Object->Character->SetBossCooldown(Zone, std::max(Cooldown * Object->Character->Attributes["BossCooldowns"].Mult(), 10.0));
 
 					// Add to kill count
 					if(Boss) {
@@ -863,7 +924,7 @@ void _Battle::ServerEndBattle() {
 		// Get boss cooldown
 		double BossCooldown = 0.0;
 		if(Boss)
-			BossCooldown = Object->Character->BossCooldowns[Zone];
+			BossCooldown = Object->Character->GetBossCooldown(Zone);
 
 		// Write results
 		ae::_Buffer Packet;
@@ -899,7 +960,9 @@ void _Battle::ServerEndBattle() {
 
 		// Update bot goal
 		if(Object->Character->Bot) {
-			if(Scripting->StartMethodCall("Bot_Server", "DetermineNextGoal")) {
+			if(Object->BotBrain)
+				Object->BotBrain->DetermineNextGoal();
+			else if(Scripting->StartMethodCall("Bot_Server", "DetermineNextGoal")) {
 				Scripting->PushObject(Object);
 				Scripting->MethodCall(1, 0);
 				Scripting->FinishMethodCall();
@@ -909,7 +972,7 @@ void _Battle::ServerEndBattle() {
 		else if(Object->Peer) {
 			if(Full)
 				Server->SendInventoryFullMessage(Object->Peer);
-			Server->Network->SendPacket(Packet, Object->Peer);
+			Server->SendPacket(Packet, Object->Peer);
 			Server->SendHUD(Object->Peer);
 		}
 	}
@@ -930,7 +993,7 @@ void _Battle::ServerEndBattle() {
 		Packet.Write<PacketType>(PacketType::PLAYER_STATUSEFFECTS);
 		Packet.Write<ae::NetworkIDType>(Summons.Object->NetworkID);
 		Summons.Object->SerializeStatusEffects(Packet);
-		Server->Network->SendPacket(Packet, Summons.Object->Peer);
+		Server->SendPacket(Packet, Summons.Object->Peer);
 	}
 
 	Deleted = true;
@@ -1150,7 +1213,7 @@ void _Battle::BroadcastPacket(ae::_Buffer &Data) {
 	// Send packet to all players
 	for(auto &Object : Objects) {
 		if(!Object->Deleted && Object->Peer) {
-			Server->Network->SendPacket(Data, Object->Peer);
+			Server->SendPacket(Data, Object->Peer);
 		}
 	}
 }
@@ -1165,7 +1228,7 @@ void _Battle::BroadcastStatusEffects(_Object *UpdatedObject) {
 	// Send packet to all players
 	for(auto &Object : Objects) {
 		if(UpdatedObject != Object && !Object->Deleted && Object->Peer) {
-			Server->Network->SendPacket(Packet, Object->Peer);
+			Server->SendPacket(Packet, Object->Peer);
 		}
 	}
 }
@@ -21,6 +21,7 @@
 #include <ae/baseobject.h>
 #include <objects/action.h>
 #include <list>
+#include <random>
 #include <vector>
 #include <cstdint>
 
@@ -86,6 +87,7 @@ class _Battle : public ae::_BaseObject {
 
 		// Updates
 		void Update(double FrameTime) override;
+		void UpdateMonsterAI();
 		void Render(double BlendFactor);
 
 		// Network
@@ -125,6 +127,10 @@ class _Battle : public ae::_BaseObject {
 		float BountyClaimed;
 		bool Boss;
 
+		// Random stream for all server rolls in this battle
+		std::mt19937 Random;
+		uint32_t Seed;
+
 	private:
 
 		void GetBattleOffset(int SideIndex, _Object *Object);
@@ -21,12 +21,14 @@
 #include <objects/components/monster.h>
 #include <objects/object.h>
 #include <objects/statuseffect.h>
+#include <objects/battle.h>
 #include <objects/buff.h>
 #include <ae/buffer.h>
 #include <ae/random.h>
 #include <ae/database.h>
 #include <ae/assets.h>
 #include <scripting.h>
+#include <server.h>
 #include <packet.h>
 #include <stats.h>
 #include <algorithm>
@@ -39,6 +41,7 @@ _Character::_Character(_Object *Object) :
 	CharacterID(0),
 	BuildID(1),
 	UpdateTimer(0.0),
+	RegenTimerID(0),
 
 	Battle(nullptr),
 	HUD(nullptr),
@@ -47,6 +50,7 @@ _Character::_Character(_Object *Object) :
 	Portrait(nullptr),
 	PortraitID(0),
 
+	BossCooldownClock(0.0),
 	IdleTime(0.0),
 	NextBattle(0),
 	Invisible(0),
@@ -69,6 +73,7 @@ _Character::_Character(_Object *Object) :
 	BaseSpellDamage(100),
 	BaseAttackPeriod(BATTLE_DEFAULTATTACKPERIOD),
 
+	CooldownClock(0.0),
 	SkillPoints(0),
 	SkillPointsUnlocked(0),
 	SkillPointsUsed(0),
@@ -82,6 +87,7 @@ _Character::_Character(_Object *Object) :
 	Enchanter(nullptr),
 	Minigame(nullptr),
 	Seed(0),
+	MinigamesPending(0),
 
 	TradePlayer(nullptr),
 	TradeGold(0),
@@ -97,7 +103,10 @@ _Character::_Character(_Object *Object) :
 	InventoryOpen(false),
 	SkillsOpen(false),
 
-	Bot(false) {
+	Bot(false),
+	PathRequestID(0),
+	NextPathTime(0.0),
+	PathPending(false) {
 
 	Targets.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
 	ActionBar.resize(ACTIONBAR_MAX_SIZE);
@@ -120,111 +129,214 @@ void _Character::Init() {
 		Attributes[Attribute.second.Name].Int = 0;
 }
 
+// Restore constructed state, keeping container storage for reuse
+void _Character::Reset() {
+	CharacterID = 0;
+	BuildID = 1;
+	UpdateTimer = 0.0;
+	RegenTimerID = 0;
+
+	Battle = nullptr;
+	HUD = nullptr;
+
+	StatusTexture = nullptr;
+	Portrait = nullptr;
+	PortraitID = 0;
+
+	BossCooldowns.clear();
+	BossCooldownClock = 0.0;
+	BossKills.clear();
+	PartyName.clear();
+	IdleTime = 0.0;
+	NextBattle = 0;
+	Invisible = 0;
+	Hardcore = false;
+	Offline = false;
+	Status = 0;
+
+	CalcLevelStats = true;
+	Level = 0;
+	ExperienceNeeded = 0;
+	ExperienceNextLevel = 0;
+
+	BaseMaxHealth = 0;
+	BaseMaxMana = 0;
+	BaseMinDamage = 0;
+	BaseMaxDamage = 0;
+	BaseArmor = 0;
+	BaseDamageBlock = 0;
+	BaseBattleSpeed = 100;
+	BaseSpellDamage = 100;
+	BaseAttackPeriod = BATTLE_DEFAULTATTACKPERIOD;
+
+	// Attributes are set again by Init, so keep their nodes
+	for(auto &Attribute : Attributes)
+		Attribute.second.Int = 0;
+	BaseResistances.clear();
+	Sets.clear();
+	BattleSpeedBeforeBuffs = 0;
+
+	DeleteStatusEffects();
+	Unlocks.clear();
+
+	Skills.clear();
+	MaxSkillLevels.clear();
+	Cooldowns.clear();
+	CooldownClock = 0.0;
+	SkillPoints = 0;
+	SkillPointsUnlocked = 0;
+	SkillPointsUsed = 0;
+	SkillPointsOnActionBar = 0;
+
+	for(std::size_t i = 0; i < ActionBar.size(); i++) {
+		ActionBar[i] = _Action();
+		ActionBar[i].ActionBarSlot = i;
+	}
+	BeltSize = ACTIONBAR_DEFAULT_BELTSIZE;
+	SkillBarSize = ACTIONBAR_DEFAULT_SKILLBARSIZE;
+
+	Vendor = nullptr;
+	Trader = nullptr;
+	Blacksmith = nullptr;
+	Enchanter = nullptr;
+	Minigame = nullptr;
+	Seed = 0;
+	MinigamesPending = 0;
+
+	TradePlayer = nullptr;
+	TradeGold = 0;
+	WaitingForTrade = false;
+	TradeAccepted = false;
+
+	Targets.clear();
+	Action = _Action();
+
+	LoadMapID = 0;
+	SpawnMapID = 1;
+	SpawnPoint = 0;
+	TeleportTime = -1;
+
+	MenuOpen = false;
+	InventoryOpen = false;
+	SkillsOpen = false;
+
+	Bot = false;
+	Path.clear();
+	PathRequestID = 0;
+	NextPathTime = 0.0;
+	PathPending = false;
+}
+
 // Update
 void _Character::Update(double FrameTime) {
 
-	// Update stats
-	UpdateTimer += FrameTime;
-	if(UpdateTimer >= 1.0) {
-		UpdateTimer -= 1.0;
-
-		// Update stats on server
-		if(Object->Server && IsAlive()) {
-			_StatChange StatChange;
-			StatChange.Object = Object;
-
-			// Update regen
-			if((Attributes["Health"].Int < Attributes["MaxHealth"].Int && Attributes["HealthRegen"].Int > 0) || Attributes["HealthRegen"].Int < 0)
-				StatChange.Values["Health"].Int = Attributes["HealthRegen"].Int;
-			if((Attributes["Mana"].Int < Attributes["MaxMana"].Int && Attributes["ManaRegen"].Int > 0) || Attributes["ManaRegen"].Int < 0)
-				StatChange.Values["Mana"].Int = Attributes["ManaRegen"].Int;
-
-			// Update object
-			if(StatChange.Values.size() != 0) {
-				Object->UpdateStats(StatChange);
-
-				// Build packet
-				ae::_Buffer Packet;
-				Packet.Write<PacketType>(PacketType::STAT_CHANGE);
-				StatChange.Serialize(Packet);
-
-				// Send packet to player
-				Object->SendPacket(Packet);
+	// Regen and status effects run from the timer wheel on the server
+	if(Object->Server) {
+
+		// Start regen timer
+		if(!RegenTimerID) {
+			RegenTimerID = ++Object->Server->TimerCount;
+			Object->Server->TimerWheel.Schedule(Object->Server->Time, 1.0, { Object->NetworkID, TIMER_REGEN, RegenTimerID });
+		}
+
+		// Remove status effects on death
+		if(!IsAlive()) {
+			for(auto Iterator = StatusEffects.begin(); Iterator != StatusEffects.end(); ) {
+				_StatusEffect *StatusEffect = *Iterator;
+				if(!StatusEffect->Buff->Summon) {
+					delete StatusEffect;
+					Iterator = StatusEffects.erase(Iterator);
+
+					CalculateStats();
+				}
+				else
+					++Iterator;
 			}
 		}
 	}
+	else {
 
-	// Update status effects
-	for(auto Iterator = StatusEffects.begin(); Iterator != StatusEffects.end(); ) {
-		_StatusEffect *StatusEffect = *Iterator;
-		StatusEffect->Time += FrameTime;
-
-		// Call status effect's update every second
-		if(StatusEffect->Time >= 1.0) {
-			StatusEffect->Time -= 1.0;
+		// Prune expired cooldowns
+		UpdateTimer += FrameTime;
+		if(UpdateTimer >= 1.0) {
+			UpdateTimer -= 1.0;
 
-			// Resolve effects
-			if(Object->Server && IsAlive()) {
-				Object->ResolveBuff(StatusEffect, "Update");
+			for(auto Iterator = Cooldowns.begin(); Iterator != Cooldowns.end(); ) {
+				if(Iterator->second.Deadline <= CooldownClock)
+					Iterator = Cooldowns.erase(Iterator);
+				else
+					++Iterator;
+			}
+			for(auto Iterator = BossCooldowns.begin(); Iterator != BossCooldowns.end(); ) {
+				if(Iterator->second <= BossCooldownClock)
+					Iterator = BossCooldowns.erase(Iterator);
+				else
+					++Iterator;
 			}
 		}
 
-		// Update duration if not infinite
-		if(!StatusEffect->Infinite) {
-
-			// Don't update during battle if it pauses
-			if(!StatusEffect->Buff->PauseDuringBattle || (StatusEffect->Buff->PauseDuringBattle && !Object->Character->Battle))
-				StatusEffect->Duration -= FrameTime;
+		// Update status effects
+		for(auto Iterator = StatusEffects.begin(); Iterator != StatusEffects.end(); ) {
+			_StatusEffect *StatusEffect = *Iterator;
+			StatusEffect->Time += FrameTime;
+			if(StatusEffect->Time >= 1.0)
+				StatusEffect->Time -= 1.0;
 
-			// Delete
-			if(StatusEffect->Duration <= 0.0)
-				StatusEffect->Deleted = true;
-		}
+			// Update duration if not infinite
+			if(!StatusEffect->Infinite) {
 
-		// Clean up
-		if(StatusEffect->Deleted || (!IsAlive() && !StatusEffect->Buff->Summon)) {
-			delete StatusEffect;
-			Iterator = StatusEffects.erase(Iterator);
+				// Don't update during battle if it pauses
+				if(!StatusEffect->Buff->PauseDuringBattle || !Battle)
+					StatusEffect->Duration -= FrameTime;
 
-			CalculateStats();
-		}
-		else
-			++Iterator;
-	}
+				// Delete
+				if(StatusEffect->Duration <= 0.0)
+					StatusEffect->Deleted = true;
+			}
 
-	// Update battle cooldowns
-	bool SendBossCooldownUpdate = false;
-	if(IdleTime <= PLAYER_IDLE_TIME) {
-		for(auto Iterator = BossCooldowns.begin(); Iterator != BossCooldowns.end(); ) {
-			Iterator->second -= FrameTime;
+			// Clean up
+			if(StatusEffect->Deleted || (!IsAlive() && !StatusEffect->Buff->Summon)) {
+				delete StatusEffect;
+				Iterator = StatusEffects.erase(Iterator);
 
-			// Remove cooldown
-			if(Iterator->second <= 0.0) {
-				SendBossCooldownUpdate = true;
-				Iterator = BossCooldowns.erase(Iterator);
+				CalculateStats();
 			}
 			else
 				++Iterator;
 		}
 	}
 
-	// Update cooldowns
-	for(auto Iterator = Cooldowns.begin(); Iterator != Cooldowns.end(); ) {
-		Iterator->second.Duration -= FrameTime;
+	// Advance cooldown clocks, boss cooldowns only count down while active
+	CooldownClock += FrameTime;
+	if(IdleTime <= PLAYER_IDLE_TIME)
+		BossCooldownClock += FrameTime;
+}
 
-		// Remove cooldown
-		if(Iterator->second.Duration <= 0.0)
-			Iterator = Cooldowns.erase(Iterator);
-		else
-			++Iterator;
-	}
+// Apply health and mana regen on the server
+void _Character::UpdateRegen() {
+	if(!IsAlive())
+		return;
+
+	_StatChange StatChange;
+	StatChange.Object = Object;
 
-	// Notify client of boss being off cooldown
-	if(Object->Server && SendBossCooldownUpdate) {
+	// Update regen
+	if((Attributes["Health"].Int < Attributes["MaxHealth"].Int && Attributes["HealthRegen"].Int > 0) || Attributes["HealthRegen"].Int < 0)
+		StatChange.Values["Health"].Int = Attributes["HealthRegen"].Int;
+	if((Attributes["Mana"].Int < Attributes["MaxMana"].Int && Attributes["ManaRegen"].Int > 0) || Attributes["ManaRegen"].Int < 0)
+		StatChange.Values["Mana"].Int = Attributes["ManaRegen"].Int;
+
+	// Update object
+	if(StatChange.Values.size() != 0) {
+		Object->UpdateStats(StatChange);
+
+		// Build packet
 		ae::_Buffer Packet;
-		Packet.Write<PacketType>(PacketType::PLAYER_BOSSCOOLDOWNS);
-		Object->SerializeBossCooldowns(Packet);
-		Object->SendPacket(Packet, false);
+		Packet.Write<PacketType>(PacketType::STAT_CHANGE);
+		StatChange.Serialize(Packet);
+
+		// Send packet to player
+		Object->SendPacket(Packet);
 	}
 }
 
@@ -691,6 +803,9 @@ bool _Character::AcceptingMoveInput() {
 	if(Battle)
 		return false;
 
+	if(Object->TransferMapID)
+		return false;
+
 	if(Object->Controller->WaitForServer)
 		return false;
 
@@ -725,7 +840,15 @@ void _Character::GenerateNextBattle() {
 
 // Generate damage
 int _Character::GenerateDamage() {
-	return ae::GetRandomInt(Attributes["MinDamage"].Int, Attributes["MaxDamage"].Int);
+	return std::uniform_int_distribution<int>(Attributes["MinDamage"].Int, Attributes["MaxDamage"].Int)(GetRandom());
+}
+
+// Get random stream for rolls, server battles use their own
+std::mt19937 &_Character::GetRandom() {
+	if(Battle && Object->Server)
+		return Battle->Random;
+
+	return ae::RandomGenerator;
 }
 
 // Get damage power from a type
@@ -854,6 +977,137 @@ bool _Character::CanEquipSkill(const _Item *Skill) {
 	return false;
 }
 
+// Get remaining cooldown of an item
+double _Character::GetCooldown(uint32_t ItemID) const {
+	const auto &Iterator = Cooldowns.find(ItemID);
+	if(Iterator == Cooldowns.end())
+		return 0.0;
+
+	return Iterator->second.Deadline - CooldownClock;
+}
+
+// Start cooldown of an item
+void _Character::SetCooldown(uint32_t ItemID, double Duration, double MaxDuration) {
+	_Cooldown &Cooldown = Cooldowns[ItemID];
+	Cooldown.Deadline = CooldownClock + Duration;
+	Cooldown.MaxDuration = MaxDuration;
+
+	if(Object->Server)
+		Object->Server->TimerWheel.Schedule(Object->Server->Time, Duration, { Object->NetworkID, TIMER_COOLDOWN, ItemID });
+}
+
+// Get remaining boss cooldown of a zone
+double _Character::GetBossCooldown(uint32_t Zone) const {
+	const auto &Iterator = BossCooldowns.find(Zone);
+	if(Iterator == BossCooldowns.end())
+		return 0.0;
+
+	return Iterator->second - BossCooldownClock;
+}
+
+// Start boss cooldown of a zone
+void _Character::SetBossCooldown(uint32_t Zone, double Duration) {
+	BossCooldowns[Zone] = BossCooldownClock + Duration;
+
+	if(Object->Server)
+		Object->Server->TimerWheel.Schedule(Object->Server->Time, Duration, { Object->NetworkID, TIMER_BOSSCOOLDOWN, Zone });
+}
+
+// Handle timer from the server's timer wheel
+void _Character::ExpireTimer(uint32_t Type, uint32_t ID) {
+	switch(Type) {
+		case TIMER_COOLDOWN: {
+			const auto &Iterator = Cooldowns.find(ID);
+			if(Iterator == Cooldowns.end())
+				return;
+
+			// Timer was replaced by a longer cooldown
+			double Remaining = Iterator->second.Deadline - CooldownClock;
+			if(Remaining > 0.0) {
+				Object->Server->TimerWheel.Schedule(Object->Server->Time, Remaining, { Object->NetworkID, TIMER_COOLDOWN, ID });
+				return;
+			}
+
+			Cooldowns.erase(Iterator);
+		} break;
+		case TIMER_BOSSCOOLDOWN: {
+			const auto &Iterator = BossCooldowns.find(ID);
+			if(Iterator == BossCooldowns.end())
+				return;
+
+			// Clock was paused while idle
+			double Remaining = Iterator->second - BossCooldownClock;
+			if(Remaining > 0.0) {
+				Object->Server->TimerWheel.Schedule(Object->Server->Time, Remaining, { Object->NetworkID, TIMER_BOSSCOOLDOWN, ID });
+				return;
+			}
+
+			BossCooldowns.erase(Iterator);
+
+			// Notify client of boss being off cooldown
+			ae::_Buffer Packet;
+			Packet.Write<PacketType>(PacketType::PLAYER_BOSSCOOLDOWNS);
+			Object->SerializeBossCooldowns(Packet);
+			Object->SendPacket(Packet, false);
+		} break;
+		case TIMER_REGEN: {
+
+			// Timer belongs to a previous owner of this id
+			if(ID != RegenTimerID)
+				return;
+
+			UpdateRegen();
+			Object->Server->TimerWheel.Schedule(Object->Server->Time, 1.0, { Object->NetworkID, TIMER_REGEN, RegenTimerID });
+		} break;
+		case TIMER_STATUSEFFECT: {
+
+			// Timer was replaced or the effect is gone
+			auto Iterator = StatusEffects.begin();
+			for(; Iterator != StatusEffects.end(); ++Iterator) {
+				if((*Iterator)->TimerID == ID)
+					break;
+			}
+			if(Iterator == StatusEffects.end())
+				return;
+
+			// Advance by the time since the timer was scheduled
+			_StatusEffect *StatusEffect = *Iterator;
+			if(!StatusEffect->Deleted) {
+				double Elapsed = Object->Server->Time - StatusEffect->TimerStart;
+
+				// Call status effect's update every second
+				StatusEffect->Time += Elapsed;
+				if(StatusEffect->Time >= 1.0) {
+					StatusEffect->Time -= 1.0;
+					if(IsAlive())
+						Object->ResolveBuff(StatusEffect, "Update");
+				}
+
+				// Update duration if not infinite, paused during battle
+				if(!StatusEffect->Infinite) {
+					if(!StatusEffect->Buff->PauseDuringBattle || !Battle)
+						StatusEffect->Duration -= Elapsed;
+					if(StatusEffect->Duration <= 0.0)
+						StatusEffect->Deleted = true;
+				}
+			}
+
+			// Clean up
+			if(StatusEffect->Deleted || (!IsAlive() && !StatusEffect->Buff->Summon)) {
+				delete StatusEffect;
+				StatusEffects.erase(Iterator);
+
+				CalculateStats();
+				return;
+			}
+
+			// Script may have already restarted the timer
+			if(StatusEffect->TimerID == ID)
+				ScheduleStatusEffect(StatusEffect);
+		} break;
+	}
+}
+
 // Return true if the object has the skill unlocked
 bool _Character::HasLearned(const _Item *Skill) const {
 	if(!Skill)
@@ -1001,16 +1255,35 @@ bool _Character::AddStatusEffect(_StatusEffect *StatusEffect) {
 			ExistingEffect->Level = StatusEffect->Level;
 			ExistingEffect->Time = Offset;
 			ExistingEffect->Source = StatusEffect->Source;
+			ScheduleStatusEffect(ExistingEffect);
 		}
 
 		return false;
 	}
 
 	StatusEffects.push_back(StatusEffect);
+	ScheduleStatusEffect(StatusEffect);
 
 	return true;
 }
 
+// Schedule the next update of a status effect, replacing any pending timer
+void _Character::ScheduleStatusEffect(_StatusEffect *StatusEffect) {
+	if(!Object->Server)
+		return;
+
+	// Wake at the next once-per-second update or when the effect runs out
+	double Delay = std::max(1.0 - StatusEffect->Time, 0.0);
+	if(!StatusEffect->Infinite && (!StatusEffect->Buff->PauseDuringBattle || !Battle))
+		Delay = std::min(Delay, std::max(StatusEffect->Duration, 0.0));
+	if(StatusEffect->Deleted)
+		Delay = 0.0;
+
+	StatusEffect->TimerID = ++Object->Server->TimerCount;
+	StatusEffect->TimerStart = Object->Server->Time;
+	Object->Server->TimerWheel.Schedule(Object->Server->Time, Delay, { Object->NetworkID, TIMER_STATUSEFFECT, StatusEffect->TimerID });
+}
+
 // Delete memory used by status effects
 void _Character::DeleteStatusEffects() {
 	for(auto &StatusEffect : StatusEffects)
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <vector>
 #include <list>
+#include <random>
 #include <unordered_map>
 
 // Forward Declarations
@@ -53,9 +54,9 @@ struct _SetData {
 };
 
 struct _Cooldown {
-	_Cooldown() : Duration(0), MaxDuration(0) { }
+	_Cooldown() : Deadline(0), MaxDuration(0) { }
 
-	double Duration;
+	double Deadline;
 	double MaxDuration;
 };
 
@@ -79,14 +80,23 @@ class _Character {
 			STATUS_DEAD,
 		};
 
+		enum TimerType {
+			TIMER_COOLDOWN,
+			TIMER_BOSSCOOLDOWN,
+			TIMER_REGEN,
+			TIMER_STATUSEFFECT,
+		};
+
 		_Character(_Object *Object);
 		~_Character();
 
 		// Initialize
 		void Init();
+		void Reset();
 
 		// Updates
 		void Update(double FrameTime);
+		void UpdateRegen();
 		void UpdateHealth(int &Value);
 		void UpdateMana(int Value);
 		void UpdateGold(int64_t Value);
@@ -114,9 +124,12 @@ class _Character {
 		bool CanPVP() const { return !Battle && IsAlive(); }
 
 		// Battle
-		bool IsZoneOnCooldown(uint32_t Zone) { return BossCooldowns.find(Zone) != BossCooldowns.end(); }
+		bool IsZoneOnCooldown(uint32_t Zone) { return GetBossCooldown(Zone) > 0.0; }
+		double GetBossCooldown(uint32_t Zone) const;
+		void SetBossCooldown(uint32_t Zone, double Duration);
 		void GenerateNextBattle();
 		int GenerateDamage();
+		std::mt19937 &GetRandom();
 		float GetAverageDamage() const { return (Attributes.at("MinDamage").Int + Attributes.at("MaxDamage").Int) / 2.0f; }
 		float GetDamagePowerMultiplier(int DamageTypeID);
 
@@ -127,6 +140,12 @@ class _Character {
 		void GetSummonsFromBuffs(std::vector<std::pair<_Summon, _StatusEffect *> > &Summons);
 		bool CanEquipSkill(const _Item *Skill);
 
+		// Cooldowns
+		bool IsOnCooldown(uint32_t ItemID) const { return GetCooldown(ItemID) > 0.0; }
+		double GetCooldown(uint32_t ItemID) const;
+		void SetCooldown(uint32_t ItemID, double Duration, double MaxDuration);
+		void ExpireTimer(uint32_t Type, uint32_t ID);
+
 		// Skills
 		bool HasLearned(const _Item *Skill) const;
 		int GetSkillPointsAvailable() const { return SkillPoints - SkillPointsUsed; }
@@ -139,6 +158,7 @@ class _Character {
 		bool CanTrade() const;
 		void ResetUIState(bool ResetMenuState=true);
 		bool AddStatusEffect(_StatusEffect *StatusEffect);
+		void ScheduleStatusEffect(_StatusEffect *StatusEffect);
 		void DeleteStatusEffects();
 		uint8_t GetStatus();
 		void UpdateStatusTexture();
@@ -153,6 +173,7 @@ class _Character {
 		uint32_t CharacterID;
 		uint32_t BuildID;
 		double UpdateTimer;
+		uint32_t RegenTimerID;
 
 		// Pointers
 		_Battle *Battle;
@@ -165,6 +186,7 @@ class _Character {
 
 		// State
 		std::unordered_map<uint32_t, double> BossCooldowns;
+		double BossCooldownClock;
 		std::unordered_map<uint32_t, int> BossKills;
 		std::string PartyName;
 		double IdleTime;
@@ -207,6 +229,7 @@ class _Character {
 		std::unordered_map<uint32_t, int> Skills;
 		std::unordered_map<uint32_t, int> MaxSkillLevels;
 		std::unordered_map<uint32_t, _Cooldown> Cooldowns;
+		double CooldownClock;
 		int SkillPoints;
 		int SkillPointsUnlocked;
 		int SkillPointsUsed;
@@ -224,6 +247,7 @@ class _Character {
 		const _Enchanter *Enchanter;
 		const _MinigameType *Minigame;
 		uint32_t Seed;
+		int MinigamesPending;
 
 		// Trading
 		_Object *TradePlayer;
@@ -249,6 +273,9 @@ class _Character {
 		// Bots
 		bool Bot;
 		std::list<void *> Path;
+		uint64_t PathRequestID;
+		double NextPathTime;
+		bool PathPending;
 
 	private:
 
@@ -26,3 +26,12 @@ _Controller::_Controller(_Object *Object) :
 	WaitForServer(false) {
 
 }
+
+// Restore constructed state
+void _Controller::Reset() {
+	InputStates.clear();
+	MoveTime = 0;
+	DirectionMoved = 0;
+	UseCommand = false;
+	WaitForServer = false;
+}
@@ -30,6 +30,7 @@ class _Controller {
 	public:
 
 		_Controller(_Object *Object);
+		void Reset();
 
 		// Base
 		_Object *Object;
@@ -41,6 +41,24 @@ _Fighter::_Fighter(_Object *Object) :
 	ItemDropsReceived.reserve(10);
 }
 
+// Restore constructed state, keeping container storage for reuse
+void _Fighter::Reset() {
+	BattleElement = nullptr;
+	BattleBaseOffset = glm::vec2(0.0f, 0.0f);
+	ResultPosition = glm::vec2(0.0f, 0.0f);
+	StatPosition = glm::vec2(0.0f, 0.0f);
+	PotentialAction = _Action();
+	LastTarget.clear();
+	ItemDropsReceived.clear();
+	TurnTimer = 0.0;
+	GoldStolen = 0;
+	Corpse = 1;
+	TargetIndex = 0;
+	JoinedBattle = false;
+	FleeBattle = false;
+	BattleSide = 0;
+}
+
 // Get starting side for potential action based on target type
 int _Fighter::GetStartingSide(const _Item *Item) {
 
@@ -36,6 +36,7 @@ class _Fighter {
 	public:
 
 		_Fighter(_Object *Object);
+		void Reset();
 
 		// Battle
 		int GetStartingSide(const _Item *Item);
@@ -48,6 +48,22 @@ _Inventory::_Inventory(_Object *Object) :
 	GetBag(BagType::KEYS).Name = "keys";
 }
 
+// Empty all bags, keeping slot storage for reuse
+void _Inventory::Reset() {
+	for(auto &Bag : Bags) {
+		if(!Bag.StaticSize) {
+			Bag.Slots.clear();
+			continue;
+		}
+
+		for(auto &Slot : Bag.Slots)
+			Slot.Reset();
+	}
+
+	for(auto &Slot : GetBag(BagType::EQUIPMENT).Slots)
+		Slot.MaxCount = 1;
+}
+
 // Serialize
 void _Inventory::Serialize(ae::_Buffer &Data) {
 
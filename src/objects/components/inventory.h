@@ -116,6 +116,7 @@ class _Inventory {
 	public:
 
 		_Inventory(_Object *Object);
+		void Reset();
 
 		// Network
 		void Serialize(ae::_Buffer &Data);
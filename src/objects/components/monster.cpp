@@ -31,3 +31,16 @@ _Monster::_Monster(_Object *Object) :
 	AI("") {
 
 }
+
+// Restore constructed state
+void _Monster::Reset() {
+	Owner = nullptr;
+	SummonBuff = nullptr;
+	DatabaseID = 0;
+	SpellID = 0;
+	Duration = 0.0;
+	Difficulty = 0;
+	ExperienceGiven = 0;
+	GoldGiven = 0;
+	AI.clear();
+}
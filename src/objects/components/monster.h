@@ -31,6 +31,7 @@ class _Monster {
 	public:
 
 		_Monster(_Object *Object);
+		void Reset();
 
 		// Base
 		_Object *Object;
@@ -896,7 +896,7 @@ bool _Item::CanUse(_Scripting *Scripting, _ActionResult &ActionResult) const {
 		return false;
 
 	// Check cooldown
-	if(Object->Character->Cooldowns.find(ActionResult.ActionUsed.Item->ID) != Object->Character->Cooldowns.end())
+	if(Object->Character->IsOnCooldown(ActionResult.ActionUsed.Item->ID))
 		return false;
 
 	// Unlocking skill for the first time
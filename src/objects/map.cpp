@@ -22,6 +22,7 @@
 #include <objects/components/controller.h>
 #include <objects/object.h>
 #include <objects/battle.h>
+#include <pathfinder.h>
 #include <hud/hud.h>
 #include <ae/buffer.h>
 #include <ae/texture.h>
@@ -49,13 +50,21 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <zlib/zfstream.h>
+#include <zlib.h>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <cstring>
 #include <limits>
 #include <algorithm>
 #include <stdexcept>
 #include <iomanip>
 
+// Order event positions by column, then row
+static bool CompareColumns(const glm::ivec2 &Left, const glm::ivec2 &Right) {
+	return Left.x < Right.x || (Left.x == Right.x && Left.y < Right.y);
+}
+
 // Color overlays for zones
 const glm::vec4 ZoneColors[] = {
 	{ 1.0f, 0.0f, 0.0f, 0.4f },
@@ -86,7 +95,9 @@ const std::vector<double> DayCyclesTime = {
 
 // Constructor
 _Map::_Map() :
-	Tiles(nullptr),
+	HotTiles(nullptr),
+	EventData(nullptr),
+	TileTextures{nullptr, nullptr},
 	Size(0, 0),
 	TileAtlas(nullptr),
 	AmbientLight(MAP_AMBIENT_LIGHT),
@@ -94,15 +105,18 @@ _Map::_Map() :
 	OutsideFlag(1),
 	Clock(0),
 	Headless(false),
+	Loading(false),
+	LoadFailed(false),
 	BackgroundOffset(0.0f),
 	BackgroundMap(nullptr),
 	ObjectUpdateTime(0),
+	IdleTime(0),
 	UpdateID(0),
 	Stats(nullptr),
 	Server(nullptr),
 	MaxZoneColors(sizeof(ZoneColors) / sizeof(glm::vec4)),
 	CurrentZoneColors(MaxZoneColors),
-	Pather(nullptr),
+	Pathfinder(nullptr),
 	TileVertexBufferID{0, 0},
 	TileElementBufferID(0),
 	TileVertices{nullptr, nullptr},
@@ -113,7 +127,7 @@ _Map::_Map() :
 _Map::~_Map() {
 
 	// Delete path finding
-	delete Pather;
+	delete Pathfinder;
 
 	// Delete background layer
 	delete BackgroundMap;
@@ -136,57 +150,68 @@ _Map::~_Map() {
 
 // Allocates memory for the map
 void _Map::AllocateMap() {
-	if(Tiles)
+	if(HotTiles)
 		return;
 
-	Tiles = new _Tile*[Size.x];
-	for(int i = 0; i < Size.x; i++) {
-		Tiles[i] = new _Tile[Size.y];
+	std::size_t TileCount = (std::size_t)(Size.x * Size.y);
+	HotTiles = new _HotTile[TileCount];
+	EventData = new uint32_t[TileCount]();
+
+	// Server doesn't need the texture layers
+	if(!Server) {
+		TileTextures[0] = new uint32_t[TileCount]();
+		TileTextures[1] = new uint32_t[TileCount]();
 	}
 }
 
 // Resize tile data
 void _Map::ResizeMap(glm::ivec2 Offset, glm::ivec2 NewSize) {
 
-	// Create new map
-	_Tile **NewTiles = new _Tile*[NewSize.x];
-	for(int i = 0; i < NewSize.x; i++) {
-		NewTiles[i] = new _Tile[NewSize.y];
+	// Save old tiles
+	glm::ivec2 OldSize = Size;
+	std::vector<_Tile> OldTiles;
+	OldTiles.reserve((std::size_t)(Size.x * Size.y));
+	for(int j = 0; j < Size.y; j++) {
+		for(int i = 0; i < Size.x; i++)
+			OldTiles.push_back(GetTile(glm::ivec2(i, j)));
 	}
 
+	// Save old texture atlas name
+	std::string OldTextureAtlas = "";
+	if(TileAtlas)
+		OldTextureAtlas = TileAtlas->Texture->Name;
+
+	// Delete data
+	CloseAtlas();
+	FreeMap();
+
+	// Create new map
+	Size = NewSize;
+	AllocateMap();
+
 	// Copy data
 	glm::ivec2 TileIndex;
-	for(int j = 0; j < Size.y; j++) {
+	for(int j = 0; j < OldSize.y; j++) {
 		TileIndex.y = j - Offset.y;
 		if(TileIndex.y < 0 || TileIndex.y >= NewSize.y)
 			continue;
 
-		for(int i = 0; i < Size.x; i++) {
+		for(int i = 0; i < OldSize.x; i++) {
 			TileIndex.x = i - Offset.x;
 			if(TileIndex.x < 0 || TileIndex.x >= NewSize.x)
 				continue;
 
-			NewTiles[TileIndex.x][TileIndex.y] = Tiles[i][j];
+			SetTile(TileIndex, &OldTiles[(std::size_t)(j * OldSize.x + i)]);
 		}
 	}
 
-	// Save old texture atlas name
-	std::string OldTextureAtlas = "";
-	if(TileAtlas)
-		OldTextureAtlas = TileAtlas->Texture->Name;
-
-	// Delete data
-	CloseAtlas();
-	FreeMap();
-
 	// Init new data
-	Tiles = NewTiles;
-	Size = NewSize;
 	if(OldTextureAtlas != "")
 		InitAtlas(OldTextureAtlas);
 
 	// Update index
 	IndexEvents();
+	PathGrid.reset();
 
 	// Update static objects
 	for(auto &Object : StaticObjects)
@@ -226,7 +251,7 @@ void _Map::InitAtlas(const std::string AtlasPath, bool Static) {
 			VertexIndex = 0;
 			for(int j = 0; j < Size.y; j++) {
 				for(int i = 0; i < Size.x; i++) {
-					glm::vec4 TextureCoords = TileAtlas->GetTextureCoords(Tiles[i][j].TextureIndex[k]);
+					glm::vec4 TextureCoords = TileAtlas->GetTextureCoords(TileTextures[k][j * Size.x + i]);
 					TileVertices[k][VertexIndex++] = { i + 0.0f, j + 0.0f, TextureCoords[0], TextureCoords[1] };
 					TileVertices[k][VertexIndex++] = { i + 1.0f, j + 0.0f, TextureCoords[2], TextureCoords[1] };
 					TileVertices[k][VertexIndex++] = { i + 0.0f, j + 1.0f, TextureCoords[0], TextureCoords[3] };
@@ -277,12 +302,60 @@ void _Map::CloseAtlas() {
 
 // Free memory used by the tiles
 void _Map::FreeMap() {
-	if(Tiles) {
-		for(int i = 0; i < Size.x; i++)
-			delete[] Tiles[i];
-		delete[] Tiles;
+	delete[] HotTiles;
+	delete[] EventData;
+	delete[] TileTextures[0];
+	delete[] TileTextures[1];
+
+	HotTiles = nullptr;
+	EventData = nullptr;
+	TileTextures[0] = nullptr;
+	TileTextures[1] = nullptr;
+}
+
+// Get copy of all tile data at a position
+_Tile _Map::GetTile(const glm::ivec2 &Position) const {
+	int Index = GetTileIndex(Position);
+	const _HotTile &HotTile = HotTiles[Index];
+
+	_Tile Tile;
+	Tile.Zone = HotTile.Zone;
+	Tile.Event = _Event(HotTile.EventType, EventData[Index]);
+	Tile.Wall = HotTile.IsWall();
+	Tile.PVP = HotTile.IsPVP();
+	if(TileTextures[0]) {
+		Tile.TextureIndex[0] = TileTextures[0][Index];
+		Tile.TextureIndex[1] = TileTextures[1][Index];
+	}
+
+	return Tile;
+}
+
+// Set all tile data at a position
+void _Map::SetTile(const glm::ivec2 &Position, const _Tile *Tile) {
+	if(Tile->Zone > std::numeric_limits<uint16_t>::max())
+		throw std::runtime_error("Zone out of range: " + std::to_string(Tile->Zone));
+	if(Tile->Event.Type > std::numeric_limits<uint8_t>::max())
+		throw std::runtime_error("Event type out of range: " + std::to_string(Tile->Event.Type));
+
+	int Index = GetTileIndex(Position);
+	_HotTile &HotTile = HotTiles[Index];
+
+	// Rebuild path grid when walkability changes
+	if(PathGrid) {
+		bool WasKey = HotTile.EventType == EVENT_KEY;
+		bool IsKey = Tile->Event.Type == EVENT_KEY;
+		if(HotTile.IsWall() != Tile->Wall || WasKey != IsKey || (IsKey && EventData[Index] != Tile->Event.Data))
+			PathGrid.reset();
+	}
 
-		Tiles = nullptr;
+	HotTile.Zone = (uint16_t)Tile->Zone;
+	HotTile.EventType = (uint8_t)Tile->Event.Type;
+	HotTile.Flags = (uint8_t)((Tile->Wall ? _HotTile::WALL : 0) | (Tile->PVP ? _HotTile::PVP : 0));
+	EventData[Index] = Tile->Event.Data;
+	if(TileTextures[0]) {
+		TileTextures[0][Index] = Tile->TextureIndex[0];
+		TileTextures[1][Index] = Tile->TextureIndex[1];
 	}
 }
 
@@ -295,6 +368,33 @@ void _Map::Update(double FrameTime) {
 		Clock -= MAP_DAY_LENGTH;
 }
 
+// Estimate bytes used by map data
+std::size_t _Map::GetMemoryUsage() const {
+	std::size_t Bytes = sizeof(_Map);
+
+	// Tiles
+	std::size_t TileCount = (std::size_t)(Size.x * Size.y);
+	if(HotTiles)
+		Bytes += TileCount * (sizeof(_HotTile) + sizeof(uint32_t));
+	if(TileTextures[0])
+		Bytes += TileCount * 2 * sizeof(uint32_t);
+
+	// Event index
+	for(const auto &Iterator : IndexedEvents)
+		Bytes += sizeof(Iterator) + Iterator.second.capacity() * sizeof(glm::ivec2);
+
+	// Objects
+	Bytes += StaticObjects.size() * sizeof(_Object);
+
+	// Path finding
+	if(Pathfinder)
+		Bytes += Pathfinder->GetMemoryUsage();
+	if(PathGrid)
+		Bytes += PathGrid->GetMemoryUsage();
+
+	return Bytes;
+}
+
 // Check for events
 void _Map::CheckEvents(_Object *Object) const {
 
@@ -306,18 +406,20 @@ void _Map::CheckEvents(_Object *Object) const {
 	}
 
 	// Handle events
-	const _Tile *Tile = &Tiles[Object->Position.x][Object->Position.y];
-	switch(Tile->Event.Type) {
+	int Index = GetTileIndex(Object->Position);
+	const _HotTile &Tile = HotTiles[Index];
+	_Event Event(Tile.EventType, EventData[Index]);
+	switch(Event.Type) {
 		case _Map::EVENT_SPAWN:
-			if(Server && !(Object->Character->SpawnMapID == NetworkID && Object->Character->SpawnPoint == Tile->Event.Data))
+			if(Server && !(Object->Character->SpawnMapID == NetworkID && Object->Character->SpawnPoint == Event.Data))
 				Server->SendMessage(Object->Peer, "Spawn point set", "yellow");
 
 			Object->Character->SpawnMapID = NetworkID;
-			Object->Character->SpawnPoint = Tile->Event.Data;
+			Object->Character->SpawnPoint = Event.Data;
 		break;
 		case _Map::EVENT_MAPCHANGE:
 			if(Server)
-				Server->SpawnPlayer(Object, (ae::NetworkIDType)Tile->Event.Data, _Map::EVENT_MAPENTRANCE);
+				Server->SpawnPlayer(Object, (ae::NetworkIDType)Event.Data, _Map::EVENT_MAPENTRANCE);
 			else
 				Object->Controller->WaitForServer = true;
 		break;
@@ -327,18 +429,18 @@ void _Map::CheckEvents(_Object *Object) const {
 		case _Map::EVENT_ENCHANTER:
 		case _Map::EVENT_MINIGAME:
 			if(Server)
-				StartEvent(Object, Tile->Event);
+				StartEvent(Object, Event);
 			else
 				Object->Controller->WaitForServer = true;
 		break;
 		case _Map::EVENT_SCRIPT:
-			RunEventScript(Tile, Object);
+			RunEventScript(Event, Tile.Zone, Object);
 		break;
 		case _Map::EVENT_PORTAL:
 			if(Server) {
 
 				// Find matching even/odd event
-				FindEvent(_Event(Tile->Event.Type, Tile->Event.Data ^ 1), Object->Position);
+				FindEvent(_Event(Event.Type, Event.Data ^ 1), Object->Position);
 				Server->SendPlayerPosition(Object->Peer);
 			}
 			else
@@ -348,7 +450,7 @@ void _Map::CheckEvents(_Object *Object) const {
 			if(Server) {
 
 				// Find next jump
-				FindEvent(_Event(Tile->Event.Type, Tile->Event.Data + 1), Object->Position);
+				FindEvent(_Event(Event.Type, Event.Data + 1), Object->Position);
 				Server->SendPlayerPosition(Object->Peer);
 			}
 			else
@@ -358,7 +460,7 @@ void _Map::CheckEvents(_Object *Object) const {
 			if(Server) {
 				Object->Character->Vendor = nullptr;
 				Object->Character->Trader = nullptr;
-				CheckBattle(Object, Tile);
+				CheckBattle(Object, Tile.Zone);
 			}
 		break;
 	}
@@ -370,19 +472,19 @@ void _Map::CheckEvents(_Object *Object) const {
 }
 
 // Check for next battle
-void _Map::CheckBattle(_Object *Object, const _Tile *Tile) const {
+void _Map::CheckBattle(_Object *Object, uint32_t Zone) const {
 	if(!Server)
 		return;
 
 	if(Object->Character->IsAlive() && Object->Character->NextBattle <= 0)
-		Server->QueueBattle(Object, Tile->Zone, false, false, 0.0f, 0.0f);
+		Server->QueueBattle(Object, Zone, false, false, 0.0f, 0.0f);
 }
 
 // Run event script
-void _Map::RunEventScript(const _Tile *Tile, _Object *Object) const {
+void _Map::RunEventScript(const _Event &Event, uint32_t Zone, _Object *Object) const {
 
 	// Find script
-	auto Iterator = Stats->Scripts.find(Tile->Event.Data);
+	auto Iterator = Stats->Scripts.find(Event.Data);
 	if(Iterator == Stats->Scripts.end())
 		return;
 
@@ -407,10 +509,10 @@ void _Map::RunEventScript(const _Tile *Tile, _Object *Object) const {
 				ae::_Buffer Packet;
 				Packet.Write<PacketType>(PacketType::STAT_CHANGE);
 				StatChange.Serialize(Packet);
-				Server->Network->SendPacket(Packet, Object->Peer);
+				Server->SendPacket(Packet, Object->Peer);
 			}
 
-			CheckBattle(Object, Tile);
+			CheckBattle(Object, Zone);
 		}
 		else {
 
@@ -433,14 +535,18 @@ void _Map::IndexEvents() {
 	IndexedEvents.clear();
 
 	// Build event index
+	int Index = 0;
 	for(int j = 0; j < Size.y; j++) {
-		for(int i = 0; i < Size.x; i++) {
-			const _Tile &Tile = Tiles[i][j];
-			if(Tile.Event.Type != EVENT_NONE) {
-				IndexedEvents[Tile.Event].push_back(glm::ivec2(i, j));
+		for(int i = 0; i < Size.x; i++, Index++) {
+			if(HotTiles[Index].EventType != EVENT_NONE) {
+				IndexedEvents[_Event(HotTiles[Index].EventType, EventData[Index])].push_back(glm::ivec2(i, j));
 			}
 		}
 	}
+
+	// Sort positions by column for nearest queries
+	for(auto &Iterator : IndexedEvents)
+		std::sort(Iterator.second.begin(), Iterator.second.end(), CompareColumns);
 }
 
 // Convert clock time to text
@@ -555,7 +661,7 @@ void _Map::StartEvent(_Object *Object, _Event Event) const {
 		Packet.Write<uint32_t>(Event.Type);
 		Packet.Write<uint32_t>(Event.Data);
 		Packet.Write<glm::ivec2>(Object->Position);
-		Server->Network->SendPacket(Packet, Object->Peer);
+		Server->SendPacket(Packet, Object->Peer);
 	}
 
 	// Generate seed
@@ -569,7 +675,7 @@ bool _Map::IsPVPZone(const glm::ivec2 &Position) const {
 	if(!IsValidPosition(Position))
 		return false;
 
-	return GetTile(Position)->PVP;
+	return GetHotTile(Position).IsPVP();
 }
 
 // Renders the map
@@ -684,11 +790,11 @@ void _Map::Render(ae::_Camera *Camera, ae::_Framebuffer *Framebuffer, _Object *C
 		ae::Graphics.SetProgram(ae::Assets.Programs["pos"]);
 		for(int j = (int)Bounds[1]; j < Bounds[3]; j++) {
 			for(int i = (int)Bounds[0]; i < Bounds[2]; i++) {
-				_Tile *Tile = &Tiles[i][j];
+				const _HotTile &Tile = HotTiles[j * Size.x + i];
 
 				// Draw zone color
-				if(!Tile->Wall && Tile->Zone > 0) {
-					ae::Graphics.SetColor(ZoneColors[Tile->Zone % CurrentZoneColors]);
+				if(!Tile.IsWall() && Tile.Zone > 0) {
+					ae::Graphics.SetColor(ZoneColors[Tile.Zone % CurrentZoneColors]);
 					ae::Graphics.DrawRectangle(glm::vec2(i, j), glm::vec2(i+1, j+1), true);
 				}
 			}
@@ -701,28 +807,29 @@ void _Map::Render(ae::_Camera *Camera, ae::_Framebuffer *Framebuffer, _Object *C
 	// Draw text overlay
 	for(int j = (int)Bounds[1]; j < Bounds[3]; j++) {
 		for(int i = (int)Bounds[0]; i < Bounds[2]; i++) {
-			_Tile *Tile = &Tiles[i][j];
+			int Index = j * Size.x + i;
+			const _HotTile &Tile = HotTiles[Index];
 			glm::vec3 DrawPosition = glm::vec3(i, j, 0) + glm::vec3(0.5f, 0.5f, 0);
 
 			// Draw wall
-			if(Tile->Wall) {
+			if(Tile.IsWall()) {
 				if(RenderFlags & MAP_RENDER_WALL)
 					ae::Assets.Fonts["hud_medium"]->DrawText("W", glm::vec2(DrawPosition), ae::CENTER_MIDDLE, glm::vec4(1.0f), 1.0f / (UI_TILE_SIZE.x * ae::_Element::GetUIScale()));
 			}
 			else {
 
 				// Draw zone number
-				if((RenderFlags & MAP_RENDER_ZONE) && Tile->Zone > 0)
-					ae::Assets.Fonts["hud_medium"]->DrawText(std::to_string(Tile->Zone), glm::vec2(DrawPosition), ae::CENTER_MIDDLE, glm::vec4(1.0f), 1.0f / (UI_TILE_SIZE.x * ae::_Element::GetUIScale()));
+				if((RenderFlags & MAP_RENDER_ZONE) && Tile.Zone > 0)
+					ae::Assets.Fonts["hud_medium"]->DrawText(std::to_string(Tile.Zone), glm::vec2(DrawPosition), ae::CENTER_MIDDLE, glm::vec4(1.0f), 1.0f / (UI_TILE_SIZE.x * ae::_Element::GetUIScale()));
 
 				// Draw PVP
-				if((RenderFlags & MAP_RENDER_PVP) && Tile->PVP)
+				if((RenderFlags & MAP_RENDER_PVP) && Tile.IsPVP())
 					ae::Assets.Fonts["hud_medium"]->DrawText("PVP", glm::vec2(DrawPosition) - glm::vec2(0, 0.25), ae::CENTER_MIDDLE, ae::Assets.Colors["red"], 1.0f / (UI_TILE_SIZE.x * ae::_Element::GetUIScale()));
 			}
 
 			// Draw event info
-			if(Tile->Event.Type > 0) {
-				std::string EventText = Stats->EventNames[Tile->Event.Type].ShortName + std::string(" ") + std::to_string(Tile->Event.Data);
+			if(Tile.EventType > 0) {
+				std::string EventText = Stats->EventNames[Tile.EventType].ShortName + std::string(" ") + std::to_string(EventData[Index]);
 				ae::Assets.Fonts["hud_medium"]->DrawText(EventText, glm::vec2(DrawPosition) - glm::vec2(0, -0.25), ae::CENTER_MIDDLE, ae::Assets.Colors["cyan"], 1.0f / (UI_TILE_SIZE.x * ae::_Element::GetUIScale()));
 			}
 		}
@@ -742,7 +849,7 @@ void _Map::RenderLayer(const std::string &Program, glm::vec4 &Bounds, const glm:
 	if(!Static) {
 		for(int j = (int)Bounds[1]; j < Bounds[3]; j++) {
 			for(int i = (int)Bounds[0]; i < Bounds[2]; i++) {
-				glm::vec4 TextureCoords = TileAtlas->GetTextureCoords(Tiles[i][j].TextureIndex[Layer]);
+				glm::vec4 TextureCoords = TileAtlas->GetTextureCoords(TileTextures[Layer][j * Size.x + i]);
 				TileVertices[0][VertexIndex++] = { i + 0.0f, j + 0.0f, TextureCoords[0], TextureCoords[1] };
 				TileVertices[0][VertexIndex++] = { i + 1.0f, j + 0.0f, TextureCoords[2], TextureCoords[1] };
 				TileVertices[0][VertexIndex++] = { i + 0.0f, j + 1.0f, TextureCoords[0], TextureCoords[3] };
@@ -778,7 +885,7 @@ void _Map::RenderLayer(const std::string &Program, glm::vec4 &Bounds, const glm:
 }
 
 // Add lights from objects
-int _Map::AddLights(_Object *ClientPlayer, const std::list<_Object *> *ObjectList, const ae::_Program *Program, glm::vec4 AABB) {
+int _Map::AddLights(_Object *ClientPlayer, const std::vector<_Object *> *ObjectList, const ae::_Program *Program, glm::vec4 AABB) {
 	ae::Graphics.SetProgram(Program);
 	glUniformMatrix4fv(Program->TextureTransformID, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
 
@@ -835,11 +942,6 @@ int _Map::AddLights(_Object *ClientPlayer, const std::list<_Object *> *ObjectLis
 // Load map
 void _Map::Load(const _MapStat *MapStat, bool Static) {
 
-	// Load file
-	gzifstream File(MapStat->File.c_str());
-	if(!File)
-		throw std::runtime_error("Cannot load map: " + MapStat->File);
-
 	// Save map stats
 	if(Server)
 		Headless = true;
@@ -865,10 +967,67 @@ void _Map::Load(const _MapStat *MapStat, bool Static) {
 	}
 
 	// Load tiles
-	_Tile *Tile = nullptr;
-	_Object *Object = nullptr;
+	LoadTiles(MapStat->File);
+
+	// Index events
+	IndexEvents();
+
+	// Initialize 2d tile rendering
+	if(!Headless)
+		InitAtlas(MapStat->Atlas, Static);
+
+	// Initialize path finding
+	Pathfinder = new _Pathfinder();
+	PathGrid = std::make_shared<const _PathGrid>(this);
+}
+
+// Use binary map if it is up to date, otherwise fall back to text
+void _Map::LoadTiles(const std::string &Path) {
+	std::string BinaryPath = GetBinaryPath(Path);
+	std::error_code Error;
+	auto BinaryTime = std::filesystem::last_write_time(BinaryPath, Error);
+	bool UseBinary = !Error;
+	if(UseBinary) {
+		auto TextTime = std::filesystem::last_write_time(Path, Error);
+		UseBinary = Error || BinaryTime >= TextTime;
+	}
+	if(UseBinary) {
+		std::size_t StaticCount = StaticObjects.size();
+		if(LoadBinary(BinaryPath))
+			return;
+
+		// Discard partial load
+		for(std::size_t i = StaticCount; i < StaticObjects.size(); i++)
+			delete StaticObjects[i];
+		StaticObjects.resize(StaticCount);
+		FreeMap();
+	}
+
+	LoadText(Path);
+}
+
+// Load tiles and objects from text map
+void _Map::LoadText(const std::string &Path) {
+
+	// Load file
+	gzifstream File(Path.c_str());
+	if(!File)
+		throw std::runtime_error("Cannot load map: " + Path);
+
+	// Store the tile being read
+	_Tile Tile;
 	glm::ivec2 TileCoordinate;
-	int TileIndex = 0;
+	int TileIndex = -1;
+	auto FinishTile = [&]() {
+		if(TileIndex >= 0 && TileIndex < Size.x * Size.y) {
+			SetTile(TileCoordinate, &Tile);
+			CreateEventObject(Tile.Event, TileCoordinate);
+		}
+		Tile = _Tile();
+	};
+
+	// Load tiles
+	_Object *Object = nullptr;
 	while(!File.eof() && File.peek() != EOF) {
 
 		// Read chunk type
@@ -891,60 +1050,42 @@ void _Map::Load(const _MapStat *MapStat, bool Static) {
 			} break;
 			// Tile
 			case 'T': {
+				FinishTile();
+				TileIndex++;
 				TileCoordinate.x = TileIndex % Size.x;
 				TileCoordinate.y = TileIndex / Size.x;
-				Tile = &Tiles[TileCoordinate.x][TileCoordinate.y];
-				TileIndex++;
 			} break;
 			// Texture index
 			case 'b': {
-				if(Tile)
-					File >> Tile->TextureIndex[0];
+				File >> Tile.TextureIndex[0];
 			} break;
 			// Foreground texture index
 			case 'f': {
-				if(Tile)
-					File >> Tile->TextureIndex[1];
+				File >> Tile.TextureIndex[1];
 			} break;
 			// Zone
 			case 'z': {
-				if(Tile)
-					File >> Tile->Zone;
+				File >> Tile.Zone;
 			} break;
 			// Event
 			case 'e': {
-				if(Tile) {
-					File >> Tile->Event.Type >> Tile->Event.Data;
-
-					// Create static objects for boss events
-					if(!Headless && Stats && Tile->Event.Type == EVENT_SCRIPT) {
-						const _Script &Script = Stats->Scripts.at(Tile->Event.Data);
-						if(Script.Name == "Script_Boss") {
-							_Object *BossObject = new _Object();
-							BossObject->Position = TileCoordinate;
-							BossObject->BossZoneID = Script.Level;
-							if(!Script.Data.empty())
-								BossObject->ModelTexture = ae::Assets.Textures.at(Script.Data);
-							StaticObjects.push_back(BossObject);
-						}
-					}
-				}
+				File >> Tile.Event.Type >> Tile.Event.Data;
 			} break;
 			// Wall
 			case 'w': {
-				if(Tile)
-					File >> Tile->Wall;
+				File >> Tile.Wall;
 			} break;
 			// PVP
 			case 'p': {
-				if(Tile)
-					File >> Tile->PVP;
+				File >> Tile.PVP;
 			} break;
 			// Object
 			case 'O': {
+				FinishTile();
+				TileIndex = -1;
 				glm::ivec2 Coordinate;
 				File >> Coordinate.x >> Coordinate.y;
-				if(!Headless) {
+				if(!Server) {
 					Object = new _Object();
 					Object->Position = Coordinate;
 					StaticObjects.push_back(Object);
@@ -963,17 +1104,128 @@ void _Map::Load(const _MapStat *MapStat, bool Static) {
 		}
 	}
 
+	FinishTile();
 	File.close();
+}
 
-	// Index events
-	IndexEvents();
+// Load tiles and objects from binary map, return false if the file can't be used
+bool _Map::LoadBinary(const std::string &Path) {
 
-	// Initialize 2d tile rendering
-	if(!Headless)
-		InitAtlas(MapStat->Atlas, Static);
+	// Read whole file in one pass, gzread passes uncompressed files through
+	gzFile File = gzopen(Path.c_str(), "rb");
+	if(!File)
+		return false;
 
-	// Initialize path finding
-	Pather = new micropather::MicroPather(this, (unsigned)(Size.x * Size.y), 4);
+	std::vector<char> Data;
+	char Chunk[65536];
+	int BytesRead;
+	while((BytesRead = gzread(File, Chunk, sizeof(Chunk))) > 0)
+		Data.insert(Data.end(), Chunk, Chunk + BytesRead);
+	gzclose(File);
+	if(BytesRead < 0)
+		return false;
+
+	// Copy values out of the buffer, return false when truncated
+	std::size_t Offset = 0;
+	auto Read = [&Data, &Offset](void *Value, std::size_t Size) {
+		if(Size > Data.size() - Offset)
+			return false;
+		std::memcpy(Value, &Data[Offset], Size);
+		Offset += Size;
+		return true;
+	};
+
+	// Check header
+	uint32_t Header[4] = { 0, 0, 0, 0 };
+	if(!Read(Header, sizeof(Header)))
+		return false;
+	if(Header[0] != MAP_BINARY_MAGIC || Header[1] != MAP_BINARY_VERSION)
+		return false;
+
+	// Check that the tile arrays fit in the file before allocating
+	const std::size_t TILE_BYTES = 3 * sizeof(uint32_t) + 2;
+	if(Header[2] == 0 || Header[3] == 0 || (uint64_t)Header[2] * Header[3] > (Data.size() - Offset) / TILE_BYTES)
+		return false;
+
+	// Allocate map
+	Size.x = (int)Header[2];
+	Size.y = (int)Header[3];
+	FreeMap();
+	AllocateMap();
+
+	// Read tile arrays, stored row by row
+	std::size_t TileCount = (std::size_t)Size.x * (std::size_t)Size.y;
+	std::vector<uint32_t> Values(TileCount);
+	std::vector<uint8_t> Flags(TileCount);
+	for(int k = 0; k < 2; k++)
+		Read(TileTextures[k] ? TileTextures[k] : Values.data(), TileCount * sizeof(uint32_t));
+
+	Read(Values.data(), TileCount * sizeof(uint32_t));
+	for(std::size_t i = 0; i < TileCount; i++) {
+		if(Values[i] > std::numeric_limits<uint16_t>::max())
+			return false;
+		HotTiles[i].Zone = (uint16_t)Values[i];
+	}
+
+	Read(Flags.data(), TileCount);
+	for(std::size_t i = 0; i < TileCount; i++)
+		HotTiles[i].Flags = Flags[i] ? _HotTile::WALL : 0;
+	Read(Flags.data(), TileCount);
+	for(std::size_t i = 0; i < TileCount; i++)
+		HotTiles[i].Flags |= Flags[i] ? _HotTile::PVP : 0;
+
+	// Read event table
+	uint32_t EventCount;
+	if(!Read(&EventCount, sizeof(EventCount)))
+		return false;
+	for(uint32_t i = 0; i < EventCount; i++) {
+		uint32_t Event[3];
+		if(!Read(Event, sizeof(Event)))
+			return false;
+		if(Event[0] >= TileCount || Event[1] > std::numeric_limits<uint8_t>::max())
+			return false;
+		if(Event[1] == EVENT_SCRIPT && Stats && Stats->Scripts.find(Event[2]) == Stats->Scripts.end())
+			return false;
+
+		HotTiles[Event[0]].EventType = (uint8_t)Event[1];
+		EventData[Event[0]] = Event[2];
+		CreateEventObject(_Event(Event[1], Event[2]), glm::ivec2((int)Event[0] % Size.x, (int)Event[0] / Size.x));
+	}
+
+	// Read static objects
+	uint32_t ObjectCount;
+	if(!Read(&ObjectCount, sizeof(ObjectCount)))
+		return false;
+	for(uint32_t i = 0; i < ObjectCount; i++) {
+		int32_t ObjectData[3];
+		if(!Read(ObjectData, sizeof(ObjectData)))
+			return false;
+		if(Server)
+			continue;
+
+		_Object *Object = new _Object();
+		Object->Position = glm::ivec2(ObjectData[0], ObjectData[1]);
+		Object->Light = ObjectData[2];
+		StaticObjects.push_back(Object);
+	}
+
+	return true;
+}
+
+// Create static objects for boss events
+void _Map::CreateEventObject(const _Event &Event, const glm::ivec2 &Position) {
+	if(Headless || !Stats || Event.Type != EVENT_SCRIPT)
+		return;
+
+	const _Script &Script = Stats->Scripts.at(Event.Data);
+	if(Script.Name == "Script_Boss") {
+		_Object *BossObject = new _Object();
+		BossObject->Position = Position;
+		BossObject->BossZoneID = Script.Level;
+		if(!Script.Data.empty())
+			BossObject->ModelTexture = ae::Assets.Textures.at(Script.Data);
+		StaticObjects.push_back(BossObject);
+	}
 }
 
 // Saves the level to a file
@@ -993,7 +1245,7 @@ bool _Map::Save(const std::string &Path) {
 	// Write tile map
 	for(int j = 0; j < Size.y; j++) {
 		for(int i = 0; i < Size.x; i++) {
-			const _Tile &Tile = Tiles[i][j];
+			_Tile Tile = GetTile(glm::ivec2(i, j));
 			Output << "T" << '\n';
 			if(Tile.TextureIndex[0])
 				Output << "b " << Tile.TextureIndex[0] << '\n';
@@ -1002,7 +1254,7 @@ bool _Map::Save(const std::string &Path) {
 			if(Tile.Zone)
 				Output << "z " << Tile.Zone << '\n';
 			if(Tile.Event.Type)
-				Output << "e " << Tile.Event.Type << " " << Tiles[i][j].Event.Data << '\n';
+				Output << "e " << Tile.Event.Type << " " << Tile.Event.Data << '\n';
 			if(Tile.Wall)
 				Output << "w " << Tile.Wall << '\n';
 			if(Tile.PVP)
@@ -1021,6 +1273,83 @@ bool _Map::Save(const std::string &Path) {
 	return true;
 }
 
+// Save the level in binary format
+bool _Map::SaveBinary(const std::string &Path) {
+	if(Path == "")
+		return false;
+
+	// Build arrays that aren't stored directly
+	std::size_t TileCount = (std::size_t)(Size.x * Size.y);
+	std::vector<uint32_t> Zones(TileCount);
+	std::vector<uint8_t> Walls(TileCount);
+	std::vector<uint8_t> PVPs(TileCount);
+	std::vector<uint32_t> Events;
+	for(std::size_t i = 0; i < TileCount; i++) {
+		const _HotTile &Tile = HotTiles[i];
+		Zones[i] = Tile.Zone;
+		Walls[i] = Tile.IsWall();
+		PVPs[i] = Tile.IsPVP();
+		if(Tile.EventType)
+			Events.insert(Events.end(), { (uint32_t)i, Tile.EventType, EventData[i] });
+	}
+
+	// Texture layers aren't loaded on the server
+	std::vector<uint32_t> EmptyTextures;
+	if(!TileTextures[0])
+		EmptyTextures.resize(TileCount);
+
+	// Skip boss objects created from events
+	std::vector<int32_t> Objects;
+	for(auto &Object : StaticObjects) {
+		if(!Object->BossZoneID)
+			Objects.insert(Objects.end(), { Object->Position.x, Object->Position.y, Object->Light });
+	}
+
+	// Open uncompressed file
+	gzFile File = gzopen(Path.c_str(), "wbT");
+	if(!File)
+		throw std::runtime_error("Cannot create file: " + Path);
+
+	auto Write = [&File](const void *Data, std::size_t Size) {
+		if(Size)
+			gzwrite(File, Data, (unsigned)Size);
+	};
+
+	// Header
+	uint32_t Header[4] = { MAP_BINARY_MAGIC, MAP_BINARY_VERSION, (uint32_t)Size.x, (uint32_t)Size.y };
+	Write(Header, sizeof(Header));
+
+	// Tile arrays
+	for(int k = 0; k < 2; k++)
+		Write(TileTextures[k] ? TileTextures[k] : EmptyTextures.data(), TileCount * sizeof(uint32_t));
+	Write(Zones.data(), TileCount * sizeof(uint32_t));
+	Write(Walls.data(), TileCount);
+	Write(PVPs.data(), TileCount);
+
+	// Event table
+	uint32_t EventCount = (uint32_t)(Events.size() / 3);
+	Write(&EventCount, sizeof(EventCount));
+	Write(Events.data(), Events.size() * sizeof(uint32_t));
+
+	// Static objects
+	uint32_t ObjectCount = (uint32_t)(Objects.size() / 3);
+	Write(&ObjectCount, sizeof(ObjectCount));
+	Write(Objects.data(), Objects.size() * sizeof(int32_t));
+
+	gzclose(File);
+
+	return true;
+}
+
+// Get binary map path from text map path
+std::string _Map::GetBinaryPath(const std::string &Path) {
+	std::string Extension = ".gz";
+	if(Path.size() > Extension.size() && Path.compare(Path.size() - Extension.size(), Extension.size(), Extension) == 0)
+		return Path.substr(0, Path.size() - Extension.size()) + ".bin";
+
+	return Path + ".bin";
+}
+
 // Determines if a square can be moved to
 bool _Map::CanMoveTo(const glm::ivec2 &Position, _Object *Object) {
 
@@ -1029,19 +1358,21 @@ bool _Map::CanMoveTo(const glm::ivec2 &Position, _Object *Object) {
 		return false;
 
 	// Check events
-	const _Tile *Tile = &Tiles[Position.x][Position.y];
-	if(Tile->Event.Type == _Map::EVENT_KEY) {
+	int Index = GetTileIndex(Position);
+	const _HotTile &Tile = HotTiles[Index];
+	if(Tile.EventType == _Map::EVENT_KEY) {
+		uint32_t KeyID = EventData[Index];
 
 		// Search for item in key chain
-		if(Object->Inventory->GetBag(BagType::KEYS).HasItemID(Tile->Event.Data) != NOSLOT)
+		if(Object->Inventory->GetBag(BagType::KEYS).HasItemID(KeyID) != NOSLOT)
 			return true;
 
 		// Search for item in equipment
-		if(Object->Inventory->GetBag(BagType::EQUIPMENT).HasItemID(Tile->Event.Data) != NOSLOT)
+		if(Object->Inventory->GetBag(BagType::EQUIPMENT).HasItemID(KeyID) != NOSLOT)
 			return true;
 
 		// Automatically add key to keychain on use if found in inventory bag
-		std::size_t FoundIndex = Object->Inventory->GetBag(BagType::INVENTORY).HasItemID(Tile->Event.Data);
+		std::size_t FoundIndex = Object->Inventory->GetBag(BagType::INVENTORY).HasItemID(KeyID);
 		if(FoundIndex != NOSLOT) {
 
 			// Check for client
@@ -1049,7 +1380,7 @@ bool _Map::CanMoveTo(const glm::ivec2 &Position, _Object *Object) {
 
 				// Only add keys
 				try {
-					const _Item *Item = Stats->Items.at(Tile->Event.Data);
+					const _Item *Item = Stats->Items.at(KeyID);
 					if(Item->Type == ItemType::KEY) {
 
 						// Send use command
@@ -1074,7 +1405,7 @@ bool _Map::CanMoveTo(const glm::ivec2 &Position, _Object *Object) {
 
 		// Set message for client
 		if(!Server) {
-			const _Item *Item = Object->Stats->Items.at(Tile->Event.Data);
+			const _Item *Item = Object->Stats->Items.at(KeyID);
 			if(Item && Object->Character->HUD && Item->Name.size())
 				Object->Character->HUD->SetMessage("You need the " + Item->Name);
 		}
@@ -1082,7 +1413,7 @@ bool _Map::CanMoveTo(const glm::ivec2 &Position, _Object *Object) {
 		return false;
 	}
 
-	return !Tile->Wall;
+	return !Tile.IsWall();
 }
 
 // Removes an object from the map
@@ -1100,10 +1431,14 @@ void _Map::RemoveObject(const _Object *RemoveObject) {
 		BroadcastPacket(Packet);
 	}
 
-	// Remove object
-	auto Iterator = std::find(Objects.begin(), Objects.end(), RemoveObject);
-	if(Iterator != Objects.end())
-		Objects.erase(Iterator);
+	// Swap last object into the removed slot
+	std::size_t Slot = RemoveObject->MapSlot;
+	if(Slot >= Objects.size() || Objects[Slot] != RemoveObject)
+		return;
+
+	Objects[Slot] = Objects.back();
+	Objects[Slot]->MapSlot = Slot;
+	Objects.pop_back();
 }
 
 // Adds an object to the map
@@ -1120,11 +1455,12 @@ void _Map::AddObject(_Object *Object) {
 	}
 
 	// Add object to map
+	Object->MapSlot = Objects.size();
 	Objects.push_back(Object);
 }
 
 // Returns a list of players close to a player that can battle
-void _Map::GetPotentialBattlePlayers(const _Object *Player, float DistanceSquared, std::size_t Max, std::vector<_Object *> &Players) {
+void _Map::GetPotentialBattlePlayers(const _Object *Player, float DistanceSquared, std::size_t Max, _ScratchVector<_Object *> &Players) {
 	if(Player && Player->Character->Offline)
 		return;
 
@@ -1197,7 +1533,7 @@ _Battle *_Map::GetCloseBattle(const _Object *Player, bool &HitPrivateParty, bool
 }
 
 // Returns target players appropriate for pvp
-void _Map::GetPVPPlayers(const _Object *Attacker, std::vector<_Object *> &Players, bool UsePVPZone) {
+void _Map::GetPVPPlayers(const _Object *Attacker, _ScratchVector<_Object *> &Players, bool UsePVPZone) {
 	if(Attacker && Attacker->Character->Offline)
 		return;
 
@@ -1308,16 +1644,38 @@ bool _Map::FindEvent(const _Event &Event, glm::ivec2 &Position) const {
 	if(Iterator == IndexedEvents.end())
 		return false;
 
-	// Return closest position
+	// Sweep outward from the start column until no closer column remains
+	const std::vector<glm::ivec2> &Positions = Iterator->second;
 	glm::ivec2 StartPosition = Position;
-	float ClosestDistanceSquared = HUGE_VAL;
-	for(const auto &CheckPosition : Iterator->second) {
-		glm::vec2 Delta = StartPosition - CheckPosition;
-		float DistanceSquared = glm::dot(Delta, Delta);
-		if(DistanceSquared < ClosestDistanceSquared) {
+	std::size_t Right = (std::size_t)(std::lower_bound(Positions.begin(), Positions.end(), StartPosition, CompareColumns) - Positions.begin());
+	std::size_t Left = Right;
+	int ClosestDistanceSquared = std::numeric_limits<int>::max();
+	auto Check = [&](const glm::ivec2 &CheckPosition) {
+		glm::ivec2 Delta = StartPosition - CheckPosition;
+		int DistanceSquared = Delta.x * Delta.x + Delta.y * Delta.y;
+
+		// Break ties in row order
+		if(DistanceSquared < ClosestDistanceSquared || (DistanceSquared == ClosestDistanceSquared && (CheckPosition.y < Position.y || (CheckPosition.y == Position.y && CheckPosition.x < Position.x)))) {
 			ClosestDistanceSquared = DistanceSquared;
 			Position = CheckPosition;
 		}
+	};
+
+	while(Left > 0 || Right < Positions.size()) {
+		if(Right < Positions.size()) {
+			int DeltaX = Positions[Right].x - StartPosition.x;
+			if(DeltaX * DeltaX > ClosestDistanceSquared)
+				Right = Positions.size();
+			else
+				Check(Positions[Right++]);
+		}
+		if(Left > 0) {
+			int DeltaX = StartPosition.x - Positions[Left - 1].x;
+			if(DeltaX * DeltaX > ClosestDistanceSquared)
+				Left = 0;
+			else
+				Check(Positions[--Left]);
+		}
 	}
 
 	return true;
@@ -1358,7 +1716,7 @@ void _Map::SendObjectList(ae::_Peer *Peer) {
 		Object->SerializeCreate(Packet);
 	}
 
-	Server->Network->SendPacket(Packet, Peer);
+	Server->SendPacket(Packet, Peer);
 }
 
 // Sends object position information to all the clients in the map
@@ -1394,7 +1752,7 @@ void _Map::SendObjectUpdates() {
 	// Send packet to players in map
 	for(auto &Object : Objects) {
 		if(!Object->Deleted && Object->Peer && Object->Peer->ENetPeer && Object->UpdateID != UpdateID) {
-			Server->Network->SendPacket(Packet, Object->Peer, ae::_Network::UNSEQUENCED, 1);
+			Server->SendPacket(Packet, Object->Peer, ae::_Network::UNSEQUENCED, 1);
 		}
 	}
 }
@@ -1407,7 +1765,7 @@ void _Map::BroadcastPacket(ae::_Buffer &Buffer, ae::_Network::SendType Type) {
 	// Send packet to peers
 	for(auto &Object : Objects) {
 		if(!Object->Deleted && Object->Peer && Object->Peer->ENetPeer)
-			Server->Network->SendPacket(Buffer, Object->Peer, Type, Type == ae::_Network::UNSEQUENCED);
+			Server->SendPacket(Buffer, Object->Peer, Type, Type == ae::_Network::UNSEQUENCED);
 	}
 }
 
@@ -1421,13 +1779,21 @@ glm::ivec2 _Map::GetValidCoord(const glm::ivec2 &Position) const {
 	return glm::clamp(Position, glm::ivec2(0), Size - 1);
 }
 
+// Get walkability snapshot, rebuilding it after edits
+std::shared_ptr<const _PathGrid> _Map::GetPathGrid() {
+	if(!PathGrid)
+		PathGrid = std::make_shared<const _PathGrid>(this);
+
+	return PathGrid;
+}
+
 // Distance between two points
 float _Map::LeastCostEstimate(void *StateStart, void *StateEnd) {
 	glm::ivec2 StartPosition;
 	NodeToPosition(StateStart, StartPosition);
 
 	glm::ivec2 EndPosition;
-	NodeToPosition(StateStart, EndPosition);
+	NodeToPosition(StateEnd, EndPosition);
 
 	return std::abs(StartPosition.x - EndPosition.x) + std::abs(StartPosition.y - EndPosition.y);
 }
@@ -1440,7 +1806,11 @@ void _Map::AdjacentCost(void *State, std::vector<micropather::StateCost> *Neighb
 	glm::ivec2 Directions[4] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
 	for(int i = 0; i < 4; i++) {
 		glm::ivec2 NewPosition = Position + Directions[i];
-		float Cost = Tiles[NewPosition.x][NewPosition.y].Wall ? FLT_MAX : 1.0f;
+		if(!IsValidPosition(NewPosition))
+			continue;
+
+		const _HotTile &Tile = HotTiles[GetTileIndex(NewPosition)];
+		float Cost = Tile.IsWall() || Tile.EventType == EVENT_KEY ? FLT_MAX : 1.0f;
 		micropather::StateCost NodeCost = { PositionToNode(NewPosition), Cost };
 		Neighbors->push_back(NodeCost);
 	}
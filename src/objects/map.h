@@ -21,6 +21,7 @@
 #include <ae/baseobject.h>
 #include <ae/network.h>
 #include <ae/texture.h>
+#include <arena.h>
 #include <path/micropather.h>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
@@ -32,6 +33,7 @@
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <memory>
 #include <sstream>
 
 // Forward Declarations
@@ -40,6 +42,8 @@ class _Server;
 class _Stats;
 class _Battle;
 class _Scripting;
+class _Pathfinder;
+class _PathGrid;
 struct _MapStat;
 
 namespace ae {
@@ -63,6 +67,10 @@ struct _Event {
 	uint32_t Data;
 };
 
+struct _EventHash {
+	std::size_t operator()(const _Event &Event) const { return std::hash<uint64_t>()((uint64_t)Event.Type << 32 | Event.Data); }
+};
+
 struct _Tile {
 	_Tile() : TextureIndex{0, 0}, Zone(0), Wall(false), PVP(false) { }
 	uint32_t TextureIndex[2];
@@ -72,6 +80,22 @@ struct _Tile {
 	bool PVP;
 };
 
+// Tile data read by movement, events and path finding
+struct _HotTile {
+	enum FlagType : uint8_t {
+		WALL = 1,
+		PVP = 2,
+	};
+
+	_HotTile() : Zone(0), EventType(0), Flags(0) { }
+	bool IsWall() const { return Flags & WALL; }
+	bool IsPVP() const { return Flags & PVP; }
+
+	uint16_t Zone;
+	uint8_t EventType;
+	uint8_t Flags;
+};
+
 // Classes
 class _Map : public ae::_BaseObject, public micropather::Graph {
 
@@ -103,11 +127,12 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		void CloseAtlas();
 
 		void Update(double FrameTime) override;
+		std::size_t GetMemoryUsage() const;
 
 		// Events
 		void CheckEvents(_Object *Object) const;
-		void CheckBattle(_Object *Object, const _Tile *Tile) const;
-		void RunEventScript(const _Tile *Tile, _Object *Object) const;
+		void CheckBattle(_Object *Object, uint32_t Zone) const;
+		void RunEventScript(const _Event &Event, uint32_t Zone, _Object *Object) const;
 		void IndexEvents();
 		void GetClockAsString(std::stringstream &Buffer, bool Clock24Hour) const;
 		void SetAmbientLightByClock();
@@ -117,7 +142,7 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		// Graphics
 		void Render(ae::_Camera *Camera, ae::_Framebuffer *Framebuffer, _Object *ClientPlayer, double BlendFactor, int RenderFlags=0);
 		void RenderLayer(const std::string &Program, glm::vec4 &Bounds, const glm::vec3 &Offset, int Layer, bool Static=false);
-		int AddLights(_Object *ClientPlayer, const std::list<_Object *> *ObjectList, const ae::_Program *Program, glm::vec4 AABB);
+		int AddLights(_Object *ClientPlayer, const std::vector<_Object *> *ObjectList, const ae::_Program *Program, glm::vec4 AABB);
 
 		// Collision
 		bool CanMoveTo(const glm::ivec2 &Position, _Object *Object);
@@ -130,9 +155,9 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		void AddObject(_Object *Object);
 		void RemoveObject(const _Object *RemoveObject);
 		void SendObjectList(ae::_Peer *Peer);
-		void GetPotentialBattlePlayers(const _Object *Player, float DistanceSquared, std::size_t Max, std::vector<_Object *> &Players);
+		void GetPotentialBattlePlayers(const _Object *Player, float DistanceSquared, std::size_t Max, _ScratchVector<_Object *> &Players);
 		_Battle *GetCloseBattle(const _Object *Player, bool &HitPrivateParty, bool &HitFullBattle, bool &HitLevelRestriction, bool &HitBossBattle);
-		void GetPVPPlayers(const _Object *Attacker, std::vector<_Object *> &Players, bool UsePVPZone);
+		void GetPVPPlayers(const _Object *Attacker, _ScratchVector<_Object *> &Players, bool UsePVPZone);
 		_Object *FindTradePlayer(const _Object *Player, float MaxDistanceSquared);
 		_Object *FindDeadPlayer(const _Object *Player, float MaxDistanceSquared);
 		bool FindEvent(const _Event &Event, glm::ivec2 &Position) const;
@@ -143,13 +168,21 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		glm::vec2 GetValidPosition(const glm::vec2 &Position) const;
 		glm::ivec2 GetValidCoord(const glm::ivec2 &Position) const;
 
-		void GetTile(const glm::ivec2 &Position, _Tile &Tile) const { Tile = Tiles[Position.x][Position.y]; }
-		const _Tile *GetTile(const glm::ivec2 &Position) const { return &Tiles[Position.x][Position.y]; }
-		void SetTile(const glm::ivec2 &Position, const _Tile *Tile) { Tiles[Position.x][Position.y] = *Tile; }
+		int GetTileIndex(const glm::ivec2 &Position) const { return Position.y * Size.x + Position.x; }
+		_Tile GetTile(const glm::ivec2 &Position) const;
+		void GetTile(const glm::ivec2 &Position, _Tile &Tile) const { Tile = GetTile(Position); }
+		void SetTile(const glm::ivec2 &Position, const _Tile *Tile);
+		const _HotTile &GetHotTile(const glm::ivec2 &Position) const { return HotTiles[GetTileIndex(Position)]; }
+		_Event GetEvent(const glm::ivec2 &Position) const { int Index = GetTileIndex(Position); return _Event(HotTiles[Index].EventType, EventData[Index]); }
 
 		// File IO
 		void Load(const _MapStat *MapStat, bool Static=false);
+		void LoadTiles(const std::string &Path);
+		void LoadText(const std::string &Path);
+		bool LoadBinary(const std::string &Path);
 		bool Save(const std::string &Path);
+		bool SaveBinary(const std::string &Path);
+		static std::string GetBinaryPath(const std::string &Path);
 
 		void NodeToPosition(void *Node, glm::ivec2 &Position) {
 			int Index = (int)(intptr_t)Node;
@@ -159,10 +192,12 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 
 		void *PositionToNode(const glm::ivec2 &Position) { return (void *)(intptr_t)(Position.y * Size.x + Position.x); }
 
-		// Map data
-		_Tile **Tiles;
+		// Map data, stored row by row
+		_HotTile *HotTiles;
+		uint32_t *EventData;
+		uint32_t *TileTextures[2];
 		glm::ivec2 Size;
-		std::map<_Event, std::vector<glm::ivec2>> IndexedEvents;
+		std::unordered_map<_Event, std::vector<glm::ivec2>, _EventHash> IndexedEvents;
 
 		// Graphics
 		const ae::_Atlas *TileAtlas;
@@ -172,6 +207,8 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		int OutsideFlag;
 		double Clock;
 		bool Headless;
+		bool Loading;
+		bool LoadFailed;
 
 		// Background
 		std::string BackgroundMapFile;
@@ -179,9 +216,10 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		_Map *BackgroundMap;
 
 		// Objects
-		std::list<_Object *> Objects;
-		std::list<_Object *> StaticObjects;
+		std::vector<_Object *> Objects;
+		std::vector<_Object *> StaticObjects;
 		double ObjectUpdateTime;
+		double IdleTime;
 		uint8_t UpdateID;
 
 		// Stats
@@ -198,11 +236,13 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		uint32_t CurrentZoneColors;
 
 		// Path finding
-		micropather::MicroPather *Pather;
+		std::shared_ptr<const _PathGrid> GetPathGrid();
+		_Pathfinder *Pathfinder;
 
 	private:
 
 		void FreeMap();
+		void CreateEventObject(const _Event &Event, const glm::ivec2 &Position);
 
 		// Path finding
 		float LeastCostEstimate(void *StateStart, void *StateEnd) override;
@@ -218,4 +258,7 @@ class _Map : public ae::_BaseObject, public micropather::Graph {
 		// Network
 		std::list<const ae::_Peer *> Peers;
 
+		// Path finding
+		std::shared_ptr<const _PathGrid> PathGrid;
+
 };
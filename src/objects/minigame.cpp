@@ -35,27 +35,35 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/norm.hpp>
 #include <algorithm>
+#include <list>
 #include <iostream>
 
 // Constructor
-_Minigame::_Minigame(const _MinigameType *Minigame) :
-	IsServer(false),
+_Minigame::_Minigame(const _MinigameType *Minigame, bool IsServer) :
+	IsServer(IsServer),
+	ReferencePhysics(false),
+	Camera(nullptr),
 	Minigame(Minigame),
 	State(StateType::NEEDSEED),
 	Time(0),
 	DropX(0),
 	Bucket((std::size_t)-1),
 	Debug(0),
-	Bounces(0) {
+	Bounces(0),
+	Mark(0) {
 
-	Camera = new ae::_Camera(glm::vec3(0.0f, 0.0f, CAMERA_DISTANCE), CAMERA_DIVISOR, CAMERA_FOVY, CAMERA_NEAR, CAMERA_FAR);
-	Camera->CalculateFrustum(ae::Graphics.AspectRatio);
+	// Server simulations can run on worker threads, so avoid graphics and assets
+	if(!IsServer) {
+		Camera = new ae::_Camera(glm::vec3(0.0f, 0.0f, CAMERA_DISTANCE), CAMERA_DIVISOR, CAMERA_FOVY, CAMERA_NEAR, CAMERA_FAR);
+		Camera->CalculateFrustum(ae::Graphics.AspectRatio);
+	}
 
 	Boundary.Start = glm::vec2(-8, -6.5);
 	Boundary.End = glm::vec2(8, 6);
 
-	glm::ivec2 GridSize(std::ceil(Boundary.End.x - Boundary.Start.x), std::ceil(Boundary.End.y - Boundary.Start.y));
-	Grid = new _Grid(GridSize, -Boundary.Start);
+	GridSize = glm::ivec2(std::ceil(Boundary.End.x - Boundary.Start.x), std::ceil(Boundary.End.y - Boundary.Start.y));
+	GridOffset = -Boundary.Start;
+	Grid = new _Grid(GridSize, GridOffset);
 
 	Sprites = new ae::_Manager<_Sprite>();
 	Ball = Sprites->Create();
@@ -68,7 +76,7 @@ _Minigame::_Minigame(const _MinigameType *Minigame) :
 	Ball->RigidBody.CollisionMask = 0;
 	Ball->RigidBody.CollisionResponse = false;
 	Ball->RigidBody.Position.y = Boundary.Start.y + Ball->Shape.HalfSize[0] * 2;
-	Ball->Texture = ae::Assets.Textures["textures/minigames/ball.png"];
+	Ball->Texture = GetTexture("textures/minigames/ball.png");
 
 	float SpacingX = 2.0f;
 	float SpacingY = 2.0f;
@@ -92,7 +100,7 @@ _Minigame::_Minigame(const _MinigameType *Minigame) :
 			Sprite->RigidBody.ForcePosition(glm::vec2(X, Y));
 
 			if(i == Rows-1) {
-				Sprite->Texture = ae::Assets.Textures["textures/minigames/bar.png"];
+				Sprite->Texture = GetTexture("textures/minigames/bar.png");
 				Sprite->Scale = glm::vec2(0.5f, 2.5f);
 				Sprite->Shape.HalfSize = glm::vec2(0.5f, 0.5f) * glm::vec2(0.5f, 2.5f);
 				Sprite->RigidBody.ForcePosition(glm::vec2(X, Y + 0.75f));
@@ -104,23 +112,24 @@ _Minigame::_Minigame(const _MinigameType *Minigame) :
 				Tip->RigidBody.CollisionMask = 1;
 				Tip->RigidBody.CollisionGroup = 2;
 				Tip->RigidBody.ForcePosition(glm::vec2(X, Y-0.5f));
-				Tip->Texture = ae::Assets.Textures["textures/minigames/halfpeg.png"];
+				Tip->Texture = GetTexture("textures/minigames/halfpeg.png");
 				Tip->Scale = glm::vec2(0.5f, 0.5f);
 				Tip->Shape.HalfSize = glm::vec2(0.5f, 0.0f) * Sprite->Scale;
-				Grid->AddObject(Tip, Tip->RigidBody.Position, Tip->Shape.HalfSize);
+				AddStaticBody(Tip);
 			}
 			else {
-				Sprite->Texture = ae::Assets.Textures["textures/minigames/peg.png"];
+				Sprite->Texture = GetTexture("textures/minigames/peg.png");
 				Sprite->Scale = glm::vec2(0.5f, 0.5f);
 				Sprite->Shape.HalfSize = glm::vec2(0.5f, 0.0f) * Sprite->Scale;
 			}
 
-			Grid->AddObject(Sprite, Sprite->RigidBody.Position, Sprite->Shape.HalfSize);
+			AddStaticBody(Sprite);
 		}
 
 		Odd = !Odd;
 	}
 
+	BakeBroadphase();
 	Update(0);
 }
 
@@ -157,41 +166,17 @@ void _Minigame::Update(double FrameTime) {
 	Sprites->Update(FrameTime);
 
 	// Check collision
-	std::list<ae::_Manifold> Manifolds;
+	Contacts.clear();
 	bool PlayedSound = false;
 	for(auto &Sprite : Sprites->Objects) {
 		Sprite->Touching = false;
 		if(Sprite->RigidBody.InverseMass <= 0.0f)
 			continue;
 
-		// Get list of objects from grid
-		std::list<const void *> PotentialObjects;
-		Grid->GetObjectList(Sprite->RigidBody.Position, Sprite->Shape.HalfSize, PotentialObjects);
-		for(auto &TestObject : PotentialObjects) {
-			_Sprite *TestSprite = (_Sprite *)TestObject;
-			if(!(Sprite->RigidBody.CollisionGroup & TestSprite->RigidBody.CollisionMask))
-				continue;
-
-			if(Sprite == TestSprite)
-				continue;
-
-			if(Sprite->Shape.IsAABB()) {
-
-			}
-			else {
-				ae::_Manifold Manifold;
-				bool AxisAlignedPush = false;
-				if(TestSprite->CheckCircle(Sprite->RigidBody.Position, Sprite->Shape.HalfSize[0], Manifold.Normal, Manifold.Penetration, AxisAlignedPush)) {
-					if(Sprite->RigidBody.InverseMass > 0.0f && TestSprite->RigidBody.CollisionResponse) {
-						Manifold.ObjectA = Sprite;
-						Manifold.ObjectB = TestSprite;
-						Sprite->Touching = true;
-
-						Manifolds.push_back(Manifold);
-					}
-				}
-			}
-		}
+		if(ReferencePhysics)
+			GetContactsReference(Sprite);
+		else
+			GetContacts(Sprite);
 
 		if(Sprite->RigidBody.InverseMass > 0.0f) {
 			if(Debug > 0) {
@@ -201,27 +186,14 @@ void _Minigame::Update(double FrameTime) {
 
 			glm::vec4 AABB = Sprite->Shape.GetAABB(Sprite->RigidBody.Position);
 			if(AABB[0] < Boundary.Start.x) {
-				ae::_Manifold Manifold;
-				Manifold.ObjectA = Sprite;
-				Manifold.Penetration = std::abs(AABB[0] - Boundary.Start.x);
-				Manifold.Normal = glm::vec2(1.0, 0);
-				Manifolds.push_back(Manifold);
+				Contacts.push_back({ Sprite, nullptr, -1, glm::vec2(1.0, 0), std::abs(AABB[0] - Boundary.Start.x) });
 				Sprite->Touching = true;
 			}
 			else if(AABB[2] > Boundary.End.x) {
-				ae::_Manifold Manifold;
-				Manifold.ObjectA = Sprite;
-				Manifold.Penetration = std::abs(AABB[2] - Boundary.End.x);
-				Manifold.Normal = glm::vec2(-1.0, 0);
-				Manifolds.push_back(Manifold);
+				Contacts.push_back({ Sprite, nullptr, -1, glm::vec2(-1.0, 0), std::abs(AABB[2] - Boundary.End.x) });
 				Sprite->Touching = true;
 			}
 			else if(AABB[3] > Boundary.End.y) {
-				ae::_Manifold Manifold;
-				Manifold.ObjectA = Sprite;
-				Manifold.Penetration = std::abs(AABB[3] - Boundary.End.y);
-				Manifold.Normal = glm::vec2(0.0, -1.0f);
-
 				float Width = Boundary.End.x - Boundary.Start.x;
 				Bucket = (std::size_t)((Sprite->RigidBody.Position.x - Boundary.Start.x) / Width * 8.0f);
 				Sprite->Deleted = true;
@@ -246,10 +218,136 @@ void _Minigame::Update(double FrameTime) {
 	}
 
 	// Resolve penetration
-	for(auto &Manifold : Manifolds) {
-		_Sprite *SpriteA = (_Sprite *)Manifold.ObjectA;
-		_Sprite *SpriteB = (_Sprite *)Manifold.ObjectB;
-		glm::vec2 Normal = -Manifold.Normal;
+	ResolveContacts();
+
+	Time += FrameTime;
+}
+
+// Add a static sprite to the collision grid and body arrays
+void _Minigame::AddStaticBody(_Sprite *Sprite) {
+	Grid->AddObject(Sprite, Sprite->RigidBody.Position, Sprite->Shape.HalfSize);
+
+	Bodies.Position.push_back(Sprite->RigidBody.Position);
+	Bodies.Velocity.push_back(Sprite->RigidBody.Velocity);
+	Bodies.HalfSize.push_back(Sprite->Shape.HalfSize);
+	Bodies.Restitution.push_back(Sprite->RigidBody.Restitution);
+	Bodies.InverseMass.push_back(Sprite->RigidBody.InverseMass);
+	Bodies.CollisionMask.push_back(Sprite->RigidBody.CollisionMask);
+	Bodies.CollisionResponse.push_back(Sprite->RigidBody.CollisionResponse);
+	Bodies.IsAABB.push_back(Sprite->Shape.IsAABB());
+}
+
+// Build flat tile lists from static bodies, newest first like _Grid
+void _Minigame::BakeBroadphase() {
+	std::size_t TileCount = (std::size_t)(GridSize.x * GridSize.y);
+	std::vector<std::vector<int>> Tiles(TileCount);
+	for(std::size_t i = 0; i < Bodies.Position.size(); i++) {
+		ae::_Bounds Bounds;
+		Grid->GetTileBounds(Bodies.Position[i] + GridOffset, Bodies.HalfSize[i], Bounds);
+		for(int x = Bounds.Start.x; x <= Bounds.End.x; x++) {
+			for(int y = Bounds.Start.y; y <= Bounds.End.y; y++)
+				Tiles[(std::size_t)(x * GridSize.y + y)].push_back((int)i);
+		}
+	}
+
+	TileStart.clear();
+	TileBodies.clear();
+	for(const auto &Tile : Tiles) {
+		TileStart.push_back((int)TileBodies.size());
+		TileBodies.insert(TileBodies.end(), Tile.rbegin(), Tile.rend());
+	}
+	TileStart.push_back((int)TileBodies.size());
+
+	BodyMarks.assign(Bodies.Position.size(), 0);
+	Candidates.reserve(Bodies.Position.size());
+	Contacts.reserve(Bodies.Position.size() + 1);
+}
+
+// Find contacts between a dynamic sprite and static bodies
+void _Minigame::GetContacts(_Sprite *Sprite) {
+
+	// Start new query
+	Mark++;
+	if(!Mark) {
+		std::fill(BodyMarks.begin(), BodyMarks.end(), 0);
+		Mark = 1;
+	}
+
+	// Gather unique bodies from touched tiles
+	ae::_Bounds Bounds;
+	Grid->GetTileBounds(Sprite->RigidBody.Position + GridOffset, Sprite->Shape.HalfSize, Bounds);
+	Candidates.clear();
+	for(int x = Bounds.Start.x; x <= Bounds.End.x; x++) {
+		for(int y = Bounds.Start.y; y <= Bounds.End.y; y++) {
+			int Tile = x * GridSize.y + y;
+			for(int i = TileStart[(std::size_t)Tile]; i < TileStart[(std::size_t)Tile + 1]; i++) {
+				int Body = TileBodies[(std::size_t)i];
+				if(BodyMarks[(std::size_t)Body] == Mark)
+					continue;
+
+				BodyMarks[(std::size_t)Body] = Mark;
+				Candidates.push_back(Body);
+			}
+		}
+	}
+
+	if(Sprite->Shape.IsAABB())
+		return;
+
+	// Test in the same order as _Grid::GetObjectList
+	for(auto Iterator = Candidates.rbegin(); Iterator != Candidates.rend(); ++Iterator) {
+		std::size_t Body = (std::size_t)*Iterator;
+		if(!(Sprite->RigidBody.CollisionGroup & Bodies.CollisionMask[Body]))
+			continue;
+
+		glm::vec2 Normal(0.0f);
+		float Penetration = 0.0f;
+		bool AxisAlignedPush = false;
+		if(_Sprite::CheckCircle(Bodies.Position[Body], Bodies.HalfSize[Body], Bodies.IsAABB[Body], Sprite->RigidBody.Position, Sprite->Shape.HalfSize[0], Normal, Penetration, AxisAlignedPush)) {
+			if(Bodies.CollisionResponse[Body]) {
+				Contacts.push_back({ Sprite, nullptr, (int)Body, Normal, Penetration });
+				Sprite->Touching = true;
+			}
+		}
+	}
+}
+
+// Find contacts using sprite lists from the grid, used to verify GetContacts
+void _Minigame::GetContactsReference(_Sprite *Sprite) {
+
+	// Get list of objects from grid
+	std::list<const void *> PotentialObjects;
+	Grid->GetObjectList(Sprite->RigidBody.Position, Sprite->Shape.HalfSize, PotentialObjects);
+	for(auto &TestObject : PotentialObjects) {
+		_Sprite *TestSprite = (_Sprite *)TestObject;
+		if(!(Sprite->RigidBody.CollisionGroup & TestSprite->RigidBody.CollisionMask))
+			continue;
+
+		if(Sprite == TestSprite)
+			continue;
+
+		if(Sprite->Shape.IsAABB())
+			continue;
+
+		glm::vec2 Normal(0.0f);
+		float Penetration = 0.0f;
+		bool AxisAlignedPush = false;
+		if(TestSprite->CheckCircle(Sprite->RigidBody.Position, Sprite->Shape.HalfSize[0], Normal, Penetration, AxisAlignedPush)) {
+			if(TestSprite->RigidBody.CollisionResponse) {
+				Contacts.push_back({ Sprite, TestSprite, -1, Normal, Penetration });
+				Sprite->Touching = true;
+			}
+		}
+	}
+}
+
+// Separate objects and apply impulses
+void _Minigame::ResolveContacts() {
+	for(auto &Contact : Contacts) {
+		_Sprite *SpriteA = Contact.Sprite;
+		_Sprite *SpriteB = Contact.Other;
+		std::size_t Body = (std::size_t)Contact.Body;
+		glm::vec2 Normal = -Contact.Normal;
 
 		// Check for response
 		if(!SpriteA->RigidBody.CollisionResponse)
@@ -257,11 +355,13 @@ void _Minigame::Update(double FrameTime) {
 
 		// Separate objects
 		if(SpriteA->RigidBody.InverseMass > 0.0f)
-			SpriteA->RigidBody.Position += Manifold.Normal * Manifold.Penetration;
+			SpriteA->RigidBody.Position += Contact.Normal * Contact.Penetration;
 
 		// Get relative velocity
 		glm::vec2 RelativeVelocity = -SpriteA->RigidBody.Velocity;
-		if(SpriteB)
+		if(Contact.Body >= 0)
+			RelativeVelocity += Bodies.Velocity[Body];
+		else if(SpriteB)
 			RelativeVelocity += SpriteB->RigidBody.Velocity;
 
 		// Check if objects are moving towards each other
@@ -271,13 +371,17 @@ void _Minigame::Update(double FrameTime) {
 
 		// Get restitution
 		float MinimumRestitution = SpriteA->RigidBody.Restitution;
-		if(SpriteB)
+		if(Contact.Body >= 0)
+			MinimumRestitution = std::min(MinimumRestitution, Bodies.Restitution[Body]);
+		else if(SpriteB)
 			MinimumRestitution = std::min(MinimumRestitution, SpriteB->RigidBody.Restitution);
 
 		// Calculate impulse magnitude
 		float ImpulseScalar = -(1 + MinimumRestitution) * VelocityDotNormal;
 		float ImpulseDenominator = SpriteA->RigidBody.InverseMass;
-		if(SpriteB)
+		if(Contact.Body >= 0)
+			ImpulseDenominator += Bodies.InverseMass[Body];
+		else if(SpriteB)
 			ImpulseDenominator += SpriteB->RigidBody.InverseMass;
 
 		ImpulseScalar /= ImpulseDenominator;
@@ -285,11 +389,11 @@ void _Minigame::Update(double FrameTime) {
 		// Apply impulse
 		glm::vec2 ImpulseVector = ImpulseScalar * Normal;
 		SpriteA->RigidBody.Velocity -= SpriteA->RigidBody.InverseMass * ImpulseVector;
-		if(SpriteB)
+		if(Contact.Body >= 0)
+			Bodies.Velocity[Body] += Bodies.InverseMass[Body] * ImpulseVector;
+		else if(SpriteB)
 			SpriteB->RigidBody.Velocity += SpriteB->RigidBody.InverseMass * ImpulseVector;
 	}
-
-	Time += FrameTime;
 }
 
 // Render
@@ -394,12 +498,20 @@ void _Minigame::Drop(float X) {
 	Sprite->Scale = Ball->Scale;
 	Sprite->RigidBody.Position.x = X;
 	Sprite->RigidBody.Position.y = Ball->RigidBody.Position.y;
-	Sprite->Texture = ae::Assets.Textures["textures/minigames/ball.png"];
+	Sprite->Texture = GetTexture("textures/minigames/ball.png");
 
 	DropX = X;
 	State = StateType::DROPPED;
 }
 
+// Get texture for client side rendering
+const ae::_Texture *_Minigame::GetTexture(const std::string &Path) const {
+	if(IsServer)
+		return nullptr;
+
+	return ae::Assets.Textures[Path];
+}
+
 // Refresh prizes
 void _Minigame::RefreshPrizes() {
 
@@ -19,7 +19,11 @@
 
 // Libraries
 #include <ae/bounds.h>
+#include <glm/vec2.hpp>
 #include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
 
 // Forward Declarations
 class _Sprite;
@@ -30,9 +34,31 @@ struct _MinigameType;
 namespace ae {
 	template<class T> class _Manager;
 	class _Camera;
+	class _Texture;
 	struct _MouseEvent;
 }
 
+// Contact between a dropped ball and a static body or the boundary
+struct _MinigameContact {
+	_Sprite *Sprite;
+	_Sprite *Other;
+	int Body;
+	glm::vec2 Normal;
+	float Penetration;
+};
+
+// Static bodies stored as flat arrays
+struct _MinigameBodies {
+	std::vector<glm::vec2> Position;
+	std::vector<glm::vec2> Velocity;
+	std::vector<glm::vec2> HalfSize;
+	std::vector<float> Restitution;
+	std::vector<float> InverseMass;
+	std::vector<int> CollisionMask;
+	std::vector<uint8_t> CollisionResponse;
+	std::vector<uint8_t> IsAABB;
+};
+
 // Base minigame class
 class _Minigame {
 
@@ -45,7 +71,7 @@ class _Minigame {
 			DONE,
 		};
 
-		_Minigame(const _MinigameType *Minigame);
+		_Minigame(const _MinigameType *Minigame, bool IsServer=false);
 		~_Minigame();
 
 		// Update
@@ -60,6 +86,7 @@ class _Minigame {
 
 		// Attributes
 		bool IsServer;
+		bool ReferencePhysics;
 
 		// Objects
 		std::mt19937 Random;
@@ -83,4 +110,26 @@ class _Minigame {
 
 	private:
 
+		const ae::_Texture *GetTexture(const std::string &Path) const;
+
+		// Physics
+		void AddStaticBody(_Sprite *Sprite);
+		void BakeBroadphase();
+		void GetContacts(_Sprite *Sprite);
+		void GetContactsReference(_Sprite *Sprite);
+		void ResolveContacts();
+
+		// Broadphase
+		_MinigameBodies Bodies;
+		glm::ivec2 GridSize;
+		glm::vec2 GridOffset;
+		std::vector<int> TileStart;
+		std::vector<int> TileBodies;
+		std::vector<uint32_t> BodyMarks;
+		uint32_t Mark;
+
+		// Scratch
+		std::vector<int> Candidates;
+		std::vector<_MinigameContact> Contacts;
+
 };
@@ -23,6 +23,8 @@
 #include <objects/components/fighter.h>
 #include <objects/components/controller.h>
 #include <objects/components/monster.h>
+#include <componentpool.h>
+#include <botbrain.h>
 #include <objects/statuseffect.h>
 #include <objects/map.h>
 #include <objects/battle.h>
@@ -40,6 +42,8 @@
 #include <ae/program.h>
 #include <config.h>
 #include <packet.h>
+#include <pathfinder.h>
+#include <pathqueue.h>
 #include <server.h>
 #include <stats.h>
 #include <scripting.h>
@@ -63,13 +67,18 @@ _Object::_Object() :
 	Fighter(nullptr),
 	Controller(nullptr),
 	Monster(nullptr),
+	ComponentPool(nullptr),
+	BotBrain(nullptr),
 
 	Stats(nullptr),
 	Map(nullptr),
+	MapSlot(0),
 	Scripting(nullptr),
 	Server(nullptr),
 	Peer(nullptr),
 	QueuedMapChange(0),
+	TransferMapID(0),
+	TransferEventType(0),
 
 	Position(0, 0),
 	ServerPosition(0, 0),
@@ -79,6 +88,9 @@ _Object::_Object() :
 	BossZoneID(0),
 	Light(0),
 
+	SkippedFrameTime(0.0),
+	SkippedTicks(0),
+
 	UpdateID(0),
 	Changed(false),
 	OldPosition(0, 0),
@@ -115,6 +127,14 @@ _Object::~_Object() {
 		}
 	}
 
+	delete BotBrain;
+
+	// Return components to pool
+	if(ComponentPool) {
+		ComponentPool->ReleaseComponents(this);
+		return;
+	}
+
 	delete Monster;
 	delete Controller;
 	delete Fighter;
@@ -135,9 +155,43 @@ void _Object::CreateComponents() {
 void _Object::Update(double FrameTime) {
 	bool CheckEvent = false;
 
-	// Update bots
-	if(Server && Character->Bot)
-		UpdateBot(FrameTime);
+	if(Server) {
+
+		// Bot brains think every tick
+		if(Character->Bot) {
+			if(Character->Battle)
+				Scripting->Random = &Character->Battle->Random;
+			UpdateBot(FrameTime);
+			Scripting->Random = nullptr;
+		}
+
+		// Update objects with nothing to do at a lower rate
+		UpdateTierType Tier = Config.UpdateTiers ? GetUpdateTier() : UPDATE_ACTIVE;
+		Server->VisitedObjects++;
+
+		SkippedFrameTime += FrameTime;
+		SkippedTicks++;
+		if(Tier == UPDATE_IDLE) {
+			Server->IdleObjects++;
+			if(SkippedTicks < OBJECT_IDLE_UPDATE_TICKS)
+				return;
+		}
+		else if(Tier == UPDATE_DORMANT) {
+			Server->DormantObjects++;
+			if(SkippedTicks < OBJECT_DORMANT_UPDATE_TICKS)
+				return;
+		}
+
+		// Catch up on time missed
+		FrameTime = SkippedFrameTime;
+		SkippedFrameTime = 0.0;
+		SkippedTicks = 0;
+		Server->UpdatedObjects++;
+	}
+
+	// Send script rolls to the battle's stream
+	if(Server && Character->Battle)
+		Scripting->Random = &Character->Battle->Random;
 
 	// Update player position
 	Controller->DirectionMoved = Move();
@@ -158,8 +212,8 @@ void _Object::Update(double FrameTime) {
 	// Update actions and battle
 	if(Character->IsAlive()) {
 
-		// Update monster AI
-		if(Server && Character->Battle && IsMonster())
+		// Update monster AI, batched by the battle when enabled
+		if(Server && Character->Battle && IsMonster() && !Config.BatchMonsterAI)
 			UpdateMonsterAI(FrameTime);
 
 		// Check turn timer
@@ -183,6 +237,8 @@ void _Object::Update(double FrameTime) {
 
 				ae::_Buffer Packet;
 				if(Character->Action.Resolve(Packet, this, Scope)) {
+					if(Character->Battle)
+						Server->BattleActions++;
 					SendPacket(Packet);
 				}
 				else {
@@ -209,6 +265,9 @@ void _Object::Update(double FrameTime) {
 			Character->Attributes["BattleTime"].Double += FrameTime;
 	}
 
+	if(Server)
+		Scripting->Random = nullptr;
+
 	// Update teleport time
 	if(Character->TeleportTime > 0.0) {
 		Character->Status = _Character::STATUS_TELEPORT;
@@ -223,7 +282,7 @@ void _Object::Update(double FrameTime) {
 	Controller->MoveTime += FrameTime;
 
 	// Check events
-	if(Map && CheckEvent)
+	if(Map && CheckEvent && !TransferMapID)
 		Map->CheckEvents(this);
 
 	// Update status
@@ -250,11 +309,33 @@ void _Object::Update(double FrameTime) {
 	OldLight = Light;
 }
 
+// Get how often the object needs updating
+_Object::UpdateTierType _Object::GetUpdateTier() const {
+
+	// Anything that can change state on its own this tick
+	if(Character->Battle || Character->TeleportTime > 0.0 || Character->Action.IsSet() || TransferMapID)
+		return UPDATE_ACTIVE;
+	if(Controller->InputStates.size() || Controller->UseCommand)
+		return UPDATE_ACTIVE;
+
+	// Dead players waiting to respawn
+	if(!Character->IsAlive())
+		return UPDATE_DORMANT;
+
+	// Players parked without input
+	if(Character->IdleTime > PLAYER_IDLE_TIME)
+		return UPDATE_IDLE;
+
+	return UPDATE_ACTIVE;
+}
+
 // Update bot AI
 void _Object::UpdateBot(double FrameTime) {
 
-	// Call ai script
-	if(!Character->Battle && Scripting->StartMethodCall("Bot_Server", "Update")) {
+	// Update goals
+	if(BotBrain)
+		BotBrain->Update(FrameTime);
+	else if(!Character->Battle && Scripting->StartMethodCall("Bot_Server", "Update")) {
 		Scripting->PushReal(FrameTime);
 		Scripting->PushObject(this);
 		Scripting->MethodCall(2, 0);
@@ -266,8 +347,10 @@ void _Object::UpdateBot(double FrameTime) {
 		Character->IdleTime = 0.0;
 		int InputState = 0;
 
-		// Call ai input script
-		if(Scripting->StartMethodCall("Bot_Server", "GetInputState")) {
+		// Get next move
+		if(BotBrain)
+			InputState = BotBrain->GetInputState();
+		else if(Scripting->StartMethodCall("Bot_Server", "GetInputState")) {
 			Scripting->PushObject(this);
 			Scripting->MethodCall(1, 1);
 			InputState = Scripting->GetInt(1);
@@ -334,6 +417,7 @@ void _Object::UpdateMonsterAI(double FrameTime) {
 
 		// Call lua script
 		if(Enemies.size()) {
+			uint64_t PushedObjects = Scripting->PushedObjects;
 			if(Scripting->StartMethodCall(Monster->AI, "Update")) {
 				Character->Targets.clear();
 				Scripting->PushObject(this);
@@ -341,7 +425,11 @@ void _Object::UpdateMonsterAI(double FrameTime) {
 				Scripting->PushObjectList(Allies);
 				Scripting->MethodCall(3, 0);
 				Scripting->FinishMethodCall();
+				Server->MonsterAICalls++;
 			}
+
+			Server->MonsterAITurns++;
+			Server->MonsterAIPushes += Scripting->PushedObjects - PushedObjects;
 		}
 	}
 }
@@ -763,9 +851,13 @@ void _Object::SerializeSaveData(Json::Value &Data) const {
 	// Write cooldowns
 	Json::Value CooldownsNode;
 	for(auto &Cooldown : Character->Cooldowns) {
+		double Duration = Character->GetCooldown(Cooldown.first);
+		if(Duration <= 0.0)
+			continue;
+
 		Json::Value CooldownNode;
 		CooldownNode["id"] = Cooldown.first;
-		CooldownNode["duration"] = Cooldown.second.Duration;
+		CooldownNode["duration"] = Duration;
 		CooldownNode["maxduration"] = Cooldown.second.MaxDuration;
 		CooldownsNode.append(CooldownNode);
 	}
@@ -774,9 +866,13 @@ void _Object::SerializeSaveData(Json::Value &Data) const {
 	// Write boss cooldowns
 	Json::Value BossCooldownsNode;
 	for(auto &BossCooldown : Character->BossCooldowns) {
+		double Duration = Character->GetBossCooldown(BossCooldown.first);
+		if(Duration <= 0.0)
+			continue;
+
 		Json::Value BossCooldownNode;
 		BossCooldownNode["id"] = BossCooldown.first;
-		BossCooldownNode["duration"] = BossCooldown.second;
+		BossCooldownNode["duration"] = Duration;
 		BossCooldownsNode.append(BossCooldownNode);
 	}
 	Data["bosscooldowns"] = BossCooldownsNode;
@@ -927,6 +1023,7 @@ void _Object::UnserializeSaveData(const std::string &JsonString) {
 			StatusEffect->Time = 1.0 - (StatusEffect->Duration - (int)StatusEffect->Duration);
 		}
 		Character->StatusEffects.push_back(StatusEffect);
+		Character->ScheduleStatusEffect(StatusEffect);
 	}
 
 	// Set unlocks
@@ -935,14 +1032,17 @@ void _Object::UnserializeSaveData(const std::string &JsonString) {
 
 	// Set cooldowns
 	for(const Json::Value &CooldownNode : Data["cooldowns"]) {
-		uint32_t CooldownID = CooldownNode["id"].asUInt();
-		Character->Cooldowns[CooldownID].Duration = CooldownNode["duration"].asDouble();
-		Character->Cooldowns[CooldownID].MaxDuration = CooldownNode["maxduration"].asDouble();
+		double Duration = CooldownNode["duration"].asDouble();
+		if(Duration > 0.0)
+			Character->SetCooldown(CooldownNode["id"].asUInt(), Duration, CooldownNode["maxduration"].asDouble());
 	}
 
 	// Set boss cooldowns
-	for(const Json::Value &BossCooldownNode : Data["bosscooldowns"])
-		Character->BossCooldowns[BossCooldownNode["id"].asUInt()] = BossCooldownNode["duration"].asDouble();
+	for(const Json::Value &BossCooldownNode : Data["bosscooldowns"]) {
+		double Duration = BossCooldownNode["duration"].asDouble();
+		if(Duration > 0.0)
+			Character->SetBossCooldown(BossCooldownNode["id"].asUInt(), Duration);
+	}
 
 	// Set boss kills
 	for(const Json::Value &BossKillNode: Data["bosskills"])
@@ -1076,7 +1176,7 @@ void _Object::SerializeStats(ae::_Buffer &Data) {
 	Data.Write<uint32_t>((uint32_t)Character->Cooldowns.size());
 	for(const auto &Cooldown : Character->Cooldowns) {
 		Data.Write<uint32_t>(Cooldown.first);
-		Data.Write<float>(Cooldown.second.Duration);
+		Data.Write<float>(Character->GetCooldown(Cooldown.first));
 		Data.Write<float>(Cooldown.second.MaxDuration);
 	}
 
@@ -1169,8 +1269,9 @@ void _Object::UnserializeStats(ae::_Buffer &Data) {
 	uint32_t CooldownCount = Data.Read<uint32_t>();
 	for(uint32_t i = 0; i < CooldownCount; i++) {
 		uint32_t CooldownID = Data.Read<uint32_t>();
-		Character->Cooldowns[CooldownID].Duration = Data.Read<float>();
-		Character->Cooldowns[CooldownID].MaxDuration = Data.Read<float>();
+		double Duration = Data.Read<float>();
+		double MaxDuration = Data.Read<float>();
+		Character->SetCooldown(CooldownID, Duration, MaxDuration);
 	}
 
 	// Read boss cooldowns
@@ -1241,7 +1342,7 @@ void _Object::SerializeBossCooldowns(ae::_Buffer &Data) {
 	Data.Write<uint32_t>((uint32_t)Character->BossCooldowns.size());
 	for(const auto &BossCooldown : Character->BossCooldowns) {
 		Data.Write<uint32_t>(BossCooldown.first);
-		Data.Write<float>(BossCooldown.second);
+		Data.Write<float>(Character->GetBossCooldown(BossCooldown.first));
 	}
 }
 
@@ -1251,7 +1352,7 @@ void _Object::UnserializeBossCooldowns(ae::_Buffer &Data) {
 	uint32_t BossCooldownCount = Data.Read<uint32_t>();
 	for(uint32_t i = 0; i < BossCooldownCount; i++) {
 		uint32_t BossCooldownID = Data.Read<uint32_t>();
-		Character->BossCooldowns[BossCooldownID] = Data.Read<float>();
+		Character->SetBossCooldown(BossCooldownID, Data.Read<float>());
 	}
 }
 
@@ -1320,7 +1421,7 @@ _StatusEffect *_Object::UpdateStats(_StatChange &StatChange, _Object *Source) {
 			ae::_Buffer Packet;
 			Packet.Write<PacketType>(PacketType::INVENTORY);
 			Inventory->Serialize(Packet);
-			Server->Network->SendPacket(Packet, Peer);
+			Server->SendPacket(Packet, Peer);
 		}
 	}
 
@@ -1454,7 +1555,7 @@ _StatusEffect *_Object::UpdateStats(_StatChange &StatChange, _Object *Source) {
 	// Boss cooldowns
 	if(StatChange.HasStat("CurrentBossCooldowns")) {
 		for(auto &BattleCooldown : Character->BossCooldowns)
-			BattleCooldown.second *= 1.0 - StatChange.Values["CurrentBossCooldowns"].Mult();
+			Character->SetBossCooldown(BattleCooldown.first, Character->GetBossCooldown(BattleCooldown.first) * (1.0 - StatChange.Values["CurrentBossCooldowns"].Mult()));
 	}
 
 	// Rebirth bonus
@@ -1564,7 +1665,7 @@ _StatusEffect *_Object::UpdateStats(_StatChange &StatChange, _Object *Source) {
 
 // Moves the player and returns direction moved
 int _Object::Move() {
-	if(Controller->WaitForServer || Character->Battle || Controller->InputStates.size() == 0 || !Character->IsAlive())
+	if(Controller->WaitForServer || TransferMapID || Character->Battle || Controller->InputStates.size() == 0 || !Character->IsAlive())
 		return 0;
 
 	// Check timer
@@ -1614,7 +1715,7 @@ int _Object::Move() {
 	// Move player
 	if(Moved) {
 		Position += Direction;
-		if(GetTile()->Zone > 0 && !Character->Invisible)
+		if(GetTile().Zone > 0 && !Character->Invisible)
 			Character->NextBattle--;
 
 		return InputState;
@@ -1625,16 +1726,16 @@ int _Object::Move() {
 
 // Return true if the object can respec
 bool _Object::CanRespec() const {
-	if(Map && Map->IsValidPosition(Position) && GetTile()->Event.Type == _Map::EVENT_SPAWN)
+	if(Map && Map->IsValidPosition(Position) && GetTile().EventType == _Map::EVENT_SPAWN)
 		return true;
 
 	return false;
 }
 
 // Gets the tile that the player is currently standing on
-const _Tile *_Object::GetTile() const {
+const _HotTile &_Object::GetTile() const {
 
-	return Map->GetTile(Position);
+	return Map->GetHotTile(Position);
 }
 
 // Get map id, return 0 if none
@@ -1875,7 +1976,7 @@ void _Object::SendSeed(bool Generate) {
 	ae::_Buffer Packet;
 	Packet.Write<PacketType>(PacketType::MINIGAME_SEED);
 	Packet.Write<uint32_t>(Character->Seed);
-	Server->Network->SendPacket(Packet, Peer);
+	Server->SendPacket(Packet, Peer);
 }
 
 // Convert input state bitfield to direction
@@ -1904,7 +2005,7 @@ void _Object::SendPacket(ae::_Buffer &Packet, bool Broadcast) {
 	if(Broadcast && Character->Battle)
 		Character->Battle->BroadcastPacket(Packet);
 	else if(Peer)
-		Server->Network->SendPacket(Packet, Peer);
+		Server->SendPacket(Packet, Peer);
 }
 
 // Send action clear packet to client
@@ -1936,28 +2037,72 @@ bool _Object::IsMonster() const {
 
 // Create list of nodes to destination
 bool _Object::Pathfind(const glm::ivec2 &StartPosition, const glm::ivec2 &EndPosition) {
-	if(!Map || !Map->Pather)
+	if(!Map || !Map->Pathfinder)
 		return false;
 
-	if(Character->Path.size())
+	if(Character->Path.size() || Character->PathPending)
 		return true;
 
-	float TotalCost;
-	std::vector<void *> PathFound;
-	int Result = Map->Pather->Solve(Map->PositionToNode(StartPosition), Map->PositionToNode(EndPosition), &PathFound, &TotalCost);
-	if(Result == micropather::MicroPather::SOLVED) {
+	// Wait after a failed solve
+	if(Server && Server->Time < Character->NextPathTime)
+		return false;
 
-		// Convert vector to list
-		Character->Path.clear();
-		for(auto &Node : PathFound)
-			Character->Path.push_back(Node);
+	// Get items that can open key tiles
+	std::vector<uint32_t> Keys;
+	for(BagType Bag : { BagType::KEYS, BagType::EQUIPMENT, BagType::INVENTORY }) {
+		for(const auto &Slot : Inventory->GetBag(Bag).Slots) {
+			if(Slot.Item)
+				Keys.push_back(Slot.Item->ID);
+		}
+	}
+
+	// Solve on worker threads, path is set when the result is delivered
+	if(Server && Server->PathQueue) {
+		_Server *ObjectServer = Server;
+		ae::NetworkIDType ObjectID = NetworkID;
+		ae::NetworkIDType MapID = Map->NetworkID;
+		uint64_t RequestID = Server->PathQueue->Submit(Map->GetPathGrid(), StartPosition, EndPosition, Keys, [ObjectServer, ObjectID, MapID](uint64_t RequestID, int Result, const std::vector<int> &Path) {
+
+			// Request ids are unique, so a reused network id can't take another object's path
+			_Object *Object = ObjectServer->ObjectManager->GetObject(ObjectID);
+			if(!Object || Object->Character->PathRequestID != RequestID)
+				return;
+
+			Object->Character->PathPending = false;
+			Object->Character->PathRequestID = 0;
+			if(Result != _Pathfinder::SOLVED)
+				Object->Character->NextPathTime = ObjectServer->Time + PATH_RETRY_DELAY;
+			else if(Object->Map && Object->Map->NetworkID == MapID)
+				Object->SetPath(Path);
+		});
+
+		Character->PathRequestID = RequestID;
+		Character->PathPending = RequestID != 0;
+
+		return Character->PathPending;
+	}
+
+	std::vector<int> PathFound;
+	int Result = Map->Pathfinder->Solve(*Map->GetPathGrid(), StartPosition, EndPosition, PathFound, Keys);
+	if(Result == _Pathfinder::SOLVED) {
+		SetPath(PathFound);
 
 		return true;
 	}
 
+	if(Server)
+		Character->NextPathTime = Server->Time + PATH_RETRY_DELAY;
+
 	return false;
 }
 
+// Set path from a list of tile indices
+void _Object::SetPath(const std::vector<int> &Path) {
+	Character->Path.clear();
+	for(auto &Index : Path)
+		Character->Path.push_back((void *)(intptr_t)Index);
+}
+
 // Return an input state from the next node in the path list
 int _Object::GetInputStateFromPath() {
 	int InputState = 0;
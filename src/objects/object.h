@@ -34,6 +34,8 @@ class _Inventory;
 class _Fighter;
 class _Controller;
 class _Monster;
+class _ComponentPool;
+class _BotBrain;
 class _Map;
 class _Battle;
 class _Buff;
@@ -43,7 +45,7 @@ class _Scripting;
 class _StatChange;
 class _StatusEffect;
 class _HUD;
-struct _Tile;
+struct _HotTile;
 struct _ActionResult;
 struct _Slot;
 
@@ -71,6 +73,12 @@ class _Object : public ae::_BaseObject {
 			MOVE_RIGHT = (1 << 3),
 		};
 
+		enum UpdateTierType {
+			UPDATE_ACTIVE,
+			UPDATE_IDLE,
+			UPDATE_DORMANT,
+		};
+
 		_Object();
 		~_Object() override;
 
@@ -80,6 +88,7 @@ class _Object : public ae::_BaseObject {
 		// Updates
 		void Update(double FrameTime) override;
 		void UpdateBot(double FrameTime);
+		UpdateTierType GetUpdateTier() const;
 		void Render(glm::vec4 &ViewBounds, const _Object *ClientPlayer=nullptr);
 		void RenderBattle(_Object *ClientPlayer, double Time, bool ShowLevel);
 
@@ -135,11 +144,12 @@ class _Object : public ae::_BaseObject {
 
 		// Map
 		bool CanRespec() const;
-		const _Tile *GetTile() const;
+		const _HotTile &GetTile() const;
 		ae::NetworkIDType GetMapID() const;
 
 		// Path finding
 		bool Pathfind(const glm::ivec2 &StartPosition, const glm::ivec2 &EndPosition);
+		void SetPath(const std::vector<int> &Path);
 		int GetInputStateFromPath();
 
 		// Base
@@ -154,14 +164,19 @@ class _Object : public ae::_BaseObject {
 		_Fighter *Fighter;
 		_Controller *Controller;
 		_Monster *Monster;
+		_ComponentPool *ComponentPool;
+		_BotBrain *BotBrain;
 
 		// Pointers
 		const _Stats *Stats;
 		_Map *Map;
+		std::size_t MapSlot;
 		_Scripting *Scripting;
 		_Server *Server;
 		ae::_Peer *Peer;
 		uint32_t QueuedMapChange;
+		uint32_t TransferMapID;
+		uint32_t TransferEventType;
 
 		// Movement
 		glm::ivec2 Position;
@@ -173,6 +188,10 @@ class _Object : public ae::_BaseObject {
 		uint32_t BossZoneID;
 		int Light;
 
+		// Update rate
+		double SkippedFrameTime;
+		int SkippedTicks;
+
 		// Compression
 		uint8_t UpdateID;
 		bool Changed;
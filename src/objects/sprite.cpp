@@ -53,29 +53,34 @@ void _Sprite::Render(double BlendFactor) {
 
 // Check collision with a circle
 bool _Sprite::CheckCircle(const glm::vec2 &Position, float Radius, glm::vec2 &Normal, float &Penetration, bool &AxisAlignedPush) const {
+	return CheckCircle(glm::vec2(RigidBody.Position), Shape.HalfSize, Shape.IsAABB(), Position, Radius, Normal, Penetration, AxisAlignedPush);
+}
+
+// Check collision between a circle and a shape at center
+bool _Sprite::CheckCircle(const glm::vec2 &Center, const glm::vec2 &HalfSize, bool IsAABB, const glm::vec2 &Position, float Radius, glm::vec2 &Normal, float &Penetration, bool &AxisAlignedPush) {
 
 	// Get vector to circle center
-	glm::vec2 Point = Position - glm::vec2(RigidBody.Position);
+	glm::vec2 Point = Position - Center;
 
 	// Shape is AABB
-	if(Shape.IsAABB()) {
+	if(IsAABB) {
 
 		glm::vec2 ClosestPoint = Point;
 		int ClampCount = 0;
-		if(ClosestPoint.x < -Shape.HalfSize[0]) {
-			ClosestPoint.x = -Shape.HalfSize[0];
+		if(ClosestPoint.x < -HalfSize[0]) {
+			ClosestPoint.x = -HalfSize[0];
 			ClampCount++;
 		}
-		if(ClosestPoint.y < -Shape.HalfSize[1]) {
-			ClosestPoint.y = -Shape.HalfSize[1];
+		if(ClosestPoint.y < -HalfSize[1]) {
+			ClosestPoint.y = -HalfSize[1];
 			ClampCount++;
 		}
-		if(ClosestPoint.x > Shape.HalfSize[0]) {
-			ClosestPoint.x = Shape.HalfSize[0];
+		if(ClosestPoint.x > HalfSize[0]) {
+			ClosestPoint.x = HalfSize[0];
 			ClampCount++;
 		}
-		if(ClosestPoint.y > Shape.HalfSize[1]) {
-			ClosestPoint.y = Shape.HalfSize[1];
+		if(ClosestPoint.y > HalfSize[1]) {
+			ClosestPoint.y = HalfSize[1];
 			ClampCount++;
 		}
 
@@ -107,7 +112,7 @@ bool _Sprite::CheckCircle(const glm::vec2 &Position, float Radius, glm::vec2 &No
 	else {
 
 		float SquareDistance = Point.x * Point.x + Point.y * Point.y;
-		float RadiiSum = Radius + Shape.HalfSize[0];
+		float RadiiSum = Radius + HalfSize[0];
 
 		bool Hit = SquareDistance < RadiiSum * RadiiSum;
 		if(Hit) {
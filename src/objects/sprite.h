@@ -40,6 +40,7 @@ class _Sprite : public ae::_BaseObject {
 
 		// Collision
 		bool CheckCircle(const glm::vec2 &Position, float Radius, glm::vec2 &Normal, float &Penetration, bool &AxisAlignedPush) const;
+		static bool CheckCircle(const glm::vec2 &Center, const glm::vec2 &HalfSize, bool IsAABB, const glm::vec2 &Position, float Radius, glm::vec2 &Normal, float &Penetration, bool &AxisAlignedPush);
 
 		// Attributes
 		std::string Name;
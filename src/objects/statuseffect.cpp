@@ -41,6 +41,8 @@ _StatusEffect::_StatusEffect() :
 	Time(0.0),
 	Duration(0.0),
 	MaxDuration(0.0),
+	TimerStart(0.0),
+	TimerID(0),
 	Level(0),
 	Priority(0),
 	Infinite(false),
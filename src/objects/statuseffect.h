@@ -20,6 +20,7 @@
 // Libraries
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
+#include <cstdint>
 
 // Forward Declarations
 class _Buff;
@@ -53,6 +54,8 @@ class _StatusEffect {
 		double Time;
 		double Duration;
 		double MaxDuration;
+		double TimerStart;
+		uint32_t TimerID;
 		int Level;
 		int Priority;
 		bool Infinite;
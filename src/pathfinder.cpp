@@ -0,0 +1,318 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <pathfinder.h>
+#include <objects/map.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+
+// Manhattan distance between two positions
+static uint32_t GetDistance(const glm::ivec2 &Start, const glm::ivec2 &End) {
+	return (uint32_t)(std::abs(Start.x - End.x) + std::abs(Start.y - End.y));
+}
+
+// Return true if a key is in the list
+static bool HasKey(const std::vector<uint32_t> &Keys, uint32_t KeyID) {
+	return std::find(Keys.begin(), Keys.end(), KeyID) != Keys.end();
+}
+
+// Copy walkability from a map and find regions
+_PathGrid::_PathGrid(const _Map *Map) :
+	Size(Map->Size),
+	RegionCount(0),
+	BuildTime(0.0) {
+
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+
+	// Copy tiles
+	std::size_t TileCount = (std::size_t)(Size.x * Size.y);
+	Tiles.resize(TileCount);
+	KeyIDs.resize(TileCount);
+	for(std::size_t i = 0; i < TileCount; i++) {
+		const _HotTile &Tile = Map->HotTiles[i];
+		if(Tile.EventType == _Map::EVENT_KEY) {
+			Tiles[i] = TILE_KEY;
+			KeyIDs[i] = Map->EventData[i];
+		}
+		else
+			Tiles[i] = Tile.IsWall() ? TILE_WALL : TILE_OPEN;
+	}
+
+	BuildRegions();
+
+	BuildTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+}
+
+// Constructor
+_Pathfinder::_Pathfinder() :
+	Expanded(0),
+	Generation(0) {
+}
+
+// Find a path between two positions, storing tile indices from start to end
+int _Pathfinder::Solve(const _PathGrid &Grid, const glm::ivec2 &Start, const glm::ivec2 &End, std::vector<int> &Path, const std::vector<uint32_t> &Keys) {
+	Path.clear();
+	Expanded = 0;
+	if(!Grid.IsValidPosition(Start) || !Grid.IsValidPosition(End))
+		return NO_SOLUTION;
+
+	if(Start == End)
+		return START_END_SAME;
+
+	// Reject goals in unreachable regions
+	if(!Grid.CanReach(Start, End, Keys))
+		return NO_SOLUTION;
+
+	StartSearch((std::size_t)(Grid.Size.x * Grid.Size.y));
+
+	// Pop lowest estimate first, preferring deeper nodes on ties
+	auto Compare = [](const _OpenNode &Left, const _OpenNode &Right) {
+		return Left.Estimate > Right.Estimate || (Left.Estimate == Right.Estimate && Left.Cost < Right.Cost);
+	};
+
+	// Add start node
+	int StartIndex = Grid.GetIndex(Start);
+	int EndIndex = Grid.GetIndex(End);
+	Nodes[(std::size_t)StartIndex] = { Generation, -1, 0, false };
+	OpenList.push_back({ GetDistance(Start, End), 0, StartIndex });
+
+	glm::ivec2 Directions[4] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+	while(!OpenList.empty()) {
+		std::pop_heap(OpenList.begin(), OpenList.end(), Compare);
+		_OpenNode Current = OpenList.back();
+		OpenList.pop_back();
+
+		// Skip stale entries
+		_Node &Node = Nodes[(std::size_t)Current.Index];
+		if(Node.Closed || Current.Cost != Node.Cost)
+			continue;
+
+		Node.Closed = true;
+		Expanded++;
+
+		// Build path from parents
+		if(Current.Index == EndIndex) {
+			for(int Index = EndIndex; Index != -1; Index = Nodes[(std::size_t)Index].Parent)
+				Path.push_back(Index);
+			std::reverse(Path.begin(), Path.end());
+
+			return SOLVED;
+		}
+
+		// Add neighbors
+		glm::ivec2 Position(Current.Index % Grid.Size.x, Current.Index / Grid.Size.x);
+		uint32_t NewCost = Current.Cost + 1;
+		for(const auto &Direction : Directions) {
+			glm::ivec2 NewPosition = Position + Direction;
+			if(!Grid.IsPassable(NewPosition, Keys))
+				continue;
+
+			int NewIndex = Grid.GetIndex(NewPosition);
+			_Node &Neighbor = Nodes[(std::size_t)NewIndex];
+			if(Neighbor.Generation == Generation && (Neighbor.Closed || Neighbor.Cost <= NewCost))
+				continue;
+
+			Neighbor = { Generation, Current.Index, NewCost, false };
+			OpenList.push_back({ NewCost + GetDistance(NewPosition, End), NewCost, NewIndex });
+			std::push_heap(OpenList.begin(), OpenList.end(), Compare);
+		}
+	}
+
+	return NO_SOLUTION;
+}
+
+// Estimate bytes used by search state
+std::size_t _Pathfinder::GetMemoryUsage() const {
+	return sizeof(_Pathfinder) + Nodes.capacity() * sizeof(_Node) + OpenList.capacity() * sizeof(_OpenNode);
+}
+
+// Invalidate node state from the previous search
+void _Pathfinder::StartSearch(std::size_t TileCount) {
+	OpenList.clear();
+
+	// Allocate nodes on first use
+	if(Nodes.size() != TileCount) {
+		Nodes.assign(TileCount, { 0, -1, 0, false });
+		Generation = 0;
+	}
+
+	// Clear stamps when generation wraps
+	Generation++;
+	if(Generation == 0) {
+		for(auto &Node : Nodes)
+			Node.Generation = 0;
+		Generation = 1;
+	}
+}
+
+// Estimate bytes used by grid
+std::size_t _PathGrid::GetMemoryUsage() const {
+	std::size_t Bytes = sizeof(_PathGrid) + Tiles.capacity() + KeyIDs.capacity() * sizeof(uint32_t);
+	Bytes += (Regions.capacity() + RegionKeys.capacity() + Groups.capacity()) * sizeof(uint32_t);
+	for(const auto &Links : RegionLinks)
+		Bytes += sizeof(Links) + Links.capacity() * sizeof(uint32_t);
+
+	return Bytes;
+}
+
+// Find connected areas of walkable tiles
+void _PathGrid::BuildRegions() {
+	std::size_t TileCount = (std::size_t)(Size.x * Size.y);
+	Regions.assign(TileCount, 0);
+	RegionKeys.assign(1, 0);
+	RegionLinks.assign(1, std::vector<uint32_t>());
+	RegionCount = 0;
+
+	// Flood fill open tiles, giving each key tile a region of its own
+	for(std::size_t i = 0; i < TileCount; i++) {
+		if(Regions[i])
+			continue;
+
+		if(Tiles[i] == TILE_KEY) {
+			Regions[i] = ++RegionCount;
+			RegionKeys.push_back(KeyIDs[i]);
+			RegionLinks.emplace_back();
+		}
+		else if(Tiles[i] == TILE_OPEN) {
+			++RegionCount;
+			RegionKeys.push_back(0);
+			RegionLinks.emplace_back();
+			FloodRegion((int)i, RegionCount);
+		}
+	}
+
+	// Link key regions to their neighbors
+	Groups.resize(RegionCount + 1);
+	std::iota(Groups.begin(), Groups.end(), 0);
+	glm::ivec2 Directions[2] = { { 1, 0 }, { 0, 1 } };
+	for(int j = 0; j < Size.y; j++) {
+		for(int i = 0; i < Size.x; i++) {
+			uint32_t Region = Regions[(std::size_t)GetIndex(glm::ivec2(i, j))];
+			if(!Region)
+				continue;
+
+			for(const auto &Direction : Directions) {
+				glm::ivec2 Neighbor = glm::ivec2(i, j) + Direction;
+				if(!IsValidPosition(Neighbor))
+					continue;
+
+				uint32_t NeighborRegion = Regions[(std::size_t)GetIndex(Neighbor)];
+				if(!NeighborRegion || NeighborRegion == Region)
+					continue;
+
+				std::vector<uint32_t> &Links = RegionLinks[Region];
+				if(std::find(Links.begin(), Links.end(), NeighborRegion) == Links.end()) {
+					Links.push_back(NeighborRegion);
+					RegionLinks[NeighborRegion].push_back(Region);
+				}
+
+				Groups[FindGroup(Region)] = FindGroup(NeighborRegion);
+			}
+		}
+	}
+
+	// Point every region at its group root
+	for(uint32_t i = 0; i <= RegionCount; i++)
+		Groups[i] = FindGroup(i);
+}
+
+// Return true if a path can exist between two positions with a set of keys
+bool _PathGrid::CanReach(const glm::ivec2 &Start, const glm::ivec2 &End, const std::vector<uint32_t> &Keys) const {
+	if(!IsValidPosition(Start) || !IsValidPosition(End))
+		return false;
+
+	uint32_t StartRegion = Regions[(std::size_t)GetIndex(Start)];
+	uint32_t EndRegion = Regions[(std::size_t)GetIndex(End)];
+	if(!StartRegion || !EndRegion || Groups[StartRegion] != Groups[EndRegion])
+		return false;
+
+	if(StartRegion == EndRegion)
+		return true;
+
+	// Search regions, only entering key regions with the key
+	std::vector<bool> Visited(RegionCount + 1, false);
+	std::vector<uint32_t> Stack = { StartRegion };
+	Visited[StartRegion] = true;
+	while(!Stack.empty()) {
+		uint32_t Region = Stack.back();
+		Stack.pop_back();
+		for(uint32_t Neighbor : RegionLinks[Region]) {
+			if(Visited[Neighbor])
+				continue;
+
+			if(RegionKeys[Neighbor] && !HasKey(Keys, RegionKeys[Neighbor]))
+				continue;
+
+			if(Neighbor == EndRegion)
+				return true;
+
+			Visited[Neighbor] = true;
+			Stack.push_back(Neighbor);
+		}
+	}
+
+	return false;
+}
+
+// Return true if a position can be walked on
+bool _PathGrid::IsPassable(const glm::ivec2 &Position, const std::vector<uint32_t> &Keys) const {
+	if(!IsValidPosition(Position))
+		return false;
+
+	std::size_t Index = (std::size_t)GetIndex(Position);
+	if(Tiles[Index] == TILE_KEY)
+		return HasKey(Keys, KeyIDs[Index]);
+
+	return Tiles[Index] == TILE_OPEN;
+}
+
+// Assign a region to all open tiles connected to a tile
+void _PathGrid::FloodRegion(int Index, uint32_t Region) {
+	std::vector<int> Stack = { Index };
+	Regions[(std::size_t)Index] = Region;
+	glm::ivec2 Directions[4] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+	while(!Stack.empty()) {
+		int Current = Stack.back();
+		Stack.pop_back();
+
+		glm::ivec2 Position(Current % Size.x, Current / Size.x);
+		for(const auto &Direction : Directions) {
+			glm::ivec2 NewPosition = Position + Direction;
+			if(!IsValidPosition(NewPosition))
+				continue;
+
+			int NewIndex = GetIndex(NewPosition);
+			if(Regions[(std::size_t)NewIndex] || Tiles[(std::size_t)NewIndex] != TILE_OPEN)
+				continue;
+
+			Regions[(std::size_t)NewIndex] = Region;
+			Stack.push_back(NewIndex);
+		}
+	}
+}
+
+// Find root region of a group
+uint32_t _PathGrid::FindGroup(uint32_t Region) {
+	while(Groups[Region] != Region) {
+		Groups[Region] = Groups[Groups[Region]];
+		Region = Groups[Region];
+	}
+
+	return Region;
+}
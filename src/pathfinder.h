@@ -0,0 +1,112 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <glm/vec2.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Forward Declarations
+class _Map;
+
+// Immutable walkability snapshot of a map, safe to share between threads
+class _PathGrid {
+
+	public:
+
+		enum TileType : uint8_t {
+			TILE_OPEN,
+			TILE_WALL,
+			TILE_KEY,
+		};
+
+		_PathGrid(const _Map *Map);
+
+		bool IsValidPosition(const glm::ivec2 &Position) const { return Position.x >= 0 && Position.y >= 0 && Position.x < Size.x && Position.y < Size.y; }
+		int GetIndex(const glm::ivec2 &Position) const { return Position.y * Size.x + Position.x; }
+		bool IsPassable(const glm::ivec2 &Position, const std::vector<uint32_t> &Keys) const;
+		bool CanReach(const glm::ivec2 &Start, const glm::ivec2 &End, const std::vector<uint32_t> &Keys) const;
+		std::size_t GetMemoryUsage() const;
+
+		// Attributes
+		glm::ivec2 Size;
+		uint32_t RegionCount;
+		double BuildTime;
+
+	private:
+
+		void BuildRegions();
+		void FloodRegion(int Index, uint32_t Region);
+		uint32_t FindGroup(uint32_t Region);
+
+		// Tiles
+		std::vector<uint8_t> Tiles;
+		std::vector<uint32_t> KeyIDs;
+
+		// Connected walkable tiles, key tiles get their own region
+		std::vector<uint32_t> Regions;
+		std::vector<uint32_t> RegionKeys;
+		std::vector<std::vector<uint32_t>> RegionLinks;
+		std::vector<uint32_t> Groups;
+
+};
+
+// A* path finding for 4-connected tile maps
+class _Pathfinder {
+
+	public:
+
+		enum ResultType {
+			SOLVED,
+			NO_SOLUTION,
+			START_END_SAME,
+		};
+
+		_Pathfinder();
+
+		int Solve(const _PathGrid &Grid, const glm::ivec2 &Start, const glm::ivec2 &End, std::vector<int> &Path, const std::vector<uint32_t> &Keys);
+		std::size_t GetMemoryUsage() const;
+
+		// Stats
+		uint32_t Expanded;
+
+	private:
+
+		struct _Node {
+			uint32_t Generation;
+			int Parent;
+			uint32_t Cost;
+			bool Closed;
+		};
+
+		struct _OpenNode {
+			uint32_t Estimate;
+			uint32_t Cost;
+			int Index;
+		};
+
+		void StartSearch(std::size_t TileCount);
+
+		// Search state, reused between solves
+		std::vector<_Node> Nodes;
+		std::vector<_OpenNode> OpenList;
+		uint32_t Generation;
+
+};
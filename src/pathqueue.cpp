@@ -0,0 +1,136 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <pathqueue.h>
+#include <pathfinder.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <algorithm>
+
+// Constructor
+_PathQueue::_PathQueue(int ThreadCount) :
+	NextRequest(Requests.end()),
+	Tick(0),
+	RequestCount(0),
+	Done(false) {
+
+	ResetStats();
+	for(int i = 0; i < ThreadCount; i++)
+		Threads.emplace_back(&_PathQueue::Run, this);
+}
+
+// Destructor
+_PathQueue::~_PathQueue() {
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Done = true;
+	}
+	Condition.notify_all();
+
+	for(auto &Thread : Threads)
+		Thread.join();
+}
+
+// Queue a path request for delivery in PATH_DELIVER_TICKS ticks, return its id or 0 if the queue is full
+uint64_t _PathQueue::Submit(std::shared_ptr<const _PathGrid> Grid, const glm::ivec2 &Start, const glm::ivec2 &End, const std::vector<uint32_t> &Keys, PathCallbackType Callback) {
+	uint64_t RequestID;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if(Requests.size() >= PATH_QUEUE_MAX) {
+			Rejected++;
+			return 0;
+		}
+
+		RequestID = ++RequestCount;
+		Requests.push_back({ Grid, Start, End, Keys, Callback, SDL_GetPerformanceCounter(), Tick + PATH_DELIVER_TICKS, RequestID, 0, {}, 0.0, false });
+		if(NextRequest == Requests.end())
+			NextRequest = std::prev(Requests.end());
+
+		MaxDepth = std::max(MaxDepth, Requests.size());
+		Submitted++;
+	}
+	Condition.notify_one();
+
+	return RequestID;
+}
+
+// Run callbacks for finished requests that are due in submit order, up to budget per call
+void _PathQueue::Update(std::size_t Budget) {
+	Tick++;
+
+	// Take finished requests without waiting, an unfinished one holds itself and later requests until a later tick
+	std::list<_PathRequest> Finished;
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		while(!Requests.empty() && Requests.front().DeliverTick <= Tick && Requests.front().Finished && Finished.size() < Budget)
+			Finished.splice(Finished.end(), Requests, Requests.begin());
+
+		if(!Requests.empty() && Requests.front().DeliverTick <= Tick && !Requests.front().Finished)
+			Deferred++;
+	}
+
+	uint64_t Time = SDL_GetPerformanceCounter();
+	for(auto &Request : Finished) {
+		double Latency = (Time - Request.SubmitTime) / (double)SDL_GetPerformanceFrequency();
+		TotalLatency += Latency;
+		MaxLatency = std::max(MaxLatency, Latency);
+		TotalSolveTime += Request.SolveTime;
+		Delivered++;
+
+		Request.Callback(Request.RequestID, Request.Result, Request.Path);
+	}
+}
+
+// Reset stats
+void _PathQueue::ResetStats() {
+	std::lock_guard<std::mutex> Lock(Mutex);
+	Submitted = 0;
+	Rejected = 0;
+	Delivered = 0;
+	Deferred = 0;
+	MaxDepth = 0;
+	TotalLatency = 0.0;
+	MaxLatency = 0.0;
+	TotalSolveTime = 0.0;
+}
+
+// Thread loop
+void _PathQueue::Run() {
+	_Pathfinder Pathfinder;
+	while(true) {
+
+		// Take next request, it stays in the list until delivered
+		_PathRequest *Request;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this] { return Done || NextRequest != Requests.end(); });
+			if(Done)
+				return;
+
+			Request = &*NextRequest;
+			++NextRequest;
+		}
+
+		// Solve against snapshot
+		Uint64 StartTime = SDL_GetPerformanceCounter();
+		Request->Result = Pathfinder.Solve(*Request->Grid, Request->Start, Request->End, Request->Path, Request->Keys);
+		Request->SolveTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Request->Finished = true;
+	}
+}
@@ -0,0 +1,92 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <glm/vec2.hpp>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <list>
+#include <cstdint>
+
+// Forward Declarations
+class _PathGrid;
+
+// Called from Update on the server thread with the request id, solve result and path of tile indices
+typedef std::function<void(uint64_t RequestID, int Result, const std::vector<int> &Path)> PathCallbackType;
+
+// Solves path requests on worker threads, delivering finished requests in submit order from a fixed tick after submit
+class _PathQueue {
+
+	public:
+
+		_PathQueue(int ThreadCount);
+		~_PathQueue();
+
+		uint64_t Submit(std::shared_ptr<const _PathGrid> Grid, const glm::ivec2 &Start, const glm::ivec2 &End, const std::vector<uint32_t> &Keys, PathCallbackType Callback);
+		void Update(std::size_t Budget);
+		void ResetStats();
+
+		// Stats
+		std::size_t Submitted;
+		std::size_t Rejected;
+		std::size_t Delivered;
+		std::size_t Deferred;
+		std::size_t MaxDepth;
+		double TotalLatency;
+		double MaxLatency;
+		double TotalSolveTime;
+
+	private:
+
+		struct _PathRequest {
+			std::shared_ptr<const _PathGrid> Grid;
+			glm::ivec2 Start;
+			glm::ivec2 End;
+			std::vector<uint32_t> Keys;
+			PathCallbackType Callback;
+			uint64_t SubmitTime;
+			uint64_t DeliverTick;
+			uint64_t RequestID;
+
+			// Result
+			int Result;
+			std::vector<int> Path;
+			double SolveTime;
+			bool Finished;
+		};
+
+		void Run();
+
+		// Requests in submit order, NextRequest is the first one not taken by a worker
+		std::list<_PathRequest> Requests;
+		std::list<_PathRequest>::iterator NextRequest;
+		uint64_t Tick;
+		uint64_t RequestCount;
+
+		// Threading
+		std::vector<std::thread> Threads;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		bool Done;
+
+};
@@ -0,0 +1,75 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Lock-free single producer, single consumer queue
+template<class T> class _RingBuffer {
+
+	public:
+
+		_RingBuffer(std::size_t Capacity) : Head(0), Tail(0) {
+
+			// Round capacity up to a power of two
+			std::size_t Size = 1;
+			while(Size < Capacity)
+				Size <<= 1;
+
+			Items.resize(Size);
+			Mask = Size - 1;
+		}
+
+		// Add item from producer thread, return false if full
+		bool Push(T &&Item) {
+			std::size_t CurrentTail = Tail.load(std::memory_order_relaxed);
+			if(CurrentTail - Head.load(std::memory_order_acquire) > Mask)
+				return false;
+
+			Items[CurrentTail & Mask] = std::move(Item);
+			Tail.store(CurrentTail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Remove item from consumer thread, return false if empty
+		bool Pop(T &Item) {
+			std::size_t CurrentHead = Head.load(std::memory_order_relaxed);
+			if(CurrentHead == Tail.load(std::memory_order_acquire))
+				return false;
+
+			Item = std::move(Items[CurrentHead & Mask]);
+			Head.store(CurrentHead + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Approximate number of queued items
+		std::size_t Size() const { return Tail.load(std::memory_order_acquire) - Head.load(std::memory_order_acquire); }
+
+	private:
+
+		std::vector<T> Items;
+		std::size_t Mask;
+		alignas(64) std::atomic<std::size_t> Head;
+		alignas(64) std::atomic<std::size_t> Tail;
+
+};
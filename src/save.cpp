@@ -37,11 +37,13 @@
 #include <algorithm>
 
 // Constructor
-_Save::_Save() :
+_Save::_Save(const std::string &Path) :
+	SavePath(Path),
 	Secret(0),
 	Clock(0) {
 
-	std::string SavePath = Config.ConfigPath + "save.db";
+	if(SavePath.empty())
+		SavePath = Config.ConfigPath + "save.db";
 
 	// Open file
 	Database = new ae::_Database(SavePath);
@@ -36,7 +36,7 @@ class _Save {
 
 	public:
 
-		_Save();
+		_Save(const std::string &Path="");
 		~_Save();
 
 		ae::_Database *Database;
@@ -68,6 +68,7 @@ class _Save {
 		void LoadPlayer(_Object *Player);
 
 		// State
+		std::string SavePath;
 		uint64_t Secret;
 		double Clock;
 
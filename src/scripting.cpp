@@ -33,6 +33,8 @@
 #include <objects/components/controller.h>
 #include <objects/map.h>
 #include <server.h>
+#include <navigation.h>
+#include <botbrain.h>
 #include <stats.h>
 #include <stdexcept>
 #include <iostream>
@@ -48,12 +50,6 @@ luaL_Reg _Scripting::AudioFunctions[] = {
 	{nullptr, nullptr}
 };
 
-int luaopen_Random(lua_State *LuaState) {
-	luaL_newlib(LuaState, _Scripting::RandomFunctions);
-
-	return 1;
-}
-
 int luaopen_Audio(lua_State *LuaState) {
 	luaL_newlib(LuaState, _Scripting::AudioFunctions);
 
@@ -62,14 +58,22 @@ int luaopen_Audio(lua_State *LuaState) {
 
 // Constructor
 _Scripting::_Scripting() :
+	PushedObjects(0),
+	Random(nullptr),
+	Navigation(nullptr),
 	LuaState(nullptr),
 	CurrentTableIndex(0) {
 
 	// Initialize lua object
 	LuaState = luaL_newstate();
 	luaL_openlibs(LuaState);
-	luaL_requiref(LuaState, "Random", luaopen_Random, 1);
 	luaL_requiref(LuaState, "Audio", luaopen_Audio, 1);
+
+	// Random library reaches the active stream through an upvalue
+	luaL_newlibtable(LuaState, RandomFunctions);
+	lua_pushlightuserdata(LuaState, this);
+	luaL_setfuncs(LuaState, RandomFunctions, 1);
+	lua_setglobal(LuaState, "Random");
 }
 
 // Destructor
@@ -423,6 +427,7 @@ void _Scripting::PushObject(_Object *Object) {
 	}
 
 	lua_newtable(LuaState);
+	PushedObjects++;
 
 	// Push object attributes
 	for(const auto &Attribute : Object->Stats->Attributes) {
@@ -513,6 +518,11 @@ void _Scripting::PushObject(_Object *Object) {
 	lua_pushcclosure(LuaState, &ObjectFindEvent, 1);
 	lua_setfield(LuaState, -2, "FindEvent");
 
+	lua_pushlightuserdata(LuaState, Object);
+	lua_pushlightuserdata(LuaState, (void *)Navigation);
+	lua_pushcclosure(LuaState, &ObjectNextMapHop, 2);
+	lua_setfield(LuaState, -2, "NextMapHop");
+
 	lua_pushlightuserdata(LuaState, Object);
 	lua_pushcclosure(LuaState, &ObjectGetTileEvent, 1);
 	lua_setfield(LuaState, -2, "GetTileEvent");
@@ -765,6 +775,25 @@ void _Scripting::PushObjectList(std::vector<_Object *> &Objects) {
 	}
 }
 
+// Push list of monsters ready for an action, as indexes into the ally list and their AI table names
+void _Scripting::PushReadyMonsters(const std::vector<_Object *> &Allies, const std::vector<int> &Indices) {
+	lua_newtable(LuaState);
+
+	int Index = 1;
+	for(const auto &AllyIndex : Indices) {
+		lua_newtable(LuaState);
+
+		lua_pushinteger(LuaState, AllyIndex + 1);
+		lua_setfield(LuaState, -2, "Index");
+
+		lua_pushstring(LuaState, Allies[AllyIndex]->Monster->AI.c_str());
+		lua_setfield(LuaState, -2, "AI");
+
+		lua_rawseti(LuaState, -2, Index);
+		Index++;
+	}
+}
+
 // Push list of object's current status effects
 void _Scripting::PushObjectStatusEffects(_Object *Object) {
 	lua_newtable(LuaState);
@@ -998,6 +1027,51 @@ void _Scripting::GetSummons(int Index, std::vector<_Summon> &Summons) {
 	}
 }
 
+// Get vendor maps and the first build from bot.lua
+void _Scripting::GetBotData(_BotData &BotData) {
+
+	// Get map of each vendor
+	lua_getglobal(LuaState, "Vendors");
+	if(!lua_istable(LuaState, -1))
+		throw std::runtime_error("GetBotData: Vendors is not a table!");
+
+	lua_pushnil(LuaState);
+	while(lua_next(LuaState, -2) != 0) {
+		BotData.VendorMaps[(uint32_t)lua_tointeger(LuaState, -2)] = (uint32_t)lua_tointeger(LuaState, -1);
+		lua_pop(LuaState, 1);
+	}
+	lua_pop(LuaState, 1);
+
+	// Get item progression, keep the order pairs() visits slots in
+	lua_getglobal(LuaState, "Builds");
+	if(!lua_istable(LuaState, -1))
+		throw std::runtime_error("GetBotData: Builds is not a table!");
+
+	lua_rawgeti(LuaState, -1, 1);
+	lua_getfield(LuaState, -1, "Items");
+	if(!lua_istable(LuaState, -1))
+		throw std::runtime_error("GetBotData: Builds[1].Items is not a table!");
+
+	lua_pushnil(LuaState);
+	while(lua_next(LuaState, -2) != 0) {
+		_BotBuildSlot BuildSlot;
+		BuildSlot.Slot = (std::size_t)lua_tointeger(LuaState, -2);
+
+		// Get ItemID, VendorID pairs
+		for(int i = 1; i <= (int)lua_rawlen(LuaState, -1); i++) {
+			lua_rawgeti(LuaState, -1, i);
+			lua_rawgeti(LuaState, -1, 1);
+			lua_rawgeti(LuaState, -2, 2);
+			BuildSlot.Items.push_back(std::make_pair((uint32_t)lua_tointeger(LuaState, -2), (uint32_t)lua_tointeger(LuaState, -1)));
+			lua_pop(LuaState, 3);
+		}
+
+		BotData.Build.push_back(BuildSlot);
+		lua_pop(LuaState, 1);
+	}
+	lua_pop(LuaState, 3);
+}
+
 // Get attribute value from lua
 void _Scripting::GetValue(StatValueType Type, _Value &Value) {
 	switch(Type) {
@@ -1068,12 +1142,22 @@ void _Scripting::FinishMethodCall() {
 	lua_settop(LuaState, CurrentTableIndex - 1);
 }
 
+// Get active random stream
+std::mt19937 &_Scripting::GetRandom() {
+	if(Random)
+		return *Random;
+
+	return ae::RandomGenerator;
+}
+
 // Random.GetInt(min, max)
 int _Scripting::RandomGetInt(lua_State *LuaState) {
+	_Scripting *Scripting = (_Scripting *)lua_touserdata(LuaState, lua_upvalueindex(1));
 	int Min = (int)lua_tointeger(LuaState, 1);
 	int Max = (int)lua_tointeger(LuaState, 2);
 
-	lua_pushinteger(LuaState, ae::GetRandomInt(Min, Max));
+	std::uniform_int_distribution<int> Distribution(Min, Max);
+	lua_pushinteger(LuaState, Distribution(Scripting->GetRandom()));
 
 	return 1;
 }
@@ -1295,6 +1379,30 @@ int _Scripting::ObjectFindEvent(lua_State *LuaState) {
 	return 2;
 }
 
+// Return the next map on the shortest route to a map
+int _Scripting::ObjectNextMapHop(lua_State *LuaState) {
+
+	_Object *Object = (_Object *)lua_touserdata(LuaState, lua_upvalueindex(1));
+	const _Navigation *Navigation = (const _Navigation *)lua_touserdata(LuaState, lua_upvalueindex(2));
+	uint32_t TargetMapID = (uint32_t)lua_tointeger(LuaState, 1);
+	if(!Object->Map || !Navigation)
+		return 0;
+
+	// Return 0 while routes are still building
+	if(!Navigation->IsReady()) {
+		lua_pushinteger(LuaState, 0);
+		return 1;
+	}
+
+	uint32_t NextMapID = Navigation->GetNextHop(Object->GetMapID(), TargetMapID);
+	if(!NextMapID)
+		return 0;
+
+	lua_pushinteger(LuaState, NextMapID);
+
+	return 1;
+}
+
 // Return an event from a tile position
 int _Scripting::ObjectGetTileEvent(lua_State *LuaState) {
 
@@ -1305,7 +1413,7 @@ int _Scripting::ObjectGetTileEvent(lua_State *LuaState) {
 	if(!Object->Map)
 		return 0;
 
-	const _Event &Event = Object->Map->GetTile(glm::ivec2(X, Y))->Event;
+	_Event Event = Object->Map->GetEvent(glm::ivec2(X, Y));
 
 	lua_pushinteger(LuaState, Event.Type);
 	lua_pushinteger(LuaState, Event.Data);
@@ -1323,9 +1431,7 @@ int _Scripting::ObjectGetTileZone(lua_State *LuaState) {
 	if(!Object->Map)
 		return 0;
 
-	const _Tile *Tile = Object->Map->GetTile(glm::ivec2(X, Y));
-
-	lua_pushinteger(LuaState, Tile->Zone);
+	lua_pushinteger(LuaState, Object->Map->GetHotTile(glm::ivec2(X, Y)).Zone);
 
 	return 1;
 }
@@ -1394,7 +1500,7 @@ int _Scripting::ObjectVendorExchange(lua_State *LuaState) {
 		_Slot VendorSlot;
 		_Slot TargetSlot;
 		VendorSlot.Index = Object->Character->Vendor->GetSlotFromID(ItemID);
-		Packet.Write<uint8_t>((uint8_t)Amount);
+		Packet.Write<uint16_t>((uint16_t)Amount);
 		VendorSlot.Serialize(Packet);
 		TargetSlot.Serialize(Packet);
 
@@ -1407,10 +1513,10 @@ int _Scripting::ObjectVendorExchange(lua_State *LuaState) {
 		_Slot Slot;
 		Slot.Type = (BagType)lua_tointeger(LuaState, 2);
 		Slot.Index = (std::size_t)lua_tointeger(LuaState, 3);
-		uint8_t Amount = (uint8_t)lua_tointeger(LuaState, 4);
+		int Amount = (int)lua_tointeger(LuaState, 4);
 
 		// Build packet
-		Packet.Write<uint8_t>((uint8_t)Amount);
+		Packet.Write<uint16_t>((uint16_t)Amount);
 		Slot.Serialize(Packet);
 
 		Packet.StartRead();
@@ -1475,7 +1581,8 @@ int _Scripting::ItemGenerateDamage(lua_State *LuaState) {
 	if(!Object)
 		return 0;
 
-	lua_pushinteger(LuaState, ae::GetRandomInt((int)std::floor(Item->GetAttribute("MinDamage", Upgrades)), (int)std::floor(Item->GetAttribute("MaxDamage", Upgrades))) * Object->Character->GetDamagePowerMultiplier(Item->DamageTypeID));
+	std::uniform_int_distribution<int> Distribution((int)std::floor(Item->GetAttribute("MinDamage", Upgrades)), (int)std::floor(Item->GetAttribute("MaxDamage", Upgrades)));
+	lua_pushinteger(LuaState, Distribution(Object->Character->GetRandom()) * Object->Character->GetDamagePowerMultiplier(Item->DamageTypeID));
 
 	return 1;
 }
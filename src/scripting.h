@@ -21,8 +21,10 @@
 #include <objects/statchange.h>
 #include <lua.hpp>
 #include <list>
+#include <random>
 #include <string>
 #include <vector>
+#include <cstdint>
 
 // Forward Declarations
 class _Object;
@@ -31,7 +33,9 @@ class _Item;
 class _Stats;
 class _StatChange;
 class _StatusEffect;
+class _Navigation;
 struct _Summon;
+struct _BotData;
 struct _ActionResult;
 
 // Classes
@@ -61,6 +65,7 @@ class _Scripting {
 		void PushStatChange(_StatChange *StatChange);
 		void PushStatusEffect(_StatusEffect *StatusEffect);
 		void PushObjectList(std::vector<_Object *> &Objects);
+		void PushReadyMonsters(const std::vector<_Object *> &Allies, const std::vector<int> &Indices);
 		void PushObjectStatusEffects(_Object *Object);
 		void PushItemParameters(uint32_t ID, int Chance, int Level, double Duration, int Upgrades, int SetLevel, int MaxSetLevel, int MoreInfo);
 		void PushBoolean(bool Value);
@@ -76,18 +81,30 @@ class _Scripting {
 		void GetActionResult(int Index, _ActionResult &ActionResult);
 		void GetStatChange(int Index, const _Stats *Stats, _StatChange &StatChange);
 		void GetSummons(int Index, std::vector<_Summon> &Summons);
+		void GetBotData(_BotData &BotData);
 		void GetValue(StatValueType Type, _Value &Value);
 
 		bool StartMethodCall(const std::string &TableName, const std::string &Function);
 		void MethodCall(int ParameterCount, int ReturnCount);
 		void FinishMethodCall();
 
+		std::mt19937 &GetRandom();
+
 		static void PrintStack(lua_State *LuaState);
 		static void PrintTable(lua_State *LuaState, int Level=0);
 
 		static luaL_Reg RandomFunctions[];
 		static luaL_Reg AudioFunctions[];
 
+		// Stats
+		uint64_t PushedObjects;
+
+		// Stream used by Random.GetInt, global generator when null
+		std::mt19937 *Random;
+
+		// Routes between maps for Object.NextMapHop
+		const _Navigation *Navigation;
+
 	private:
 
 		static void PushItem(lua_State *LuaState, const _Stats *Stats, const _Item *Item, int Upgrades);
@@ -108,6 +125,7 @@ class _Scripting {
 		static int ObjectGetDamageReduction(lua_State *LuaState);
 		static int ObjectFindPath(lua_State *LuaState);
 		static int ObjectFindEvent(lua_State *LuaState);
+		static int ObjectNextMapHop(lua_State *LuaState);
 		static int ObjectGetTileEvent(lua_State *LuaState);
 		static int ObjectGetTileZone(lua_State *LuaState);
 		static int ObjectGetInputStateFromPath(lua_State *LuaState);
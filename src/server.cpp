@@ -34,6 +34,16 @@
 #include <objects/battle.h>
 #include <objects/minigame.h>
 #include <scripting.h>
+#include <capture.h>
+#include <networkthread.h>
+#include <maploader.h>
+#include <pathfinder.h>
+#include <pathqueue.h>
+#include <minigamequeue.h>
+#include <navigation.h>
+#include <componentpool.h>
+#include <botbrain.h>
+#include <allocationcounter.h>
 #include <save.h>
 #include <packet.h>
 #include <stats.h>
@@ -44,6 +54,7 @@
 #include <enet/enet.h>
 #include <algorithm>
 #include <iomanip>
+#include <sstream>
 #include <regex>
 
 // Function to run the server thread
@@ -53,32 +64,62 @@ static void RunThread(void *Arguments) {
 	_Server *Server = (_Server *)Arguments;
 
 	// Init timer
-	Uint64 Timer = SDL_GetPerformanceCounter();
-	double TimeStepAccumulator = 0.0;
+	double Frequency = (double)SDL_GetPerformanceFrequency();
 	double TimeStep = DEFAULT_TIMESTEP;
+	double Period = TimeStep / Config.TimeScale;
+	double Deadline = SDL_GetPerformanceCounter() / Frequency + Period;
+
+	// Drift stats
+	double DriftTotal = 0.0;
+	double DriftMax = 0.0;
+	double ReportTime = 0.0;
+	int DriftCount = 0;
+	int SkippedSteps = 0;
+
 	while(!Server->Done) {
-		double FrameTime = (SDL_GetPerformanceCounter() - Timer) / (double)SDL_GetPerformanceFrequency();
-		Timer = SDL_GetPerformanceCounter();
+		double Now = SDL_GetPerformanceCounter() / Frequency;
 
-		// Run server
-		TimeStepAccumulator += FrameTime * Config.TimeScale;
-		while(TimeStepAccumulator >= TimeStep) {
-			if(TimeStepAccumulator > DEBUG_STALL_THRESHOLD)
-				Server->Log << "[STALL] TimeStepAccumulator=" << TimeStepAccumulator << std::endl;
+		// Run due steps, capping catch-up after a stall
+		int Steps = 0;
+		while(Now >= Deadline && Steps < SERVER_MAX_CATCHUP_STEPS) {
+			double Drift = Now - Deadline;
+			DriftTotal += Drift;
+			DriftMax = std::max(DriftMax, Drift);
+			DriftCount++;
 
 			Server->Update(TimeStep);
-			TimeStepAccumulator -= TimeStep;
+			Deadline += Period;
+			ReportTime += TimeStep;
+			Steps++;
+		}
+
+		// Drop the rest of a stall instead of spiraling
+		if(Now >= Deadline) {
+			int Skipped = (int)((Now - Deadline) / Period) + 1;
+			Server->Log << "[STALL] Skipped " << Skipped << " steps" << std::endl;
+			SkippedSteps += Skipped;
+			Deadline += Skipped * Period;
 		}
 
-		// Sleep thread
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		// Report deadline drift
+		if(ReportTime >= SERVER_DRIFT_REPORT_PERIOD && DriftCount) {
+			Server->Log << "[TICK_DRIFT] avg_ms=" << DriftTotal * 1000.0 / DriftCount << " max_ms=" << DriftMax * 1000.0 << " skipped=" << SkippedSteps << std::endl;
+			DriftTotal = DriftMax = ReportTime = 0.0;
+			DriftCount = SkippedSteps = 0;
+		}
+
+		// Sleep until next step or handle packets as soon as they arrive
+		if(Server->WaitForEvents(Deadline - SDL_GetPerformanceCounter() / Frequency))
+			Server->HandleNetworkEvents(0.0);
 	}
 }
 
 // Constructor
-_Server::_Server(uint16_t NetworkPort) :
+_Server::_Server(uint16_t NetworkPort, const std::string &SavePath, bool PingSocket) :
 	IsTesting(false),
 	Hardcore(false),
+	NoPVP(false),
+	PingSocket(PingSocket),
 	Done(false),
 	StartShutdownTimer(false),
 	StartDisconnect(false),
@@ -89,13 +130,36 @@ _Server::_Server(uint16_t NetworkPort) :
 	SaveTime(0.0),
 	BotTime(0.0),
 	Network(new ae::_ServerNetwork(Config.MaxClients, NetworkPort)),
+	NetworkUpdateTimer(0.0),
+	NetworkTime(0.0),
+	ServiceTime(0.0),
+	NetworkTicks(0),
+	TickArena(SERVER_ARENA_BLOCK_SIZE),
+	TickAllocations(0),
+	TickAllocationBytes(0),
+	MaxTickAllocations(0),
+	AllocationTicks(0),
+	VisitedObjects(0),
+	UpdatedObjects(0),
+	IdleObjects(0),
+	DormantObjects(0),
+	UpdateTicks(0),
+	MonsterAITurns(0),
+	MonsterAICalls(0),
+	MonsterAIPushes(0),
+	BattleActions(0),
+	TimerWheel(SERVER_TIMER_RESOLUTION),
+	TimerCount(0),
+	NavigationLogged(false),
 	Thread(nullptr),
 	PingPacket(1024) {
 
 	if(!Network->HasConnection())
 		throw std::runtime_error("Unable to start server!");
 
-	Network->CreatePingSocket(DEFAULT_NETWORKPINGPORT);
+	// Replays and benchmarks skip the ping socket so they can run next to a live server
+	if(PingSocket)
+		Network->CreatePingSocket(DEFAULT_NETWORKPINGPORT);
 	Network->SetFakeLag(Config.FakeLag);
 	Network->SetUpdatePeriod(Config.NetworkRate);
 
@@ -103,13 +167,33 @@ _Server::_Server(uint16_t NetworkPort) :
 	MapManager = new ae::_Manager<_Map>();
 	BattleManager = new ae::_Manager<_Battle>();
 	Stats = new _Stats(true);
-	Save = new _Save();
+	Save = new _Save(SavePath);
+	MapLoader = std::make_unique<_MapLoader>();
+	ComponentPool = std::make_unique<_ComponentPool>(Config.ObjectPool);
 
 	Scripting = new _Scripting();
 	Scripting->Setup(Stats, SCRIPTS_GAME);
 
 	Log.Open((Config.LogPath + "server.log").c_str());
 	Log << "[SERVER_START] Listening on port " << NetworkPort << std::endl;
+
+	// Build routes between maps in the background
+	Navigation = std::make_unique<_Navigation>(Stats);
+	Scripting->Navigation = Navigation.get();
+
+	// Warm popular maps
+	PreloadMaps(Config.PreloadMaps);
+
+	// Service network on its own thread
+	if(Config.NetworkThread)
+		NetworkThread = std::make_unique<_NetworkThread>(Network.get(), PingSocket);
+
+	// Solve bot paths on worker threads
+	if(Config.PathThreads > 0)
+		PathQueue = std::make_unique<_PathQueue>(Config.PathThreads);
+
+	// Verify minigame drops on worker threads
+	MinigameQueue = std::make_unique<_MinigameQueue>(std::max(0, Config.MinigameThreads));
 }
 
 // Destructor
@@ -117,6 +201,9 @@ _Server::~_Server() {
 	Done = true;
 	JoinThread();
 
+	// Break promises of queries that will never run
+	Commands.Clear();
+
 	// Save clock
 	Save->SaveSettings();
 
@@ -126,6 +213,12 @@ _Server::~_Server() {
 		Save->SavePlayer(Object, Object->GetMapID(), &Log);
 	Save->EndTransaction();
 
+	// Finish loading before freeing maps
+	Navigation.reset();
+	MapLoader.reset();
+	PathQueue.reset();
+	MinigameQueue.reset();
+
 	delete MapManager;
 	delete BattleManager;
 	delete ObjectManager;
@@ -162,12 +255,43 @@ void _Server::StopServer(int Seconds) {
 	}
 }
 
+// Record inbound network events to a capture file
+void _Server::StartRecording(const std::string &Path) {
+
+	// Save generator state so the capture can be replayed without reseeding the live server
+	std::ostringstream RandomState;
+	RandomState << ae::RandomGenerator;
+
+	// Save flags and config options that change the simulation
+	_CaptureSettings Settings;
+	Settings.IsTesting = IsTesting;
+	Settings.Hardcore = Hardcore;
+	Settings.NoPVP = NoPVP;
+	Settings.NetworkRate = Config.NetworkRate;
+	Settings.AutoSavePeriod = Config.AutoSavePeriod;
+	Settings.MapIdleTimeout = Config.MapIdleTimeout;
+	Settings.BotDecisionPeriod = Config.BotDecisionPeriod;
+	Settings.PathThreads = Config.PathThreads;
+	Settings.PathBudget = Config.PathBudget;
+	Settings.MinigameThreads = Config.MinigameThreads;
+	Settings.ObjectPool = Config.ObjectPool;
+	Settings.UpdateTiers = Config.UpdateTiers;
+	Settings.NativeBots = Config.NativeBots;
+	Settings.BatchMonsterAI = Config.BatchMonsterAI;
+	Settings.PreloadMaps = Config.PreloadMaps;
+
+	Capture = std::make_unique<_Capture>();
+	Capture->StartRecording(Path, RandomState.str(), Settings, Save->SavePath);
+
+	Log << "[CAPTURE] Recording to " << Path << std::endl;
+}
+
 // Create a summon object
 _Object *_Server::CreateSummon(_Object *Source, const _Summon &Summon) {
 
 	// Create monster
 	_Object *Object = ObjectManager->Create();
-	Object->CreateComponents();
+	ComponentPool->CreateComponents(Object);
 	Object->Server = this;
 	Object->Scripting = Scripting;
 	Object->Monster->DatabaseID = Summon.ID;
@@ -211,54 +335,45 @@ _Object *_Server::CreateSummon(_Object *Source, const _Summon &Summon) {
 void _Server::Update(double FrameTime) {
 	//if(std::abs(std::fmod(Time, 1.0)) >= 0.99)
 	//	std::cout << "Server: O=" << ObjectManager->Objects.size() << " B=" << BattleManager->Objects.size() << std::endl;
+	_AllocationCount StartCount = GetAllocationCount();
 
-	// Handle pings
-	ae::_NetworkAddress PingAddress;
-	while(Network->CheckPings(PingPacket, PingAddress)) {
-		PingType Type = PingPacket.Read<PingType>();
-
-		// Handle ping types
-		switch(Type) {
-			case PingType::SERVER_INFO: {
-				ae::_Buffer PongPacket;
-				PongPacket.Write<PingType>(PingType::SERVER_INFO_RESPONSE);
-				PongPacket.Write<uint16_t>(Network->GetListenPort());
-				PongPacket.Write<uint16_t>(Network->GetPeers().size());
-				PongPacket.Write<uint16_t>(Network->GetMaxPeers());
-				PongPacket.WriteBit(Hardcore);
-				Network->SendPingPacket(PongPacket, ae::_NetworkAddress(PingAddress.Host, PingAddress.Port));
-			} break;
-			default:
-			break;
-		}
-
-		// Reset packet
-		PingPacket.StartRead();
+	// Handle pings, the network thread answers them when it owns the host
+	if(NetworkThread) {
+		NetworkThread->PeerCount = (uint16_t)Peers.size();
+		NetworkThread->Hardcore = Hardcore;
+	}
+	else if(PingSocket) {
+		Uint64 ServiceTimer = SDL_GetPerformanceCounter();
+		_NetworkThread::HandlePings(Network.get(), PingPacket, (uint16_t)Peers.size(), Hardcore);
+		ServiceTime += (SDL_GetPerformanceCounter() - ServiceTimer) / (double)SDL_GetPerformanceFrequency();
 	}
-
-	// Update network
-	Network->Update(FrameTime);
 
 	// Get events
-	ae::_NetworkEvent NetworkEvent;
-	while(Network->GetNetworkEvent(NetworkEvent)) {
+	HandleNetworkEvents(FrameTime);
+	NetworkTicks++;
 
-		switch(NetworkEvent.Type) {
-			case ae::_NetworkEvent::CONNECT:
-				HandleConnect(NetworkEvent);
-			break;
-			case ae::_NetworkEvent::DISCONNECT:
-				HandleDisconnect(NetworkEvent);
-			break;
-			case ae::_NetworkEvent::PACKET:
-				HandlePacket(*NetworkEvent.Data, NetworkEvent.Peer);
-				delete NetworkEvent.Data;
-			break;
-		}
+	// Run commands from other threads
+	Commands.Run();
+
+	// Add maps finished loading
+	UpdateMapLoads();
+
+	// Log routes once built
+	if(!NavigationLogged && Navigation->IsReady()) {
+		Log << "[NAVIGATION] maps=" << Navigation->GetMapCount() << " edges=" << Navigation->EdgeCount << " failed=" << Navigation->FailedCount << " time=" << Navigation->BuildTime << std::endl;
+		NavigationLogged = true;
 	}
 
+	// Deliver finished paths
+	if(PathQueue)
+		PathQueue->Update(Config.PathBudget);
+
+	// Deliver minigame prizes
+	MinigameQueue->Update();
+
 	// Update objects
 	ObjectManager->Update(FrameTime);
+	UpdateTicks++;
 
 	// Spawn battles
 	for(auto &BattleEvent : BattleEvents)
@@ -266,6 +381,9 @@ void _Server::Update(double FrameTime) {
 
 	BattleEvents.clear();
 
+	// Unload maps without players
+	UnloadIdleMaps(FrameTime);
+
 	// Update maps
 	MapManager->Update(FrameTime);
 
@@ -273,13 +391,15 @@ void _Server::Update(double FrameTime) {
 	BattleManager->Update(FrameTime);
 
 	// Check if updates should be sent
-	if(Network->NeedsUpdate()) {
-		Network->ResetUpdateTimer();
-		if(Network->GetPeers().size() > 0) {
+	NetworkUpdateTimer += FrameTime;
+	if(NetworkUpdateTimer >= Config.NetworkRate) {
+		NetworkUpdateTimer = 0.0;
+		if(Peers.size() > 0) {
 
 			// Send object updates
 			for(auto &Map : MapManager->Objects) {
-				Map->SendObjectUpdates();
+				if(!Map->Loading)
+					Map->SendObjectUpdates();
 			}
 		}
 	}
@@ -296,26 +416,37 @@ void _Server::Update(double FrameTime) {
 		if(std::abs(std::fmod(ShutdownTime, 5.0)) >= 4.99)
 			BroadcastMessage(nullptr, "The server will be shutting down in " + std::to_string((int)(ShutdownTime + 0.5)) + " seconds", "red");
 
-		if(ShutdownTime <= 0 || !Network->GetPeers().size()) {
+		if(ShutdownTime <= 0 || !Peers.size()) {
 			StartDisconnect = true;
 			StartShutdownTimer = false;
 		}
 	}
 	else if(StartDisconnect) {
-		Network->DisconnectAll(1);
+		DisconnectAll(1);
 		StartDisconnect = false;
 		StartShutdown = true;
 	}
-	else if(StartShutdown && Network->GetPeers().size() == 0) {
+	else if(StartShutdown && Peers.size() == 0) {
 		Done = true;
 	}
 
 	TimeSteps++;
 	Time += FrameTime;
+	if(Capture)
+		Capture->EndTick();
 
 	// Update scripting environment
 	Scripting->InjectTime(Time);
 
+	// Expire timers
+	TimerWheel.Update(Time, ExpiredTimers);
+	for(const auto &Timer : ExpiredTimers) {
+		_Object *Object = ObjectManager->GetObject(Timer.ObjectID);
+		if(Object && Object->Character)
+			Object->Character->ExpireTimer(Timer.Type, Timer.ID);
+	}
+	ExpiredTimers.clear();
+
 	// Update clock
 	Save->Clock += FrameTime * MAP_CLOCK_SPEED;
 	if(Save->Clock >= MAP_DAY_LENGTH)
@@ -331,6 +462,80 @@ void _Server::Update(double FrameTime) {
 		for(auto &Object : ObjectManager->Objects)
 			Save->SavePlayer(Object, Object->GetMapID(), &Log);
 		Save->EndTransaction();
+
+		// Log time spent servicing the host and handling its events
+		if(NetworkThread) {
+			uint64_t ServicePasses = std::max((uint64_t)1, NetworkThread->ServicePasses.exchange(0));
+			uint64_t ThreadTime = NetworkThread->ServiceTime.exchange(0);
+			Log << "[NETWORK_STATS] peers=" << Peers.size() << " threaded=1 service_ms_per_pass=" << ThreadTime / 1000.0 / ServicePasses << " service_passes=" << ServicePasses;
+		}
+		else
+			Log << "[NETWORK_STATS] peers=" << Peers.size() << " threaded=0 service_ms_per_tick=" << ServiceTime * 1000.0 / NetworkTicks;
+		Log << " handle_ms_per_tick=" << NetworkTime * 1000.0 / NetworkTicks << std::endl;
+		NetworkTime = 0.0;
+		ServiceTime = 0.0;
+		NetworkTicks = 0;
+
+		// Warn when the network thread had to wait on full queues
+		if(NetworkThread) {
+			uint64_t EventStalls = NetworkThread->EventStalls.exchange(0);
+			uint64_t CommandStalls = NetworkThread->CommandStalls.exchange(0);
+			if(EventStalls || CommandStalls)
+				Log << "[NETWORK_WARNING] Queues full, raise NETWORK_QUEUE_SIZE event_stalls=" << EventStalls << " command_stalls=" << CommandStalls << std::endl;
+		}
+
+		// Log path finding queue
+		if(PathQueue) {
+			std::size_t Delivered = std::max((std::size_t)1, PathQueue->Delivered);
+			Log << "[PATH_STATS] submitted=" << PathQueue->Submitted << " rejected=" << PathQueue->Rejected << " delivered=" << PathQueue->Delivered << " deferred=" << PathQueue->Deferred << " max_depth=" << PathQueue->MaxDepth;
+			Log << " latency_ms=" << PathQueue->TotalLatency * 1000.0 / Delivered << " max_latency_ms=" << PathQueue->MaxLatency * 1000.0 << " solve_ms=" << PathQueue->TotalSolveTime * 1000.0 / Delivered << std::endl;
+			PathQueue->ResetStats();
+		}
+
+		// Log minigame verification
+		std::size_t MinigamesDelivered = std::max((std::size_t)1, MinigameQueue->Delivered);
+		Log << "[MINIGAME_STATS] threads=" << Config.MinigameThreads << " submitted=" << MinigameQueue->Submitted << " overflowed=" << MinigameQueue->Overflowed << " jobs_per_second=" << MinigameQueue->Delivered / MinigameQueue->GetStatsTime();
+		Log << " latency_ms=" << MinigameQueue->TotalLatency * 1000.0 / MinigamesDelivered << " max_latency_ms=" << MinigameQueue->MaxLatency * 1000.0 << " simulate_ms=" << MinigameQueue->TotalSimulateTime * 1000.0 / MinigamesDelivered << std::endl;
+		MinigameQueue->ResetStats();
+
+		// Log component allocations for battle objects
+		std::size_t Battles = std::max((std::size_t)1, ComponentPool->Battles);
+		Log << "[POOL_STATS] enabled=" << Config.ObjectPool << " battles=" << ComponentPool->Battles << " allocated=" << ComponentPool->Allocated << " reused=" << ComponentPool->Reused << " free=" << ComponentPool->GetFreeCount();
+		Log << " allocated_per_battle=" << ComponentPool->Allocated / (double)Battles << std::endl;
+		ComponentPool->ResetStats();
+
+		// Log heap allocations per tick
+		uint32_t Ticks = std::max((uint32_t)1, AllocationTicks);
+		Log << "[ALLOC_STATS] ticks=" << AllocationTicks << " allocs_per_tick=" << TickAllocations / (double)Ticks << " bytes_per_tick=" << TickAllocationBytes / (double)Ticks << " max_allocs=" << MaxTickAllocations;
+		Log << " arena_max_bytes=" << TickArena.MaxBytesUsed << " arena_capacity=" << TickArena.GetCapacity();
+		Log << " packet_pool_max=" << PacketPool.MaxUsed << " packet_pool_capacity=" << PacketPool.GetCapacity() << std::endl;
+		TickAllocations = 0;
+		TickAllocationBytes = 0;
+		MaxTickAllocations = 0;
+		AllocationTicks = 0;
+		TickArena.MaxBytesUsed = 0;
+		PacketPool.MaxUsed = 0;
+
+		// Log objects updated per tick
+		uint32_t ObjectTicks = std::max((uint32_t)1, UpdateTicks);
+		Log << "[UPDATE_STATS] tiers=" << Config.UpdateTiers << " objects_per_tick=" << VisitedObjects / (double)ObjectTicks << " updated_per_tick=" << UpdatedObjects / (double)ObjectTicks;
+		Log << " idle_per_tick=" << IdleObjects / (double)ObjectTicks << " dormant_per_tick=" << DormantObjects / (double)ObjectTicks << std::endl;
+		VisitedObjects = 0;
+		UpdatedObjects = 0;
+		IdleObjects = 0;
+		DormantObjects = 0;
+		UpdateTicks = 0;
+
+		// Log monster AI script overhead
+		uint64_t AITurns = std::max((uint64_t)1, MonsterAITurns);
+		Log << "[AI_STATS] batch=" << Config.BatchMonsterAI << " turns=" << MonsterAITurns << " calls_per_turn=" << MonsterAICalls / (double)AITurns << " objects_pushed_per_turn=" << MonsterAIPushes / (double)AITurns << " battle_actions=" << BattleActions << std::endl;
+		MonsterAITurns = 0;
+		MonsterAICalls = 0;
+		MonsterAIPushes = 0;
+		BattleActions = 0;
+
+		// Log pending cooldown timers
+		Log << "[TIMER_STATS] pending=" << TimerWheel.Count << std::endl;
 	}
 
 	// Update bot timer
@@ -340,38 +545,158 @@ void _Server::Update(double FrameTime) {
 	// Spawn bot
 	if(IsTesting && BotTime > 1.1) {
 		BotTime = -1;
-		CreateBot();
+		CreateBot(ACCOUNT_BOTS_ID, "bot_test");
+	}
+
+	// Release scratch memory and count heap allocations made this tick
+	TickArena.Reset();
+	PacketPool.Reset();
+	_AllocationCount EndCount = GetAllocationCount();
+	uint64_t Allocations = EndCount.Allocations - StartCount.Allocations;
+	TickAllocations += Allocations;
+	TickAllocationBytes += EndCount.Bytes - StartCount.Bytes;
+	MaxTickAllocations = std::max(MaxTickAllocations, Allocations);
+	AllocationTicks++;
+}
+
+// Handle all pending network events
+void _Server::HandleNetworkEvents(double FrameTime) {
+	// Service host when there's no network thread
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	if(!NetworkThread) {
+		Uint64 ServiceTimer = SDL_GetPerformanceCounter();
+		Network->Update(FrameTime);
+		ServiceTime += (SDL_GetPerformanceCounter() - ServiceTimer) / Frequency;
+	}
+
+	// Handle events
+	Uint64 NetworkTimer = SDL_GetPerformanceCounter();
+	ae::_NetworkEvent NetworkEvent;
+	if(NetworkThread) {
+		while(NetworkThread->GetNetworkEvent(NetworkEvent))
+			HandleNetworkEvent(NetworkEvent);
+	}
+	else {
+		while(Network->GetNetworkEvent(NetworkEvent))
+			HandleNetworkEvent(NetworkEvent);
+	}
+
+	NetworkTime += (SDL_GetPerformanceCounter() - NetworkTimer) / Frequency;
+}
+
+// Wait up to timeout in seconds for network events, return true if any arrived
+bool _Server::WaitForEvents(double Timeout) {
+	if(NetworkThread)
+		return NetworkThread->WaitForEvents(Timeout);
+
+	// Service the host in short slices and handle packets as soon as they arrive
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	double End = SDL_GetPerformanceCounter() / Frequency + Timeout;
+	while(true) {
+		bool Received = false;
+		ae::_NetworkEvent NetworkEvent;
+		Uint64 ServiceTimer = SDL_GetPerformanceCounter();
+		Network->Update(0.0);
+		ServiceTime += (SDL_GetPerformanceCounter() - ServiceTimer) / Frequency;
+		while(Network->GetNetworkEvent(NetworkEvent)) {
+			HandleNetworkEvent(NetworkEvent);
+			Received = true;
+		}
+
+		double Remaining = End - SDL_GetPerformanceCounter() / Frequency;
+		if(Received || Remaining <= 0.0)
+			return Received;
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(std::min(Remaining, SERVER_WAIT_SLICE)));
+	}
+}
+
+// Dispatch a network event
+void _Server::HandleNetworkEvent(ae::_NetworkEvent &Event) {
+	if(Capture)
+		Capture->WriteEvent(Event);
+
+	switch(Event.Type) {
+		case ae::_NetworkEvent::CONNECT:
+			Peers.push_back(Event.Peer);
+			HandleConnect(Event);
+		break;
+		case ae::_NetworkEvent::DISCONNECT:
+			HandleDisconnect(Event);
+		break;
+		case ae::_NetworkEvent::PACKET:
+			HandlePacket(*Event.Data, Event.Peer);
+			delete Event.Data;
+		break;
 	}
 }
 
 // Handle client connect
 void _Server::HandleConnect(ae::_NetworkEvent &Event) {
-	char Buffer[16];
-	ENetAddress *Address = &Event.Peer->ENetPeer->address;
-	enet_address_get_host_ip(Address, Buffer, 16);
-	Log << "[CONNECT] Connect from " << Buffer << ":" << Address->port << std::endl;
+	if(Event.Peer->ENetPeer) {
+		char Buffer[16];
+		ENetAddress *Address = &Event.Peer->ENetPeer->address;
+		enet_address_get_host_ip(Address, Buffer, 16);
+		Log << "[CONNECT] Connect from " << Buffer << ":" << Address->port << std::endl;
+	}
 
 	// Send game version
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::VERSION);
 	Packet.WriteString(GAME_VERSION);
 	Packet.WriteString(BUILD_VERSION);
-	Network->SendPacket(Packet, Event.Peer);
+	SendPacket(Packet, Event.Peer);
 }
 
 // Handle client disconnect
 void _Server::HandleDisconnect(ae::_NetworkEvent &Event) {
-	char Buffer[16];
-	ENetAddress *Address = &Event.Peer->ENetPeer->address;
-	enet_address_get_host_ip(Address, Buffer, 16);
+	if(Event.Peer->ENetPeer) {
+		char Buffer[16];
+		ENetAddress *Address = &Event.Peer->ENetPeer->address;
+		enet_address_get_host_ip(Address, Buffer, 16);
 
-	Log << "[DISCONNECT] " << (Event.EventData ? "Disconnect" : "Timeout") << " from " << Buffer << ":" << Address->port << std::endl;
+		Log << "[DISCONNECT] " << (Event.EventData ? "Disconnect" : "Timeout") << " from " << Buffer << ":" << Address->port << std::endl;
+	}
 
 	ae::_Buffer Data;
 	HandleExit(Data, Event.Peer, Event.EventData);
 
-	// Delete peer from network
-	Network->DeletePeer(Event.Peer);
+	// Delete peer from network, replayed peers are owned by the caller
+	Peers.remove(Event.Peer);
+	if(Event.Peer->ENetPeer)
+		DeletePeer(Event.Peer);
+}
+
+// Send a packet to a peer
+void _Server::SendPacket(ae::_Buffer &Packet, ae::_Peer *Peer, ae::_Network::SendType Type, uint8_t Channel) {
+	if(NetworkThread)
+		NetworkThread->SendPacket(Packet, Peer, Type, Channel);
+	else
+		Network->SendPacket(Packet, Peer, Type, Channel);
+}
+
+// Disconnect a peer
+void _Server::DisconnectPeer(ae::_Peer *Peer, uint32_t Value) {
+	if(NetworkThread)
+		NetworkThread->DisconnectPeer(Peer, Value);
+	else
+		Network->DisconnectPeer(Peer, Value);
+}
+
+// Disconnect all peers
+void _Server::DisconnectAll(uint32_t Value) {
+	if(NetworkThread)
+		NetworkThread->DisconnectAll(Value);
+	else
+		Network->DisconnectAll(Value);
+}
+
+// Remove a peer from the network
+void _Server::DeletePeer(ae::_Peer *Peer) {
+	if(NetworkThread)
+		NetworkThread->DeletePeer(Peer);
+	else
+		Network->DeletePeer(Peer);
 }
 
 // Handle packet data
@@ -502,12 +827,12 @@ void _Server::SendItem(ae::_Peer *Peer, const _Item *Item, int Count) {
 		SendInventoryFullMessage(Peer);
 
 	// Send item
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY_ADD);
 	Packet.Write<uint16_t>((uint16_t)Count);
 	Packet.Write<uint32_t>(Item->ID);
 	Player->Inventory->Serialize(Packet);
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 
 	// Update states
 	Player->Character->CalculateStats();
@@ -535,9 +860,9 @@ void _Server::HandleLoginInfo(ae::_Buffer &Data, ae::_Peer *Peer) {
 
 		// Check for existing account
 		if(Save->CheckUsername(Username)) {
-			ae::_Buffer Packet;
+			ae::_Buffer &Packet = PacketPool.Get();
 			Packet.Write<PacketType>(PacketType::ACCOUNT_EXISTS);
-			Network->SendPacket(Packet, Peer);
+			SendPacket(Packet, Peer);
 			return;
 		}
 		else
@@ -549,7 +874,7 @@ void _Server::HandleLoginInfo(ae::_Buffer &Data, ae::_Peer *Peer) {
 	bool Found = Save->GetAccountInfo(Username, Password, Peer->AccountID, BannedText);
 
 	// Make sure account exists
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	if(Found) {
 
 		// Check for account already being used
@@ -568,7 +893,7 @@ void _Server::HandleLoginInfo(ae::_Buffer &Data, ae::_Peer *Peer) {
 	else
 		Packet.Write<PacketType>(PacketType::ACCOUNT_NOTFOUND);
 
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Sends a player his/her character list
@@ -599,9 +924,9 @@ void _Server::HandleCharacterCreate(ae::_Buffer &Data, ae::_Peer *Peer) {
 
 	// Found an existing name
 	if(Save->GetCharacterIDByName(Name) != 0) {
-		ae::_Buffer NewPacket;
+		ae::_Buffer &NewPacket = PacketPool.Get();
 		NewPacket.Write<PacketType>(PacketType::CREATECHARACTER_INUSE);
-		Network->SendPacket(NewPacket, Peer);
+		SendPacket(NewPacket, Peer);
 		return;
 	}
 
@@ -609,9 +934,9 @@ void _Server::HandleCharacterCreate(ae::_Buffer &Data, ae::_Peer *Peer) {
 	Save->CreateCharacter(Stats, Scripting, Peer->AccountID, Slot, IsHardcore, Name, PortraitID, BuildID);
 
 	// Notify the client
-	ae::_Buffer NewPacket;
+	ae::_Buffer &NewPacket = PacketPool.Get();
 	NewPacket.Write<PacketType>(PacketType::CREATECHARACTER_SUCCESS);
-	Network->SendPacket(NewPacket, Peer);
+	SendPacket(NewPacket, Peer);
 }
 
 // Handle a character delete request
@@ -745,11 +1070,11 @@ void _Server::SendPlayerPosition(ae::_Peer *Peer) {
 
 	_Object *Player = Peer->Object;
 
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::WORLD_POSITION);
 	Packet.Write<glm::ivec2>(Player->Position);
 
-	Network->SendPacket(Packet, Player->Peer);
+	SendPacket(Packet, Player->Peer);
 }
 
 // Send player stats to peer
@@ -760,18 +1085,18 @@ void _Server::SendPlayerInfo(ae::_Peer *Peer) {
 	_Object *Player = Peer->Object;
 
 	// Build packet
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::OBJECT_STATS);
 	Player->SerializeStats(Packet);
 
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Send character list
 void _Server::SendCharacterList(ae::_Peer *Peer) {
 
 	// Create packet
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::CHARACTERS_LIST);
 	Packet.Write<uint8_t>(Hardcore);
 	Packet.Write<uint8_t>((uint8_t)Save->GetCharacterCount(Peer->AccountID));
@@ -796,7 +1121,7 @@ void _Server::SendCharacterList(ae::_Peer *Peer) {
 	Save->Database->CloseQuery();
 
 	// Send list
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Spawns a player at a particular spawn point
@@ -818,16 +1143,17 @@ void _Server::SpawnPlayer(_Object *Player, ae::NetworkIDType MapID, uint32_t Eve
 	else if(Stats->Maps.find(MapID) == Stats->Maps.end() || Stats->Maps.at(MapID).File == "maps/")
 		return;
 
-	// Get map
-	_Map *Map = MapManager->GetObject(MapID);
-
-	// Load map
+	// Get map, holding the player until it finishes loading
+	_Map *Map = LoadMap(MapID);
 	if(!Map) {
-		Map = MapManager->CreateWithID(MapID);
-		Map->Clock = Save->Clock;
-		Map->Server = this;
-		Map->Stats = Stats;
-		Map->Load(&Stats->Maps.at(MapID));
+		HandleMapError(Player, MapID);
+		return;
+	}
+
+	if(Map->Loading) {
+		Player->TransferMapID = MapID;
+		Player->TransferEventType = EventType;
+		return;
 	}
 
 	// Get old map
@@ -861,12 +1187,12 @@ void _Server::SpawnPlayer(_Object *Player, ae::NetworkIDType MapID, uint32_t Eve
 		if(Player->Peer->ENetPeer) {
 
 			// Send new map id
-			ae::_Buffer Packet;
+			ae::_Buffer &Packet = PacketPool.Get();
 			Packet.Write<PacketType>(PacketType::WORLD_CHANGEMAPS);
 			Packet.Write<uint32_t>(MapID);
 			Packet.Write<double>(Save->Clock);
 			Packet.WriteBit(Player->Character->IsAlive());
-			Network->SendPacket(Packet, Player->Peer);
+			SendPacket(Packet, Player->Peer);
 
 			// Send player object list
 			Map->SendObjectList(Player->Peer);
@@ -884,6 +1210,122 @@ void _Server::SpawnPlayer(_Object *Player, ae::NetworkIDType MapID, uint32_t Eve
 	}
 }
 
+// Get a map, starting a background load if it isn't resident
+_Map *_Server::LoadMap(ae::NetworkIDType MapID) {
+	_Map *Map = MapManager->GetObject(MapID);
+	if(Map) {
+		if(Map->LoadFailed)
+			return nullptr;
+
+		// Keep a map that was about to be unloaded
+		if(Map->Deleted) {
+			Log << "[MAP_UNLOAD] Cancelled map_id=" << Map->NetworkID << std::endl;
+			Map->Deleted = false;
+			Map->IdleTime = 0.0;
+		}
+
+		return Map;
+	}
+
+	Map = MapManager->CreateWithID(MapID);
+	Map->Clock = Save->Clock;
+	Map->Server = this;
+	Map->Stats = Stats;
+	Map->Loading = true;
+	MapLoader->Load(Map, &Stats->Maps.at(MapID));
+
+	return Map;
+}
+
+// Start loading a comma separated list of map ids
+void _Server::PreloadMaps(const std::string &MapList) {
+	std::stringstream Stream(MapList);
+	std::string Token;
+	while(std::getline(Stream, Token, ',')) {
+		ae::NetworkIDType MapID = ae::ToNumber<ae::NetworkIDType>(Token);
+		if(Stats->Maps.find(MapID) == Stats->Maps.end() || Stats->Maps.at(MapID).File == "maps/")
+			continue;
+
+		LoadMap(MapID);
+	}
+}
+
+// Handle finished map loads and spawn waiting players
+void _Server::UpdateMapLoads() {
+	_MapLoadResult Result;
+	while(MapLoader->GetResult(Result)) {
+		_Map *Map = Result.Map;
+		Map->Loading = false;
+		if(!Result.Error.empty()) {
+			Log << "[MAP_LOAD] Error loading map_id=" << Map->NetworkID << ": " << Result.Error << std::endl;
+			Map->LoadFailed = true;
+			Map->Deleted = true;
+		}
+		else
+			Log << "[MAP_LOAD] map_id=" << Map->NetworkID << " time=" << Result.Time << " regions=" << Map->GetPathGrid()->RegionCount << " region_time=" << Map->GetPathGrid()->BuildTime << std::endl;
+
+		// Spawn players waiting for map
+		for(auto &Object : ObjectManager->Objects) {
+			if(Object->Deleted || Object->TransferMapID != Map->NetworkID)
+				continue;
+
+			Object->TransferMapID = 0;
+			if(Map->LoadFailed)
+				HandleMapError(Object, Map->NetworkID);
+			else
+				SpawnPlayer(Object, Map->NetworkID, Object->TransferEventType);
+		}
+	}
+}
+
+// Keep a player on their current map or send them to their spawn map when a map fails to load
+void _Server::HandleMapError(_Object *Player, ae::NetworkIDType MapID) {
+	SendMessage(Player->Peer, "Error loading map", "red");
+	if(Player->Map)
+		return;
+
+	// Try spawn map
+	ae::NetworkIDType SpawnMapID = Player->Character->SpawnMapID ? Player->Character->SpawnMapID : 1;
+	if(MapID != SpawnMapID) {
+		SpawnPlayer(Player, 0, _Map::EVENT_SPAWN);
+		return;
+	}
+
+	// Nowhere to go
+	Log << "[MAP_LOAD] Disconnecting character_id=" << Player->Character->CharacterID << " with no map" << std::endl;
+	if(Player->Peer && Player->Peer->ENetPeer)
+		DisconnectPeer(Player->Peer, 0);
+}
+
+// Free maps that have had no objects, battles or incoming players for the idle timeout
+void _Server::UnloadIdleMaps(double FrameTime) {
+
+	// Get maps with battles or players heading to them
+	_ScratchVector<ae::NetworkIDType> BusyMaps(TickArena);
+	for(auto &Object : ObjectManager->Objects) {
+		if(Object->TransferMapID)
+			BusyMaps.push_back(Object->TransferMapID);
+		if(Object->Character && Object->Character->Battle && Object->Map)
+			BusyMaps.push_back(Object->Map->NetworkID);
+	}
+
+	for(auto &Map : MapManager->Objects) {
+		if(Map->Loading || Map->Deleted)
+			continue;
+
+		if(!Map->Objects.empty() || std::find(BusyMaps.begin(), BusyMaps.end(), Map->NetworkID) != BusyMaps.end()) {
+			Map->IdleTime = 0.0;
+			continue;
+		}
+
+		Map->IdleTime += FrameTime;
+		if(Config.MapIdleTimeout > 0.0 && Map->IdleTime >= Config.MapIdleTimeout) {
+			Log << "[MAP_UNLOAD] map_id=" << Map->NetworkID << " bytes=" << Map->GetMemoryUsage() << std::endl;
+			Map->Deleted = true;
+		}
+	}
+}
+
 // Queue a player for rebirth
 void _Server::QueueRebirth(_Object *Object, int Mode, int Type, int Value) {
 	_RebirthEvent RebirthEvent;
@@ -922,10 +1364,10 @@ void _Server::StartTeleport(_Object *Object, double Time) {
 	Object->Character->ResetUIState();
 	Object->Character->TeleportTime = Time;
 
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::WORLD_TELEPORTSTART);
 	Packet.Write<double>(Time);
-	Network->SendPacket(Packet, Object->Peer);
+	SendPacket(Packet, Object->Peer);
 }
 
 // Create player object and load stats from save
@@ -949,11 +1391,11 @@ _Object *_Server::CreatePlayer(ae::_Peer *Peer) {
 }
 
 // Create server side bot
-_Object *_Server::CreateBot() {
+_Object *_Server::CreateBot(uint32_t AccountID, const std::string &Name, uint32_t BuildID) {
 
 	// Check for account being used
 	ae::_Peer TestPeer(nullptr);
-	TestPeer.AccountID = ACCOUNT_BOTS_ID;
+	TestPeer.AccountID = AccountID;
 	if(CheckAccountUse(&TestPeer))
 		return nullptr;
 
@@ -962,11 +1404,9 @@ _Object *_Server::CreateBot() {
 
 	// Check for valid character id
 	bool Muted = false;
-	uint32_t CharacterID = Save->GetCharacterID(ACCOUNT_BOTS_ID, Slot, Muted);
-	if(!CharacterID) {
-		std::string Name = "bot_test";
-		CharacterID = Save->CreateCharacter(Stats, Scripting, ACCOUNT_BOTS_ID, Slot, Hardcore, Name, 1, 1);
-	}
+	uint32_t CharacterID = Save->GetCharacterID(AccountID, Slot, Muted);
+	if(!CharacterID)
+		CharacterID = Save->CreateCharacter(Stats, Scripting, AccountID, Slot, Hardcore, Name, 1, BuildID);
 
 	// Create object
 	_Object *Bot = ObjectManager->Create();
@@ -979,12 +1419,19 @@ _Object *_Server::CreateBot() {
 	Bot->Character->Init();
 	Save->LoadPlayer(Bot);
 	Bot->Character->PartyName = "bot";
+	if(Config.NativeBots) {
+		if(!BotData) {
+			BotData = std::make_unique<_BotData>();
+			Scripting->GetBotData(*BotData);
+		}
+		Bot->BotBrain = new _BotBrain(Bot, BotData.get());
+	}
 
 	// Create fake peer
 	Bot->Peer = new ae::_Peer(nullptr);
 	Bot->Peer->Object = Bot;
 	Bot->Peer->CharacterID = CharacterID;
-	Bot->Peer->AccountID = ACCOUNT_BOTS_ID;
+	Bot->Peer->AccountID = AccountID;
 
 	// Simulate packet
 	ae::_Buffer Packet;
@@ -1012,7 +1459,7 @@ bool _Server::ValidatePeer(ae::_Peer *Peer) {
 
 // Check to see if an account is in use
 bool _Server::CheckAccountUse(ae::_Peer *Peer) {
-	for(auto &CheckPeer : Network->GetPeers()) {
+	for(auto &CheckPeer : Peers) {
 		if(CheckPeer != Peer && CheckPeer->AccountID == Peer->AccountID)
 			return true;
 	}
@@ -1034,10 +1481,10 @@ void _Server::HandleInventoryMove(ae::_Buffer &Data, ae::_Peer *Peer) {
 	NewSlot.Unserialize(Data);
 
 	// Move items
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY_SWAP);
 	if(Player->Inventory->MoveInventory(Packet, OldSlot, NewSlot)) {
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 		Player->Character->CalculateStats();
 	}
 	else
@@ -1066,13 +1513,13 @@ void _Server::HandleInventoryTransfer(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(Player->Inventory->Transfer(SourceSlot, TargetBagType, SlotsUpdated)) {
 
 		// Send inventory update
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 		Packet.Write<uint8_t>(SlotsUpdated.size());
 		for(const auto &Slot : SlotsUpdated)
 			Player->Inventory->SerializeSlot(Packet, Slot);
 
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 
 		// Check for trading players
 		if(SourceSlot.Type == BagType::TRADE || TargetBagType == BagType::TRADE)
@@ -1123,10 +1570,10 @@ void _Server::HandleInventoryUse(ae::_Buffer &Data, ae::_Peer *Peer) {
 		}
 
 		// Attempt to move
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::INVENTORY_SWAP);
 		if(Player->Inventory->MoveInventory(Packet, Slot, TargetSlot)) {
-			Network->SendPacket(Packet, Peer);
+			SendPacket(Packet, Peer);
 			Player->Character->CalculateStats();
 		}
 		else {
@@ -1169,10 +1616,10 @@ void _Server::HandleInventorySplit(ae::_Buffer &Data, ae::_Peer *Peer) {
 	uint8_t Count = Data.Read<uint8_t>();
 
 	// Split items
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 	if(Player->Inventory->SplitStack(Packet, Slot, Count))
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 
 	// Check for trading players
 	if(Slot.Type == BagType::TRADE)
@@ -1197,11 +1644,11 @@ void _Server::HandleInventoryDelete(ae::_Buffer &Data, ae::_Peer *Peer) {
 	Player->Inventory->GetBag(Slot.Type).Slots[Slot.Index].Reset();
 
 	// Update client
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 	Packet.Write<uint8_t>(1);
 	Player->Inventory->SerializeSlot(Packet, Slot);
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 
 	// Check for trading players
 	if(Slot.Type == BagType::TRADE)
@@ -1263,19 +1710,19 @@ void _Server::HandleVendorExchange(ae::_Buffer &Data, ae::_Peer *Peer) {
 		// Update gold
 		Player->Character->UpdateGold(-Price);
 		if(Peer) {
-			ae::_Buffer Packet;
+			ae::_Buffer &Packet = PacketPool.Get();
 			Packet.Write<PacketType>(PacketType::INVENTORY_GOLD);
 			Packet.Write<int64_t>(Player->Character->Attributes["Gold"].Int64);
-			Network->SendPacket(Packet, Peer);
+			SendPacket(Packet, Peer);
 		}
 
 		// Update items
 		if(Peer) {
-			ae::_Buffer Packet;
+			ae::_Buffer &Packet = PacketPool.Get();
 			Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 			Packet.Write<uint8_t>(1);
 			Player->Inventory->SerializeSlot(Packet, TargetSlot);
-			Network->SendPacket(Packet, Peer);
+			SendPacket(Packet, Peer);
 		}
 
 		Player->Character->CalculateStats();
@@ -1299,10 +1746,10 @@ void _Server::HandleVendorExchange(ae::_Buffer &Data, ae::_Peer *Peer) {
 			// Update gold
 			Player->Character->UpdateGold(Price);
 			if(Peer) {
-				ae::_Buffer Packet;
+				ae::_Buffer &Packet = PacketPool.Get();
 				Packet.Write<PacketType>(PacketType::INVENTORY_GOLD);
 				Packet.Write<int64_t>(Player->Character->Attributes["Gold"].Int64);
-				Network->SendPacket(Packet, Peer);
+				SendPacket(Packet, Peer);
 			}
 
 			// Log
@@ -1311,11 +1758,11 @@ void _Server::HandleVendorExchange(ae::_Buffer &Data, ae::_Peer *Peer) {
 			// Update items
 			Player->Inventory->UpdateItemCount(Slot, -Amount);
 			if(Peer) {
-				ae::_Buffer Packet;
+				ae::_Buffer &Packet = PacketPool.Get();
 				Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 				Packet.Write<uint8_t>(1);
 				Player->Inventory->SerializeSlot(Packet, Slot);
-				Network->SendPacket(Packet, Peer);
+				SendPacket(Packet, Peer);
 			}
 		}
 	}
@@ -1352,10 +1799,10 @@ void _Server::HandleTraderAccept(ae::_Buffer &Data, ae::_Peer *Peer) {
 		Player->UpdateStats(StatChange);
 
 		// Build packet
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::STAT_CHANGE);
 		StatChange.Serialize(Packet);
-		Network->SendPacket(Packet, Player->Peer);
+		SendPacket(Packet, Player->Peer);
 
 		RewardName = "Beggar buff";
 		RewardID = 0;
@@ -1368,10 +1815,10 @@ void _Server::HandleTraderAccept(ae::_Buffer &Data, ae::_Peer *Peer) {
 	}
 
 	// Send new inventory
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY);
 	Player->Inventory->Serialize(Packet);
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 
 	// Log
 	Log << "[TRADER] Player " << Player->Name << " trades for " << RewardCount << "x " << RewardName << " ( character_id=" << Peer->CharacterID << " item_id=" << RewardID << " )" << std::endl;
@@ -1440,11 +1887,11 @@ void _Server::HandleEnchanterBuy(ae::_Buffer &Data, ae::_Peer *Peer) {
 
 	// Update skill
 	{
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::SKILLS_MAXLEVELADJUST);
 		Packet.Write<uint32_t>(SkillID);
 		Packet.Write<int>(MaxSkillLevel + 1);
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 	}
 
 	// Update gold
@@ -1455,10 +1902,10 @@ void _Server::HandleEnchanterBuy(ae::_Buffer &Data, ae::_Peer *Peer) {
 		Player->UpdateStats(StatChange);
 
 		// Build packet
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::STAT_CHANGE);
 		StatChange.Serialize(Packet);
-		Network->SendPacket(Packet, Player->Peer);
+		SendPacket(Packet, Player->Peer);
 	}
 
 	// Update values
@@ -1521,9 +1968,9 @@ void _Server::HandleTradeCancel(ae::_Buffer &Data, ae::_Peer *Peer) {
 		TradePlayer->Character->TradePlayer = nullptr;
 		TradePlayer->Character->TradeAccepted = false;
 
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::TRADE_CANCEL);
-		Network->SendPacket(Packet, TradePlayer->Peer);
+		SendPacket(Packet, TradePlayer->Peer);
 	}
 
 	// Set state back to normal
@@ -1552,10 +1999,10 @@ void _Server::HandleTradeGold(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(TradePlayer) {
 		TradePlayer->Character->TradeAccepted = false;
 
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::TRADE_GOLD);
 		Packet.Write<int64_t>(Gold);
-		Network->SendPacket(Packet, TradePlayer->Peer);
+		SendPacket(Packet, TradePlayer->Peer);
 	}
 }
 
@@ -1608,28 +2055,28 @@ void _Server::HandleTradeAccept(ae::_Buffer &Data, ae::_Peer *Peer) {
 
 			// Send packet to players
 			{
-				ae::_Buffer Packet;
+				ae::_Buffer &Packet = PacketPool.Get();
 				Packet.Write<PacketType>(PacketType::TRADE_EXCHANGE);
 				Packet.Write<int64_t>(Player->Character->Attributes["Gold"].Int64);
 				Player->Inventory->Serialize(Packet);
-				Network->SendPacket(Packet, Player->Peer);
+				SendPacket(Packet, Player->Peer);
 			}
 			{
-				ae::_Buffer Packet;
+				ae::_Buffer &Packet = PacketPool.Get();
 				Packet.Write<PacketType>(PacketType::TRADE_EXCHANGE);
 				Packet.Write<int64_t>(TradePlayer->Character->Attributes["Gold"].Int64);
 				TradePlayer->Inventory->Serialize(Packet);
-				Network->SendPacket(Packet, TradePlayer->Peer);
+				SendPacket(Packet, TradePlayer->Peer);
 			}
 
 		}
 		else {
 
 			// Notify trading player
-			ae::_Buffer Packet;
+			ae::_Buffer &Packet = PacketPool.Get();
 			Packet.Write<PacketType>(PacketType::TRADE_ACCEPT);
 			Packet.Write<char>(Accepted);
-			Network->SendPacket(Packet, TradePlayer->Peer);
+			SendPacket(Packet, TradePlayer->Peer);
 		}
 	}
 }
@@ -1648,7 +2095,7 @@ void _Server::HandlePartyInfo(ae::_Buffer &Data, ae::_Peer *Peer) {
 	Player->Character->PartyName = Data.ReadString();
 
 	// Broadcast party to all objects in map
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::PARTY_INFO);
 	Packet.Write<ae::NetworkIDType>(Player->NetworkID);
 	Packet.WriteString(Player->Character->PartyName.c_str());
@@ -1776,19 +2223,19 @@ void _Server::HandleBlacksmithUpgrade(ae::_Buffer &Data, ae::_Peer *Peer) {
 		Player->UpdateStats(StatChange);
 
 		// Build packet
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::STAT_CHANGE);
 		StatChange.Serialize(Packet);
-		Network->SendPacket(Packet, Player->Peer);
+		SendPacket(Packet, Player->Peer);
 	}
 
 	// Update items
 	{
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::INVENTORY_UPDATE);
 		Packet.Write<uint8_t>(1);
 		Player->Inventory->SerializeSlot(Packet, Slot);
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 	}
 
 	// Log
@@ -1808,14 +2255,20 @@ void _Server::HandleMinigamePay(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(!Minigame || Player->Inventory->CountItem(Minigame->RequiredItem) < Minigame->Cost)
 		return;
 
+	// Limit drops in flight before charging
+	if(Player->Character->MinigamesPending >= MINIGAME_MAX_PENDING) {
+		SendMessage(Peer, "Wait for your prizes", "red");
+		return;
+	}
+
 	// Trade in required items
 	Player->Inventory->SpendItems(Minigame->RequiredItem, Minigame->Cost);
 
 	// Send new inventory
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::INVENTORY);
 	Player->Inventory->Serialize(Packet);
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 
 	// Update stats
 	Player->Character->Attributes["GamesPlayed"].Int++;
@@ -1834,29 +2287,23 @@ void _Server::HandleMinigameGetPrize(ae::_Buffer &Data, ae::_Peer *Peer) {
 
 	float DropX = Data.Read<float>();
 
-	// Simulate game
-	_Minigame Minigame(Player->Character->Minigame);
-	Minigame.IsServer = true;
-	Minigame.StartGame(Player->Character->Seed);
-	Minigame.Drop(DropX);
+	// Simulate game with the current seed and give the player a new one
+	uint32_t Seed = Player->Character->Seed;
+	Player->SendSeed(true);
 
-	double Time = 0;
-	while(Time < 30) {
-		Minigame.Update(DEFAULT_TIMESTEP);
-		if(Minigame.State == _Minigame::StateType::DONE) {
-			break;
-		}
-		Time += DEFAULT_TIMESTEP;
-	}
+	// Give reward when verified
+	ae::NetworkIDType NetworkID = Player->NetworkID;
+	uint32_t CharacterID = Player->Character->CharacterID;
+	Player->Character->MinigamesPending++;
+	MinigameQueue->Submit(Player->Character->Minigame, Seed, DropX, [this, NetworkID, CharacterID](const _MinigameItem *MinigameItem) {
+		_Object *Player = ObjectManager->GetObject(NetworkID);
+		if(!Player || !Player->Peer || Player->Character->CharacterID != CharacterID)
+			return;
 
-	// Give reward
-	Player->SendSeed(true);
-	if(Minigame.Bucket < Minigame.Prizes.size()) {
-		const _MinigameItem *MinigameItem = Minigame.Prizes[Minigame.Bucket];
-		if(MinigameItem && MinigameItem->Item) {
-			SendItem(Peer, Stats->Items.at(MinigameItem->Item->ID), MinigameItem->Count);
-		}
-	}
+		Player->Character->MinigamesPending--;
+		if(MinigameItem && MinigameItem->Item)
+			SendItem(Player->Peer, Stats->Items.at(MinigameItem->Item->ID), MinigameItem->Count);
+	});
 }
 
 // Handle join battle request by player
@@ -1865,7 +2312,7 @@ void _Server::HandleJoin(ae::_Buffer &Data, ae::_Peer *Peer) {
 		return;
 
 	_Object *Player = Peer->Object;
-	if(!Player->Character->AcceptingMoveInput())
+	if(!Player->Map || Player->TransferMapID || !Player->Character->AcceptingMoveInput())
 		return;
 
 	// Find a nearby battle instance
@@ -1893,10 +2340,10 @@ void _Server::HandleJoin(ae::_Buffer &Data, ae::_Peer *Peer) {
 	Battle->BroadcastStatusEffects(Player);
 
 	// Send battle to new player
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::BATTLE_START);
 	Battle->Serialize(Packet);
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Handle client exit command
@@ -1959,9 +2406,9 @@ void _Server::HandleExit(ae::_Buffer &Data, ae::_Peer *Peer, bool Penalize) {
 	if(TradePlayer) {
 		TradePlayer->Character->TradePlayer = nullptr;
 
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::TRADE_CANCEL);
-		Network->SendPacket(Packet, TradePlayer->Peer);
+		SendPacket(Packet, TradePlayer->Peer);
 	}
 
 	// Save player
@@ -1979,9 +2426,9 @@ void _Server::HandleCommand(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(!ValidatePeer(Peer))
 		return;
 
-	// Get player
+	// Get player, ignore commands while changing maps
 	_Object *Player = Peer->Object;
-	if(!Player->Map)
+	if(!Player->Map || Player->TransferMapID)
 		return;
 
 	std::string Command = Data.ReadString();
@@ -2012,10 +2459,10 @@ void _Server::HandleCommand(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(Command == "battle") {
 		Player->Character->BossCooldowns.clear();
 
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::OBJECT_STATS);
 		Player->SerializeStats(Packet);
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 
 		uint32_t ZoneID = Data.Read<uint32_t>();
 		QueueBattle(Player, ZoneID, false, false, 0.0f, 0.0f);
@@ -2030,10 +2477,10 @@ void _Server::HandleCommand(ae::_Buffer &Data, ae::_Peer *Peer) {
 		Player->Character->BossCooldowns.clear();
 		Player->Character->BossKills.clear();
 
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::OBJECT_STATS);
 		Player->SerializeStats(Packet);
-		Network->SendPacket(Packet, Peer);
+		SendPacket(Packet, Peer);
 	}
 	else if(Command == "clearunlocks") {
 		Player->Character->ClearUnlocks();
@@ -2121,7 +2568,7 @@ void _Server::HandleActionUse(ae::_Buffer &Data, ae::_Peer *Peer) {
 	if(Player->Character->Battle) {
 
 		// Notify other players of action
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::BATTLE_ACTION);
 		Packet.Write<ae::NetworkIDType>(Player->NetworkID);
 		if(Player->Character->Action.Item)
@@ -2156,7 +2603,7 @@ void _Server::SendHUD(ae::_Peer *Peer) {
 
 	_Object *Player = Peer->Object;
 
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::WORLD_HUD);
 	Packet.Write<int>(Player->Character->Attributes["Health"].Int);
 	Packet.Write<int>(Player->Character->Attributes["Mana"].Int);
@@ -2167,7 +2614,7 @@ void _Server::SendHUD(ae::_Peer *Peer) {
 	Packet.Write<int64_t>(Player->Character->Attributes["Bounty"].Int64);
 	Packet.Write<double>(Save->Clock);
 
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Set server clock
@@ -2178,20 +2625,20 @@ void _Server::SetClock(double Clock) {
 	Save->Clock = Clock;
 
 	// Build packet
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::WORLD_CLOCK);
 	Packet.Write<float>(Clock);
 
 	// Broadcast packet
-	for(auto &Peer : Network->GetPeers())
-		Network->SendPacket(Packet, Peer);
+	for(auto &Peer : Peers)
+		SendPacket(Packet, Peer);
 }
 
 // Update buff on client
 void _Server::UpdateBuff(_Object *Player, _StatusEffect *StatusEffect) {
 
 	// Create packet
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::PLAYER_UPDATEBUFF);
 	Packet.Write<ae::NetworkIDType>(Player->NetworkID);
 	Packet.Write<uint32_t>(StatusEffect->Buff->ID);
@@ -2200,11 +2647,14 @@ void _Server::UpdateBuff(_Object *Player, _StatusEffect *StatusEffect) {
 	Packet.Write<int>(StatusEffect->Level);
 	Packet.Write<float>(StatusEffect->Duration);
 
+	// Restart timer with new duration
+	Player->Character->ScheduleStatusEffect(StatusEffect);
+
 	// Notify players in battle
 	if(Player->Character->Battle)
 		Player->Character->Battle->BroadcastPacket(Packet);
 	else
-		Network->SendPacket(Packet, Player->Peer);
+		SendPacket(Packet, Player->Peer);
 }
 
 // Slap a misbehaving player
@@ -2221,10 +2671,10 @@ void _Server::Slap(ae::NetworkIDType PlayerID, int GoldAmount) {
 	Player->UpdateStats(StatChange);
 
 	// Build packet
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::STAT_CHANGE);
 	StatChange.Serialize(Packet);
-	Network->SendPacket(Packet, Player->Peer);
+	SendPacket(Packet, Player->Peer);
 
 	// Shame them
 	BroadcastMessage(nullptr, Player->Name + " has been slapped for misbehaving!", "yellow");
@@ -2245,7 +2695,7 @@ void _Server::Ban(uint32_t AccountID, const std::string &TimeFromNow) {
 	for(auto &Object : ObjectManager->Objects) {
 		if(Object->Peer->AccountID == AccountID) {
 			Save->SetBanTime(AccountID, TimeFromNow);
-			Network->DisconnectPeer(Object->Peer, 0);
+			DisconnectPeer(Object->Peer, 0);
 		}
 	}
 }
@@ -2297,18 +2747,18 @@ void _Server::SendMessage(ae::_Peer *Peer, const std::string &Message, const std
 		return;
 
 	// Build message
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::CHAT_MESSAGE);
 	Packet.WriteString(ColorName.c_str());
 	Packet.WriteString(Message.c_str());
 
 	// Send
-	Network->SendPacket(Packet, Peer);
+	SendPacket(Packet, Peer);
 }
 
 // Broadcast message to all peers
 void _Server::BroadcastMessage(ae::_Peer *IgnorePeer, const std::string &Message, const std::string &ColorName) {
-	for(auto &Peer : Network->GetPeers()) {
+	for(auto &Peer : Peers) {
 		if(Peer == IgnorePeer)
 			continue;
 
@@ -2324,26 +2774,29 @@ void _Server::SendTradeInformation(_Object *Sender, _Object *Receiver) {
 	_Bag &Bag = Sender->Inventory->GetBag(BagType::TRADE);
 
 	// Send items to trader player
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::TRADE_REQUEST);
 	Packet.Write<ae::NetworkIDType>(Sender->NetworkID);
 	Packet.Write<int>(Sender->Character->TradeGold);
 	for(std::size_t i = 0; i < Bag.Slots.size(); i++)
 		Sender->Inventory->SerializeSlot(Packet, _Slot(BagType::TRADE, i));
 
-	Network->SendPacket(Packet, Receiver->Peer);
+	SendPacket(Packet, Receiver->Peer);
 }
 
 // Add summons to the battle from summon buffs
 void _Server::AddBattleSummons(_Battle *Battle, int Side, _Object *JoinPlayer, bool Join) {
 
 	// Get list of objects on a side
-	std::vector<_Object *> ObjectList;
+	_ScratchVector<_Object *> ObjectList(TickArena);
 	ObjectList.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
-	Battle->GetObjectList(Side, ObjectList);
+	for(auto &Object : Battle->Objects) {
+		if(Object->Fighter->BattleSide == Side)
+			ObjectList.push_back(Object);
+	}
 
 	// Iterate over all players in battle, collecting summons for each player
-	std::vector<_SummonCaptain> SummonCaptains;
+	_ScratchVector<_SummonCaptain> SummonCaptains(TickArena);
 	for(auto &SummonOwner : ObjectList) {
 		if(JoinPlayer && SummonOwner != JoinPlayer)
 			continue;
@@ -2353,12 +2806,12 @@ void _Server::AddBattleSummons(_Battle *Battle, int Side, _Object *JoinPlayer, b
 		SummonCaptain.Summons.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
 		SummonCaptain.Owner = SummonOwner;
 		SummonOwner->Character->GetSummonsFromBuffs(SummonCaptain.Summons);
-		std::shuffle(SummonCaptain.Summons.begin(), SummonCaptain.Summons.end(), ae::RandomGenerator);
+		std::shuffle(SummonCaptain.Summons.begin(), SummonCaptain.Summons.end(), Battle->Random);
 		SummonCaptains.push_back(SummonCaptain);
 	}
 
 	// Shuffle who goes first
-	std::shuffle(SummonCaptains.begin(), SummonCaptains.end(), ae::RandomGenerator);
+	std::shuffle(SummonCaptains.begin(), SummonCaptains.end(), Battle->Random);
 
 	// Get summons from summon buffs
 	int SlotsLeft = BATTLE_MAX_OBJECTS_PER_SIDE - ObjectList.size();
@@ -2378,7 +2831,7 @@ void _Server::AddBattleSummons(_Battle *Battle, int Side, _Object *JoinPlayer, b
 
 			// If joining battle, broadcast create
 			if(Join) {
-				ae::_Buffer Packet;
+				ae::_Buffer &Packet = PacketPool.Get();
 				Packet.Write<PacketType>(PacketType::WORLD_CREATEOBJECT);
 				Object->SerializeCreate(Packet);
 				Battle->BroadcastPacket(Packet);
@@ -2394,6 +2847,7 @@ void _Server::AddBattleSummons(_Battle *Battle, int Side, _Object *JoinPlayer, b
 				StatusEffect->Deleted = true;
 			else
 				StatusEffect->Duration = StatusEffect->MaxDuration;
+			Captain.Owner->Character->ScheduleStatusEffect(StatusEffect);
 
 			Captain.Summons.pop_back();
 			Added++;
@@ -2419,10 +2873,10 @@ void _Server::SendTradePlayerInventory(_Object *Player) {
 	TradePlayer->Character->TradeAccepted = false;
 
 	// Send inventory
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::TRADE_INVENTORY);
 	Player->Inventory->GetBag(BagType::TRADE).Serialize(Packet);
-	Network->SendPacket(Packet, TradePlayer->Peer);
+	SendPacket(Packet, TradePlayer->Peer);
 }
 
 // Send the clear WaitForServer packet
@@ -2430,9 +2884,9 @@ void _Server::SendClearWait(_Object *Player) {
 	if(!Player || !Player->Peer)
 		return;
 
-	ae::_Buffer Packet;
+	ae::_Buffer &Packet = PacketPool.Get();
 	Packet.Write<PacketType>(PacketType::PLAYER_CLEARWAIT);
-	Network->SendPacket(Packet, Player->Peer);
+	SendPacket(Packet, Player->Peer);
 }
 
 // Start a battle event
@@ -2442,13 +2896,17 @@ void _Server::StartBattle(_BattleEvent &BattleEvent) {
 	if(BattleEvent.Object->Character->Battle || (!BattleEvent.PVP && !BattleEvent.Zone))
 		return;
 
+	// Return if object is changing maps
+	if(!BattleEvent.Object->Map || BattleEvent.Object->TransferMapID)
+		return;
+
 	// Handle PVP
 	if(BattleEvent.PVP) {
 		if(NoPVP)
 			return;
 
 		// Get list of players on current tile
-		std::vector<_Object *> Players;
+		_ScratchVector<_Object *> Players(TickArena);
 		Players.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
 		BattleEvent.Object->Map->GetPVPPlayers(BattleEvent.Object, Players, BattleEvent.BountyEarned > 0);
 		if(!Players.size())
@@ -2463,6 +2921,9 @@ void _Server::StartBattle(_BattleEvent &BattleEvent) {
 		Battle->PVP = BattleEvent.PVP;
 		Battle->BountyEarned = BattleEvent.BountyEarned;
 		Battle->BountyClaimed = BattleEvent.BountyClaimed;
+		Battle->Seed = ae::GetRandomInt((uint32_t)1, std::numeric_limits<uint32_t>::max());
+		Battle->Random.seed(Battle->Seed);
+		Log << "[BATTLE_START] pvp=1 seed=" << Battle->Seed << std::endl;
 
 		// Add players to battle
 		Battle->AddObject(BattleEvent.Object, BattleEvent.Side);
@@ -2475,7 +2936,7 @@ void _Server::StartBattle(_BattleEvent &BattleEvent) {
 		AddBattleSummons(Battle, 1);
 
 		// Send battle to players
-		ae::_Buffer Packet;
+		ae::_Buffer &Packet = PacketPool.Get();
 		Packet.Write<PacketType>(PacketType::BATTLE_START);
 		Battle->Serialize(Packet);
 		Battle->BroadcastPacket(Packet);
@@ -2483,108 +2944,124 @@ void _Server::StartBattle(_BattleEvent &BattleEvent) {
 	else {
 
 		// Get a list of players
-		std::vector<_Object *> Players;
+		_ScratchVector<_Object *> Players(TickArena);
 		Players.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
 		BattleEvent.Object->Map->GetPotentialBattlePlayers(BattleEvent.Object, BATTLE_COOP_DISTANCE, BATTLE_MAX_OBJECTS_PER_SIDE-1, Players);
-		int AdditionalCount = 0;
-		if(!BattleEvent.Scripted)
-			AdditionalCount = (int)Players.size();
-
-		// Get monster count modifier
-		int MonsterCountModifier = BattleEvent.Object->Character->Attributes["MonsterCount"].Int;
-		for(const auto &Player : Players)
-			MonsterCountModifier += Player->Character->Attributes["MonsterCount"].Int - 100;
-
-		// Get monsters
-		std::list<_Zone> Monsters;
-		bool Boss = false;
-		double Cooldown = 0.0;
-		Stats->GenerateMonsterListFromZone(AdditionalCount, MonsterCountModifier * 0.01f, BattleEvent.Zone, Monsters, Boss, Cooldown);
-
-		// Fight if there are monsters
-		if(!Monsters.size())
-			return;
-
-		// Check for cooldown
-		if(BattleEvent.Object->Character->IsZoneOnCooldown(BattleEvent.Zone)) {
-			SendBattleCooldownMessage(BattleEvent.Object->Peer, BattleEvent.Object->Character->BossCooldowns[BattleEvent.Zone]);
-			return;
-		}
-
-		// Get number of times boss has been killed by host
-		int BossKillCount = 0;
-		if(Boss)
-			BossKillCount = BattleEvent.Object->Character->BossKills[BattleEvent.Zone];
-
-		// Create a new battle instance
-		_Battle *Battle = BattleManager->Create();
-		Battle->Manager = ObjectManager;
-		Battle->Stats = Stats;
-		Battle->Server = this;
-		Battle->Boss = Boss;
-		Battle->Cooldown = Cooldown;
-		Battle->Zone = BattleEvent.Zone;
-		Battle->Scripting = Scripting;
-		Scripting->CreateBattle(Battle);
-
-		// Add player
-		Players.push_back(BattleEvent.Object);
 
-		// Sort by network id
-		std::sort(Players.begin(), Players.end(), CompareObjects);
+		StartZoneBattle(BattleEvent.Object, Players, BattleEvent.Zone, BattleEvent.Scripted);
+	}
+}
 
-		// Get difficulty
-		int Difficulty = 0;
-		if(Scripting->StartMethodCall("Game", "GetDifficulty")) {
-			Scripting->PushReal(Save->Clock);
-			Scripting->MethodCall(1, 1);
-			Difficulty = Scripting->GetInt(1);
-			Scripting->FinishMethodCall();
-		}
+// Start a battle against monsters from a zone, players doesn't include the leader
+_Battle *_Server::StartZoneBattle(_Object *Leader, _ScratchVector<_Object *> &Players, uint32_t Zone, bool Scripted) {
+	int AdditionalCount = 0;
+	if(!Scripted)
+		AdditionalCount = (int)Players.size();
 
-		Difficulty += BossKillCount * BATTLE_BOSS_DIFFICULTY_PER_KILL;
+	// Get monster count modifier
+	int MonsterCountModifier = Leader->Character->Attributes["MonsterCount"].Int;
+	for(const auto &Player : Players)
+		MonsterCountModifier += Player->Character->Attributes["MonsterCount"].Int - 100;
 
-		// Get difficulty increase
-		int DifficultyAdjust = BATTLE_DIFFICULTY_PER_PLAYER;
-		if(Boss)
-			DifficultyAdjust = BATTLE_DIFFICULTY_PER_PLAYER_BOSS;
+	// Get monsters from the battle's stream so the seed replays the whole battle
+	uint32_t Seed = ae::GetRandomInt((uint32_t)1, std::numeric_limits<uint32_t>::max());
+	std::mt19937 Random(Seed);
+	_ScratchList<_Zone> Monsters(TickArena);
+	bool Boss = false;
+	double Cooldown = 0.0;
+	Stats->GenerateMonsterListFromZone(AdditionalCount, MonsterCountModifier * 0.01f, Zone, Monsters, Boss, Cooldown, Random);
 
-		// Add players to battle
-		Difficulty -= DifficultyAdjust;
-		for(auto &PartyPlayer : Players) {
-			Battle->AddObject(PartyPlayer, 0);
+	// Fight if there are monsters
+	if(!Monsters.size())
+		return nullptr;
 
-			// Increase difficulty for each player
-			Difficulty += DifficultyAdjust;
+	// Check for cooldown
+	if(Leader->Character->IsZoneOnCooldown(Zone)) {
+		SendBattleCooldownMessage(Leader->Peer, Leader->Character->GetBossCooldown(Zone));
+		return nullptr;
+	}
 
-			// Increase by each player's difficulty stat
-			Difficulty += PartyPlayer->Character->Attributes["Difficulty"].Int;
-		}
+	// Get number of times boss has been killed by host
+	int BossKillCount = 0;
+	if(Boss)
+		BossKillCount = Leader->Character->BossKills[Zone];
+
+	// Create a new battle instance
+	_Battle *Battle = BattleManager->Create();
+	Battle->Manager = ObjectManager;
+	Battle->Stats = Stats;
+	Battle->Server = this;
+	Battle->Boss = Boss;
+	Battle->Cooldown = Cooldown;
+	Battle->Zone = Zone;
+	Battle->Scripting = Scripting;
+	Battle->Seed = Seed;
+	Battle->Random = Random;
+	Scripting->CreateBattle(Battle);
+	Scripting->Random = &Battle->Random;
+	Log << "[BATTLE_START] zone=" << Zone << " seed=" << Seed << std::endl;
+
+	// Add player
+	Players.push_back(Leader);
+
+	// Sort by network id
+	std::sort(Players.begin(), Players.end(), CompareObjects);
 
-		// Add summons
-		AddBattleSummons(Battle, 0);
-
-		// Add monsters
-		for(auto &Monster : Monsters) {
-			_Object *Object = ObjectManager->Create();
-			Object->CreateComponents();
-			Object->Server = this;
-			Object->Scripting = Scripting;
-			Object->Monster->DatabaseID = Monster.MonsterID;
-			Object->Monster->Difficulty = Difficulty + Monster.Difficulty;
-			Object->Stats = Stats;
-			Object->Character->Init();
-			Stats->GetMonsterStats(Monster.MonsterID, Object, Object->Monster->Difficulty);
-			Object->Character->CalculateStats();
-			Battle->AddObject(Object, 1);
-		}
+	// Get difficulty
+	int Difficulty = 0;
+	if(Scripting->StartMethodCall("Game", "GetDifficulty")) {
+		Scripting->PushReal(Save->Clock);
+		Scripting->MethodCall(1, 1);
+		Difficulty = Scripting->GetInt(1);
+		Scripting->FinishMethodCall();
+	}
+
+	Difficulty += BossKillCount * BATTLE_BOSS_DIFFICULTY_PER_KILL;
+
+	// Get difficulty increase
+	int DifficultyAdjust = BATTLE_DIFFICULTY_PER_PLAYER;
+	if(Boss)
+		DifficultyAdjust = BATTLE_DIFFICULTY_PER_PLAYER_BOSS;
+
+	// Add players to battle
+	Difficulty -= DifficultyAdjust;
+	for(auto &PartyPlayer : Players) {
+		Battle->AddObject(PartyPlayer, 0);
+
+		// Increase difficulty for each player
+		Difficulty += DifficultyAdjust;
+
+		// Increase by each player's difficulty stat
+		Difficulty += PartyPlayer->Character->Attributes["Difficulty"].Int;
+	}
+
+	// Add summons
+	AddBattleSummons(Battle, 0);
+
+	// Add monsters
+	for(auto &Monster : Monsters) {
+		_Object *Object = ObjectManager->Create();
+		ComponentPool->CreateComponents(Object);
+		Object->Server = this;
+		Object->Scripting = Scripting;
+		Object->Monster->DatabaseID = Monster.MonsterID;
+		Object->Monster->Difficulty = Difficulty + Monster.Difficulty;
+		Object->Stats = Stats;
+		Object->Character->Init();
+		Stats->GetMonsterStats(Monster.MonsterID, Object, Object->Monster->Difficulty);
+		Object->Character->CalculateStats();
+		Battle->AddObject(Object, 1);
+	}
+	ComponentPool->Battles++;
+	Scripting->Random = nullptr;
+
+	// Send battle to players
+	ae::_Buffer &Packet = PacketPool.Get();
+	Packet.Write<PacketType>(PacketType::BATTLE_START);
+	Battle->Serialize(Packet);
+	Battle->BroadcastPacket(Packet);
 
-		// Send battle to players
-		ae::_Buffer Packet;
-		Packet.Write<PacketType>(PacketType::BATTLE_START);
-		Battle->Serialize(Packet);
-		Battle->BroadcastPacket(Packet);
-	}
+	return Battle;
 }
 
 // Start a rebirth
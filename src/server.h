@@ -21,9 +21,16 @@
 #include <ae/type.h>
 #include <ae/log.h>
 #include <ae/buffer.h>
+#include <ae/network.h>
+#include <commandqueue.h>
+#include <arena.h>
+#include <bufferpool.h>
+#include <timerwheel.h>
 #include <glm/vec4.hpp>
 #include <unordered_map>
 #include <memory>
+#include <future>
+#include <atomic>
 #include <thread>
 #include <list>
 
@@ -34,6 +41,14 @@ class _Stats;
 class _Save;
 class _Object;
 class _Scripting;
+class _Capture;
+class _NetworkThread;
+class _MapLoader;
+class _PathQueue;
+class _MinigameQueue;
+class _Navigation;
+struct _BotData;
+class _ComponentPool;
 class _Item;
 class _StatusEffect;
 struct _Summon;
@@ -75,16 +90,40 @@ class _Server {
 
 	public:
 
-		_Server(uint16_t NetworkPort);
+		_Server(uint16_t NetworkPort, const std::string &SavePath="", bool PingSocket=true);
 		~_Server();
 
 		void Update(double FrameTime);
 		void StartThread();
 		void JoinThread();
 		void StopServer(int Seconds=0);
+		void StartRecording(const std::string &Path);
+		void HandleNetworkEvent(ae::_NetworkEvent &Event);
+		void HandleNetworkEvents(double FrameTime);
+		bool WaitForEvents(double Timeout);
+
+		// Run a function on the server thread and get its result
+		template<typename T> std::future<T> Query(std::function<T()> Function) {
+			auto Promise = std::make_shared<std::promise<T>>();
+			std::future<T> Future = Promise->get_future();
+			Commands.Push([Promise, Function]() {
+				try {
+					Promise->set_value(Function());
+				}
+				catch(...) {
+					Promise->set_exception(std::current_exception());
+				}
+			});
+
+			return Future;
+		}
+		void SendPacket(ae::_Buffer &Packet, ae::_Peer *Peer, ae::_Network::SendType Type=ae::_Network::RELIABLE, uint8_t Channel=0);
 
 		_Object *CreateSummon(_Object *Source, const _Summon &Summon);
+		_Object *CreateBot(uint32_t AccountID, const std::string &Name, uint32_t BuildID=1);
+		_Battle *StartZoneBattle(_Object *Leader, _ScratchVector<_Object *> &Players, uint32_t Zone, bool Scripted);
 		void SpawnPlayer(_Object *Player, ae::NetworkIDType MapID, uint32_t EventType);
+		_Map *LoadMap(ae::NetworkIDType MapID);
 		void QueueRebirth(_Object *Object, int Mode, int Type, int Value);
 		void QueueBattle(_Object *Object, uint32_t Zone, bool Scripted, bool PVP, float BountyEarned, float BountyClaimed);
 		void StartTeleport(_Object *Object, double Time);
@@ -142,9 +181,10 @@ class _Server {
 		bool IsTesting;
 		bool Hardcore;
 		bool NoPVP;
+		bool PingSocket;
 
 		// State
-		bool Done;
+		std::atomic<bool> Done;
 		bool StartShutdownTimer;
 		bool StartDisconnect;
 		bool StartShutdown;
@@ -161,6 +201,44 @@ class _Server {
 
 		// Network
 		std::unique_ptr<ae::_ServerNetwork> Network;
+		std::unique_ptr<_Capture> Capture;
+		std::unique_ptr<_NetworkThread> NetworkThread;
+		std::list<ae::_Peer *> Peers;
+		double NetworkUpdateTimer;
+		double NetworkTime;
+		double ServiceTime;
+		uint32_t NetworkTicks;
+
+		// Commands from other threads
+		_CommandQueue Commands;
+
+		// Scratch memory released at the end of each tick
+		_Arena TickArena;
+		_BufferPool PacketPool;
+		uint64_t TickAllocations;
+		uint64_t TickAllocationBytes;
+		uint64_t MaxTickAllocations;
+		uint32_t AllocationTicks;
+
+		// Objects updated per tick
+		uint64_t VisitedObjects;
+		uint64_t UpdatedObjects;
+		uint64_t IdleObjects;
+		uint64_t DormantObjects;
+		uint32_t UpdateTicks;
+
+		// Monster AI script calls
+		uint64_t MonsterAITurns;
+		uint64_t MonsterAICalls;
+		uint64_t MonsterAIPushes;
+
+		// Actions resolved in battles
+		uint64_t BattleActions;
+
+		// Cooldown, regen and status effect timers
+		_TimerWheel TimerWheel;
+		std::vector<_TimerEvent> ExpiredTimers;
+		uint32_t TimerCount;
 
 		// Scripting
 		_Scripting *Scripting;
@@ -168,6 +246,13 @@ class _Server {
 		// Objects
 		ae::_Manager<_Object> *ObjectManager;
 		ae::_Manager<_Map> *MapManager;
+		std::unique_ptr<_MapLoader> MapLoader;
+		std::unique_ptr<_PathQueue> PathQueue;
+		std::unique_ptr<_MinigameQueue> MinigameQueue;
+		std::unique_ptr<_Navigation> Navigation;
+		std::unique_ptr<_BotData> BotData;
+		bool NavigationLogged;
+		std::unique_ptr<_ComponentPool> ComponentPool;
 		ae::_Manager<_Battle> *BattleManager;
 		std::list<_BattleEvent> BattleEvents;
 		std::list<_RebirthEvent> RebirthEvents;
@@ -175,16 +260,22 @@ class _Server {
 	private:
 
 		_Object *CreatePlayer(ae::_Peer *Peer);
-		_Object *CreateBot();
 		bool ValidatePeer(ae::_Peer *Peer);
 		bool CheckAccountUse(ae::_Peer *Peer);
 		void AddBattleSummons(_Battle *Battle, int Side, _Object *JoinPlayer=nullptr, bool Join=false);
 		void StartBattle(_BattleEvent &BattleEvent);
 		void StartRebirth(_RebirthEvent &RebirthEvent);
+		void PreloadMaps(const std::string &MapList);
+		void UpdateMapLoads();
+		void UnloadIdleMaps(double FrameTime);
+		void HandleMapError(_Object *Player, ae::NetworkIDType MapID);
 
 		void HandleConnect(ae::_NetworkEvent &Event);
 		void HandleDisconnect(ae::_NetworkEvent &Event);
 		void HandlePacket(ae::_Buffer &Data, ae::_Peer *Peer);
+		void DisconnectPeer(ae::_Peer *Peer, uint32_t Value);
+		void DisconnectAll(uint32_t Value);
+		void DeletePeer(ae::_Peer *Peer);
 
 		void SendItem(ae::_Peer *Peer, const _Item *Item, int Count);
 		void SendPlayerInfo(ae::_Peer *Peer);
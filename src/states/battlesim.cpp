@@ -0,0 +1,210 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/battlesim.h>
+#include <objects/object.h>
+#include <objects/components/character.h>
+#include <objects/components/inventory.h>
+#include <ae/random.h>
+#include <ae/util.h>
+#include <framework.h>
+#include <server.h>
+#include <stats.h>
+#include <save.h>
+#include <config.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+
+const double LOAD_TIME = 10.0;
+const double BATTLE_TIMEOUT = 600.0;
+
+_BattleSimState BattleSimState;
+
+// Constructor
+_BattleSimState::_BattleSimState() :
+	Zone(0),
+	BattleCount(1000),
+	Party("1:1") {
+}
+
+// Initialize
+void _BattleSimState::Init() {
+	_Server *Server = nullptr;
+	std::string SavePath = Config.ConfigPath + "battlesim.db";
+
+	try {
+
+		// Start with fresh save
+		std::remove(SavePath.c_str());
+		Server = new _Server(0, SavePath);
+
+		uint64_t Seed = SDL_GetPerformanceCounter();
+		ae::RandomGenerator.seed(Seed);
+		std::cout << "zone=" << Zone << " battles=" << BattleCount << " party=" << Party << " seed=" << Seed << std::endl;
+
+		CreateParty(Server);
+		RunBattles(Server);
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	Members.clear();
+	delete Server;
+	std::remove(SavePath.c_str());
+
+	Framework.Done = true;
+}
+
+// Close
+void _BattleSimState::Close() {
+}
+
+// Update
+void _BattleSimState::Update(double FrameTime) {
+}
+
+// Create a bot for each build:level entry in the party list
+void _BattleSimState::CreateParty(_Server *Server) {
+	std::stringstream Stream(Party);
+	std::string Token;
+	while(std::getline(Stream, Token, ',')) {
+		std::size_t Separator = Token.find(':');
+		_Member Member;
+		Member.BuildID = ae::ToNumber<uint32_t>(Token.substr(0, Separator));
+		Member.Level = Separator == std::string::npos ? 1 : ae::ToNumber<int>(Token.substr(Separator + 1));
+		Member.Object = nullptr;
+
+		if(Server->Stats->Builds.find(Member.BuildID) == Server->Stats->Builds.end())
+			throw std::runtime_error("Bad build_id " + std::to_string(Member.BuildID));
+		if(Member.Level < 1 || Member.Level > Server->Stats->GetMaxLevel())
+			throw std::runtime_error("Bad level " + std::to_string(Member.Level));
+
+		Members.push_back(Member);
+	}
+
+	if(Members.empty() || (int)Members.size() > BATTLE_MAX_OBJECTS_PER_SIDE)
+		throw std::runtime_error("Party must have 1 to " + std::to_string(BATTLE_MAX_OBJECTS_PER_SIDE) + " members");
+
+	// Create bots with their own accounts
+	for(std::size_t i = 0; i < Members.size(); i++) {
+		std::string Name = "sim_bot" + std::to_string(i);
+		std::string BannedText;
+		uint32_t AccountID = 0;
+		Server->Save->CreateAccount(Name, Name);
+		Server->Save->GetAccountInfo(Name, Name, AccountID, BannedText);
+		Members[i].Object = Server->CreateBot(AccountID, Name, Members[i].BuildID);
+		if(!Members[i].Object)
+			throw std::runtime_error("Error creating bot " + Name);
+	}
+
+	// Wait for bots to join their spawn map
+	for(double Time = 0.0; Time < LOAD_TIME; Time += DEFAULT_TIMESTEP) {
+		bool Loaded = true;
+		for(const auto &Member : Members)
+			Loaded &= Member.Object->Map != nullptr;
+		if(Loaded) {
+
+			// Keep starting inventory to restore before each battle
+			for(auto &Member : Members)
+				Member.Bags = Member.Object->Inventory->GetBags();
+
+			return;
+		}
+
+		Server->Update(DEFAULT_TIMESTEP);
+	}
+
+	throw std::runtime_error("Timed out loading bots");
+}
+
+// Restore level, health, buffs, gold, inventory and cooldowns so every battle starts the same
+void _BattleSimState::ResetParty(_Server *Server) {
+	for(auto &Member : Members) {
+		_Character *Character = Member.Object->Character;
+		Character->DeleteStatusEffects();
+		Member.Object->Inventory->GetBags() = Member.Bags;
+		Character->Attributes["Gold"].Int64 = 0;
+		Character->Attributes["Experience"].Int64 = Server->Stats->GetLevel(Member.Level)->Experience;
+		Character->CalculateStats();
+		Character->Attributes["Health"].Int = Character->Attributes["MaxHealth"].Int;
+		Character->Attributes["Mana"].Int = Character->Attributes["MaxMana"].Int;
+		Character->Cooldowns.clear();
+		Character->BossCooldowns.clear();
+		Character->BossKills.clear();
+	}
+}
+
+// Fight battles and report results
+void _BattleSimState::RunBattles(_Server *Server) {
+	_Object *Leader = Members.front().Object;
+
+	int Started = 0;
+	int Empty = 0;
+	int Wins = 0;
+	uint64_t Actions = 0;
+	double BattleTime = 0.0;
+	double CPUTime = 0.0;
+	for(int i = 0; i < BattleCount; i++) {
+		ResetParty(Server);
+
+		// Start battle
+		_ScratchVector<_Object *> Players(Server->TickArena);
+		for(std::size_t j = 1; j < Members.size(); j++)
+			Players.push_back(Members[j].Object);
+		if(!Server->StartZoneBattle(Leader, Players, Zone, false)) {
+			Empty++;
+			continue;
+		}
+		Started++;
+
+		// Run server until the battle ends
+		uint64_t StartActions = Server->BattleActions;
+		double Time = 0.0;
+		Uint64 StartTime = SDL_GetPerformanceCounter();
+		while(Leader->Character->Battle) {
+			if(Time >= BATTLE_TIMEOUT)
+				throw std::runtime_error("Battle " + std::to_string(i) + " did not finish");
+
+			Server->Update(DEFAULT_TIMESTEP);
+			Time += DEFAULT_TIMESTEP;
+		}
+		CPUTime += (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+		BattleTime += Time;
+		Actions += Server->BattleActions - StartActions;
+
+		// Party wins if anyone survived
+		for(const auto &Member : Members) {
+			if(Member.Object->Character->IsAlive()) {
+				Wins++;
+				break;
+			}
+		}
+	}
+
+	double Battles = std::max(1, Started);
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "battles=" << Started << " empty=" << Empty << " wins=" << Wins << " win_rate=" << Wins / Battles << std::endl;
+	std::cout << "turns=" << Actions / Battles << " time_to_kill=" << BattleTime / Battles << "s" << std::endl;
+	std::cout << "cpu_ms_per_battle=" << CPUTime * 1000.0 / Battles << " battles_per_core_second=" << (CPUTime > 0.0 ? Started / CPUTime : 0.0) << std::endl;
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <ae/state.h>
+#include <objects/components/inventory.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Forward Declarations
+class _Server;
+class _Object;
+
+// Headless battles between a bot party and a zone for balancing and benchmarks
+class _BattleSimState : public ae::_State {
+
+	public:
+
+		_BattleSimState();
+
+		// Setup
+		void Init() override;
+		void Close() override;
+
+		// Update
+		void Update(double FrameTime) override;
+
+		// State parameters
+		void SetZone(uint32_t Value) { Zone = Value; }
+		void SetBattleCount(int Value) { BattleCount = Value; }
+		void SetParty(const std::string &Value) { Party = Value; }
+
+	protected:
+
+		struct _Member {
+			uint32_t BuildID;
+			int Level;
+			_Object *Object;
+			std::vector<_Bag> Bags;
+		};
+
+		void CreateParty(_Server *Server);
+		void ResetParty(_Server *Server);
+		void RunBattles(_Server *Server);
+
+		// Parameters
+		uint32_t Zone;
+		int BattleCount;
+		std::string Party;
+
+		// Party
+		std::vector<_Member> Members;
+
+};
+
+extern _BattleSimState BattleSimState;
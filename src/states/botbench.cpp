@@ -0,0 +1,102 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/botbench.h>
+#include <ae/manager.h>
+#include <framework.h>
+#include <server.h>
+#include <save.h>
+#include <config.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+
+const double WARMUP_TIME = 10.0;
+const double MEASURE_TIME = 60.0;
+
+_BotBenchState BotBenchState;
+
+// Constructor
+_BotBenchState::_BotBenchState() :
+	BotCount(100) {
+}
+
+// Initialize
+void _BotBenchState::Init() {
+	try {
+		bool NativeBots = Config.NativeBots;
+		RunBots(false);
+		RunBots(true);
+		Config.NativeBots = NativeBots;
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	Framework.Done = true;
+}
+
+// Close
+void _BotBenchState::Close() {
+}
+
+// Update
+void _BotBenchState::Update(double FrameTime) {
+}
+
+// Run server with bots and report how many bots a core can run in real time
+void _BotBenchState::RunBots(bool NativeBots) {
+	Config.NativeBots = NativeBots;
+
+	// Start with fresh save
+	std::string SavePath = Config.ConfigPath + "botbench.db";
+	std::remove(SavePath.c_str());
+	_Server *Server = new _Server(0, SavePath);
+
+	// Create a bot account for each bot
+	for(int i = 0; i < BotCount; i++) {
+		std::string Name = "bench_bot" + std::to_string(i);
+		std::string BannedText;
+		uint32_t AccountID = 0;
+		Server->Save->CreateAccount(Name, Name);
+		Server->Save->GetAccountInfo(Name, Name, AccountID, BannedText);
+		Server->CreateBot(AccountID, Name);
+	}
+
+	// Let maps load and bots spread out
+	for(double Time = 0.0; Time < WARMUP_TIME; Time += DEFAULT_TIMESTEP)
+		Server->Update(DEFAULT_TIMESTEP);
+
+	// Measure
+	int Ticks = 0;
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+	for(double Time = 0.0; Time < MEASURE_TIME; Time += DEFAULT_TIMESTEP) {
+		Server->Update(DEFAULT_TIMESTEP);
+		Ticks++;
+	}
+	double TotalTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "brain=" << (NativeBots ? "native" : "lua") << " bots=" << BotCount << " objects=" << Server->ObjectManager->Objects.size();
+	std::cout << " ticks=" << Ticks << " ms_per_tick=" << TotalTime * 1000.0 / Ticks;
+	std::cout << " bots_per_core=" << BotCount * Ticks * DEFAULT_TIMESTEP / TotalTime << std::endl;
+
+	delete Server;
+	std::remove(SavePath.c_str());
+}
@@ -29,11 +29,14 @@
 #include <stats.h>
 #include <constants.h>
 #include <enet/enet.h>
+#include <stdexcept>
+#include <chrono>
 #include <iomanip>
+#include <sstream>
 
 _DedicatedState DedicatedState;
 
-// Command loop
+// Command loop, server calls are queued to run on the server thread
 void RunCommandThread(_Server *Server) {
 	std::cout << "Type help to list commands" << std::endl;
 
@@ -41,15 +44,18 @@ void RunCommandThread(_Server *Server) {
 	while(!Done) {
 		std::string Input;
 		std::getline(std::cin, Input);
-		Server->Log << "[SERVER_COMMAND] " << Input << std::endl;
+		Server->Commands.Push([Server, Input]() { Server->Log << "[SERVER_COMMAND] " << Input << std::endl; });
 		if(Input.substr(0, 3) == "ban") {
 			std::vector<std::string> Parameters;
 			Parameters.reserve(4);
 			ae::TokenizeString(Input, Parameters);
 			if(Parameters.size() != 4)
 				std::cout << "Bad parameters" << std::endl;
-			else
-				Server->Ban(std::stoi(Parameters[1]), Parameters[2] + " " + Parameters[3]);
+			else {
+				uint32_t AccountID = std::stoi(Parameters[1]);
+				std::string TimeFromNow = Parameters[2] + " " + Parameters[3];
+				Server->Commands.Push([Server, AccountID, TimeFromNow]() { Server->Ban(AccountID, TimeFromNow); });
+			}
 		}
 		else if(Input == "b" || Input == "battles") {
 			DedicatedState.ShowBattles();
@@ -57,7 +63,11 @@ void RunCommandThread(_Server *Server) {
 		else if(Input.substr(0, 3) == "log" && Input.size() > 4) {
 			ae::NetworkIDType PlayerID = std::stoi(Input.substr(4, std::string::npos));
 			try {
-				bool Mode = Server->StartLog(PlayerID);
+				std::future<bool> Future = Server->Query<bool>([Server, PlayerID]() { return Server->StartLog(PlayerID); });
+				if(Future.wait_for(std::chrono::duration<double>(SERVER_QUERY_TIMEOUT)) != std::future_status::ready)
+					throw std::runtime_error("Server is not responding");
+
+				bool Mode = Future.get();
 				std::cout << "Logging has been " << (Mode ? "enabled" : "disabled") << std::endl;
 			}
 			catch (std::exception &Error) {
@@ -70,27 +80,34 @@ void RunCommandThread(_Server *Server) {
 		else if(Input == "p" || Input == "players") {
 			DedicatedState.ShowPlayers();
 		}
+		else if(Input == "m" || Input == "maps") {
+			DedicatedState.ShowMaps();
+		}
 		else if(Input.substr(0, 4) == "mute") {
 			std::vector<std::string> Parameters;
 			Parameters.reserve(3);
 			ae::TokenizeString(Input, Parameters);
 			if(Parameters.size() != 3)
 				std::cout << "Bad parameters" << std::endl;
-			else
-				Server->Mute(std::stoi(Parameters[1]), std::stoi(Parameters[2]));
+			else {
+				uint32_t AccountID = std::stoi(Parameters[1]);
+				bool Value = std::stoi(Parameters[2]);
+				Server->Commands.Push([Server, AccountID, Value]() { Server->Mute(AccountID, Value); });
+			}
 		}
 		else if(Input.substr(0, 3) == "say" && Input.size() > 4) {
-			Server->BroadcastMessage(nullptr, Input.substr(4, std::string::npos), "purple");
+			std::string Message = Input.substr(4, std::string::npos);
+			Server->Commands.Push([Server, Message]() { Server->BroadcastMessage(nullptr, Message, "purple"); });
 		}
 		else if(Input.substr(0, 4) == "slap" && Input.size() > 5) {
 			ae::NetworkIDType PlayerID = std::stoi(Input.substr(5, std::string::npos));
-			Server->Slap(PlayerID, 25);
+			Server->Commands.Push([Server, PlayerID]() { Server->Slap(PlayerID, 25); });
 		}
 		else if(Input.substr(0, 4) == "stop" || std::cin.eof() == 1) {
 			int Seconds = 0;
 			if(Input.size() > 5)
 				Seconds = std::stoi(Input.substr(5, std::string::npos));
-			Server->StopServer(Seconds);
+			Server->Commands.Push([Server, Seconds]() { Server->StopServer(Seconds); });
 			Done = true;
 		}
 		else {
@@ -98,7 +115,7 @@ void RunCommandThread(_Server *Server) {
 		}
 	}
 
-	Server->StopServer();
+	Server->Commands.Push([Server]() { Server->StopServer(); });
 }
 
 // Constructor
@@ -126,6 +143,13 @@ void _DedicatedState::Init() {
 			std::cout << "Hardcore only is on" << std::endl;
 		if(NoPVP)
 			std::cout << "PVP is disabled" << std::endl;
+		if(!RecordPath.empty()) {
+			Server->StartRecording(RecordPath);
+			std::cout << "Recording network events to " << RecordPath << std::endl;
+		}
+
+		// Step the server on its own thread with the same deadline loop as a local server
+		Server->StartThread();
 
 		Thread = new std::thread(RunCommandThread, Server);
 	}
@@ -147,13 +171,9 @@ void _DedicatedState::Close() {
 
 // Update
 void _DedicatedState::Update(double FrameTime) {
-	if(Framework.GetTimeStepAccumulator() > DEBUG_STALL_THRESHOLD)
-		Server->Log << "[STALL] TimeStepAccumulator=" << Framework.GetTimeStepAccumulator() << std::endl;
-
-	// Update server
-	Server->Update(FrameTime);
 
-	if(Server->Done) {
+	// Server runs on its own thread, exit once it shuts down
+	if(Server && Server->Done) {
 		Framework.Done = true;
 	}
 }
@@ -164,6 +184,7 @@ void _DedicatedState::ShowCommands() {
 	std::cout << "ban      <account_id> <time>    ban player (E.g. ban 1 5 days)" << std::endl;
 	std::cout << "battles                         show current battles" << std::endl;
 	std::cout << "log      <network_id>           toggle logging player data" << std::endl;
+	std::cout << "maps                            show loaded maps and memory use" << std::endl;
 	std::cout << "mute     <account_id> <value>   mute player (E.g. mute 1 1)" << std::endl;
 	std::cout << "players                         show players" << std::endl;
 	std::cout << "stop     [seconds]              stop server" << std::endl;
@@ -171,24 +192,53 @@ void _DedicatedState::ShowCommands() {
 	std::cout << "say      <message>              broadcast message" << std::endl;
 }
 
+// Wait for a list from the server thread
+std::string _DedicatedState::GetQueryResult(std::future<std::string> Future) {
+	if(Future.wait_for(std::chrono::duration<double>(SERVER_QUERY_TIMEOUT)) != std::future_status::ready)
+		return "Server is not responding\n";
+
+	try {
+		return Future.get();
+	}
+	catch(std::exception &Error) {
+		return std::string(Error.what()) + "\n";
+	}
+}
+
 // Show all players
 void _DedicatedState::ShowPlayers() {
-	auto &Peers = Server->Network->GetPeers();
+	std::cout << GetQueryResult(Server->Query<std::string>([this]() { return GetPlayerList(); }));
+}
+
+// Show all battles
+void _DedicatedState::ShowBattles() {
+	std::cout << GetQueryResult(Server->Query<std::string>([this]() { return GetBattleList(); }));
+}
+
+// Show loaded maps
+void _DedicatedState::ShowMaps() {
+	std::cout << GetQueryResult(Server->Query<std::string>([this]() { return GetMapList(); }));
+}
+
+// Build player list on the server thread
+std::string _DedicatedState::GetPlayerList() {
+	auto &Peers = Server->Peers;
 
-	std::cout << "peer count=" << Peers.size() << std::endl;
+	std::ostringstream Output;
+	Output << "peer count=" << Peers.size() << std::endl;
 	std::size_t i = 0;
 	for(auto &Peer : Peers) {
 		char Buffer[16];
 		ENetAddress *Address = &Peer->ENetPeer->address;
 		enet_address_get_host_ip(Address, Buffer, 16);
 
-		std::cout << std::setw(3) << i << ": ip=" << Buffer << ", account_id=" << Peer->AccountID;
+		Output << std::setw(3) << i << ": ip=" << Buffer << ", account_id=" << Peer->AccountID;
 		if(Peer->Object) {
 			uint32_t MapID = 0;
 			if(Peer->Object->Map)
 				MapID = Peer->Object->Map->NetworkID;
 
-			std::cout
+			Output
 				<< ", network_id=" << Peer->Object->NetworkID
 				<< ", map_id=" << MapID
 				<< ", name=" << Peer->Object->Name
@@ -196,26 +246,55 @@ void _DedicatedState::ShowPlayers() {
 				<< ", hardcore=" << (int)Peer->Object->Character->Hardcore;
 		}
 
-		std::cout << std::endl;
+		Output << std::endl;
 		i++;
 	}
 
-	std::cout << std::endl;
+	Output << std::endl;
+
+	return Output.str();
 }
 
-// Show all battles
-void _DedicatedState::ShowBattles() {
+// Build battle list on the server thread
+std::string _DedicatedState::GetBattleList() {
 	auto &Battles = Server->BattleManager->Objects;
 
-	std::cout << "battle count=" << Battles.size() << std::endl;
+	std::ostringstream Output;
+	Output << "battle count=" << Battles.size() << std::endl;
 	std::size_t i = 0;
 	for(auto &Battle : Battles) {
-		std::cout << i << ": id=" << Battle->NetworkID << std::endl;
+		Output << i << ": id=" << Battle->NetworkID << std::endl;
 		for(auto &Object : Battle->Objects) {
-			std::cout << "\tnetwork_id=" << Object->NetworkID << "\thealth=" << ae::Round(Object->Character->GetHealthPercent()) << "\tname=" << Object->Name << std::endl;
+			Output << "\tnetwork_id=" << Object->NetworkID << "\thealth=" << ae::Round(Object->Character->GetHealthPercent()) << "\tname=" << Object->Name << std::endl;
 		}
 
 		i++;
-		std::cout << std::endl;
+		Output << std::endl;
 	}
+
+	return Output.str();
+}
+
+// Build map list on the server thread
+std::string _DedicatedState::GetMapList() {
+	auto &Maps = Server->MapManager->Objects;
+
+	std::ostringstream Output;
+	Output << "map count=" << Maps.size() << std::endl;
+	std::size_t TotalBytes = 0;
+	for(auto &Map : Maps) {
+		std::size_t Bytes = Map->GetMemoryUsage();
+		TotalBytes += Bytes;
+
+		Output
+			<< "id=" << Map->NetworkID
+			<< "\tobjects=" << Map->Objects.size()
+			<< "\tidle=" << (int)Map->IdleTime
+			<< "\tloading=" << Map->Loading
+			<< "\tkb=" << Bytes / 1024 << std::endl;
+	}
+
+	Output << "total kb=" << TotalBytes / 1024 << std::endl << std::endl;
+
+	return Output.str();
 }
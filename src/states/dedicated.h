@@ -20,6 +20,8 @@
 // Libraries
 #include <ae/state.h>
 #include <thread>
+#include <future>
+#include <string>
 
 // Forward Declarations
 class _Server;
@@ -44,14 +46,21 @@ class _DedicatedState : public ae::_State {
 		void SetHardcore(bool Value) { this->Hardcore = Value; }
 		void SetNoPVP(bool Value) { this->NoPVP = Value; }
 		void SetDevMode(bool Value) { this->DevMode = Value; }
+		void SetRecordPath(const std::string &Value) { this->RecordPath = Value; }
 
 		// Commands
 		void ShowCommands();
 		void ShowPlayers();
 		void ShowBattles();
+		void ShowMaps();
 
 	protected:
 
+		std::string GetQueryResult(std::future<std::string> Future);
+		std::string GetPlayerList();
+		std::string GetBattleList();
+		std::string GetMapList();
+
 		_Server *Server;
 
 		std::thread *Thread;
@@ -61,6 +70,7 @@ class _DedicatedState : public ae::_State {
 		bool Hardcore;
 		bool NoPVP;
 		bool DevMode;
+		std::string RecordPath;
 
 };
 
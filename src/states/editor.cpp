@@ -350,7 +350,7 @@ void _EditorState::HandleMouseButton(const ae::_MouseEvent &MouseEvent) {
 				// Eyedropper tool
 				case SDL_BUTTON_LEFT:
 					if(ae::Input.ModKeyDown(KMOD_CTRL) && Map->IsValidPosition(WorldCursor))
-						*Brush = *Map->GetTile(WorldCursor);
+						*Brush = Map->GetTile(WorldCursor);
 				break;
 				// Scroll map
 				case SDL_BUTTON_RIGHT:
@@ -754,7 +754,8 @@ void _EditorState::Paste() {
 			glm::ivec2 CopyCoord = glm::ivec2(i, j) + CopyPosition;
 			glm::ivec2 PasteCoord = glm::ivec2(i, j) + PastePosition;
 			if(Map->IsValidPosition(CopyCoord) && Map->IsValidPosition(PasteCoord)) {
-				Map->Tiles[PasteCoord.x][PasteCoord.y] = Map->Tiles[CopyCoord.x][CopyCoord.y];
+				_Tile Tile = Map->GetTile(CopyCoord);
+				Map->SetTile(PasteCoord, &Tile);
 			}
 		}
 	}
@@ -1073,20 +1074,20 @@ void _EditorState::Go() {
 
 	// Event inspector
 	if(Map->IsValidPosition(WorldCursor)) {
-		const _Tile *Tile = Map->GetTile(WorldCursor);
-		switch(Tile->Event.Type) {
+		_Tile Tile = Map->GetTile(WorldCursor);
+		switch(Tile.Event.Type) {
 			case _Map::EVENT_MAPENTRANCE:
 			case _Map::EVENT_MAPCHANGE: {
-				ToggleLoadMap(GetCleanMapName(Stats->Maps.at(Tile->Event.Data).File));
+				ToggleLoadMap(GetCleanMapName(Stats->Maps.at(Tile.Event.Data).File));
 			} break;
 			case _Map::EVENT_VENDOR: {
 				std::stringstream Buffer;
-				Buffer << Config.BrowserCommand << " \"" << Config.DesignToolURL << "/?table=vendoritem&vendor_id=" << Tile->Event.Data << "\"";
+				Buffer << Config.BrowserCommand << " \"" << Config.DesignToolURL << "/?table=vendoritem&vendor_id=" << Tile.Event.Data << "\"";
 				system(Buffer.str().c_str());
 			} break;
 			case _Map::EVENT_TRADER: {
 				std::stringstream Buffer;
-				Buffer << Config.BrowserCommand << " \"" << Config.DesignToolURL << "/?table=traderitem&trader_id=" << Tile->Event.Data << "\"";
+				Buffer << Config.BrowserCommand << " \"" << Config.DesignToolURL << "/?table=traderitem&trader_id=" << Tile.Event.Data << "\"";
 				system(Buffer.str().c_str());
 			} break;
 			case _Map::EVENT_SCRIPT: {
@@ -0,0 +1,404 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/maptool.h>
+#include <objects/object.h>
+#include <objects/map.h>
+#include <ae/random.h>
+#include <framework.h>
+#include <pathfinder.h>
+#include <stats.h>
+#include <SDL_timer.h>
+#include <filesystem>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <list>
+#include <map>
+
+const int LOADS = 10;
+const int COLLISION_CHECKS = 1000000;
+const int PATH_SOLVES = 200;
+const int EVENT_QUERIES = 100000;
+const int CHURN_OBJECTS = 5000;
+const int CHURN_STEPS = 100000;
+const int ITERATION_TICKS = 1000;
+
+_MapToolState MapToolState;
+
+// Constructor
+_MapToolState::_MapToolState() :
+	Mode(MODE_CONVERT),
+	Stats(nullptr) {
+}
+
+// Initialize
+void _MapToolState::Init() {
+	try {
+		Stats = new _Stats(true);
+
+		switch(Mode) {
+			case MODE_CONVERT:
+				ConvertMaps();
+			break;
+			case MODE_BENCHMARK:
+				BenchmarkMaps();
+			break;
+		}
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	Framework.Done = true;
+}
+
+// Close
+void _MapToolState::Close() {
+	delete Stats;
+	Stats = nullptr;
+}
+
+// Update
+void _MapToolState::Update(double FrameTime) {
+}
+
+// Convert text maps to binary and verify the result
+void _MapToolState::ConvertMaps() {
+	std::map<uint32_t, const _MapStat *> Maps;
+	for(const auto &MapStat : Stats->Maps)
+		Maps[MapStat.first] = &MapStat.second;
+
+	int Converted = 0;
+	int Failed = 0;
+	for(const auto &Iterator : Maps) {
+		const _MapStat *MapStat = Iterator.second;
+		if(!std::filesystem::exists(MapStat->File))
+			continue;
+
+		std::string BinaryPath = _Map::GetBinaryPath(MapStat->File);
+		_Map *Map = CreateMap();
+		_Map *BinaryMap = CreateMap();
+		try {
+			Map->LoadText(MapStat->File);
+			Map->SaveBinary(BinaryPath);
+			if(!BinaryMap->LoadBinary(BinaryPath) || !CompareMaps(Map, BinaryMap))
+				throw std::runtime_error("Verification failed");
+
+			std::cout << MapStat->File << " -> " << BinaryPath << std::endl;
+			Converted++;
+		}
+		catch(std::exception &Error) {
+			std::cerr << MapStat->File << ": " << Error.what() << std::endl;
+			Failed++;
+		}
+
+		delete Map;
+		delete BinaryMap;
+	}
+
+	std::cout << "converted=" << Converted << " failed=" << Failed << std::endl;
+}
+
+// Compare text and binary load times for every map
+void _MapToolState::BenchmarkMaps() {
+	std::map<uint32_t, const _MapStat *> Maps;
+	for(const auto &MapStat : Stats->Maps)
+		Maps[MapStat.first] = &MapStat.second;
+
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	double TotalText = 0.0;
+	double TotalBinary = 0.0;
+	std::cout << std::fixed << std::setprecision(3);
+	for(const auto &Iterator : Maps) {
+		const _MapStat *MapStat = Iterator.second;
+		std::string BinaryPath = _Map::GetBinaryPath(MapStat->File);
+		if(!std::filesystem::exists(MapStat->File) || !std::filesystem::exists(BinaryPath))
+			continue;
+
+		// Time each loader
+		double TextTime = 0.0;
+		double BinaryTime = 0.0;
+		for(int i = 0; i < LOADS; i++) {
+			_Map *Map = CreateMap();
+			Uint64 StartTime = SDL_GetPerformanceCounter();
+			Map->LoadText(MapStat->File);
+			TextTime += (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+			delete Map;
+
+			Map = CreateMap();
+			StartTime = SDL_GetPerformanceCounter();
+			Map->LoadBinary(BinaryPath);
+			BinaryTime += (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+			delete Map;
+		}
+
+		TextTime /= LOADS;
+		BinaryTime /= LOADS;
+		TotalText += TextTime;
+		TotalBinary += BinaryTime;
+		std::cout << MapStat->File << " text=" << TextTime * 1000.0 << "ms binary=" << BinaryTime * 1000.0 << "ms speedup=" << TextTime / BinaryTime << "x" << std::endl;
+
+		// Run tile benchmarks on a fully loaded map
+		_Map *Map = CreateMap();
+		Map->Load(MapStat);
+		BenchmarkTiles(Map);
+		BenchmarkEvents(Map);
+		delete Map;
+	}
+
+	if(TotalBinary > 0.0)
+		std::cout << "total text=" << TotalText * 1000.0 << "ms binary=" << TotalBinary * 1000.0 << "ms speedup=" << TotalText / TotalBinary << "x" << std::endl;
+
+	BenchmarkObjects();
+}
+
+// Report tile memory and time collision and path finding queries
+void _MapToolState::BenchmarkTiles(_Map *Map) {
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	ae::RandomGenerator.seed(0);
+
+	// Compare against one _Tile per position plus column pointers
+	std::size_t TileCount = (std::size_t)(Map->Size.x * Map->Size.y);
+	std::size_t OldBytes = (std::size_t)Map->Size.x * sizeof(_Tile *) + TileCount * sizeof(_Tile);
+	std::size_t ServerBytes = TileCount * (sizeof(_HotTile) + sizeof(uint32_t));
+	std::size_t ClientBytes = ServerBytes + TileCount * 2 * sizeof(uint32_t);
+	std::cout << "  memory old=" << OldBytes << " client=" << ClientBytes << " server=" << ServerBytes << " saved=" << OldBytes - ServerBytes << std::endl;
+
+	// Collision checks at random positions
+	std::vector<glm::ivec2> Positions(COLLISION_CHECKS);
+	for(auto &Position : Positions)
+		Position = glm::ivec2(ae::GetRandomInt(0, Map->Size.x - 1), ae::GetRandomInt(0, Map->Size.y - 1));
+
+	int Blocked = 0;
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+	for(const auto &Position : Positions) {
+		const _HotTile &Tile = Map->GetHotTile(Position);
+		if(Tile.IsWall() || Tile.EventType == _Map::EVENT_KEY)
+			Blocked++;
+	}
+	double CollisionTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+	std::cout << "  collision=" << COLLISION_CHECKS / CollisionTime / 1000000.0 << "M/s blocked=" << Blocked << std::endl;
+
+	// Path finding between random open tiles
+	std::vector<glm::ivec2> OpenPositions;
+	for(int j = 0; j < Map->Size.y; j++) {
+		for(int i = 0; i < Map->Size.x; i++) {
+			if(!Map->GetHotTile(glm::ivec2(i, j)).IsWall())
+				OpenPositions.push_back(glm::ivec2(i, j));
+		}
+	}
+	if(OpenPositions.size() < 2)
+		return;
+
+	std::vector<std::pair<glm::ivec2, glm::ivec2>> Queries(PATH_SOLVES);
+	for(auto &Query : Queries) {
+		Query.first = OpenPositions[(std::size_t)ae::GetRandomInt(0, (int)OpenPositions.size() - 1)];
+		Query.second = OpenPositions[(std::size_t)ae::GetRandomInt(0, (int)OpenPositions.size() - 1)];
+	}
+
+	// Solve with MicroPather
+	micropather::MicroPather Pather(Map, (unsigned)TileCount, 4);
+	std::vector<void *> PatherPath;
+	std::vector<float> PatherCosts(PATH_SOLVES, -1.0f);
+	StartTime = SDL_GetPerformanceCounter();
+	for(std::size_t i = 0; i < Queries.size(); i++) {
+		float Cost;
+		if(Pather.Solve(Map->PositionToNode(Queries[i].first), Map->PositionToNode(Queries[i].second), &PatherPath, &Cost) == micropather::MicroPather::SOLVED)
+			PatherCosts[i] = Cost;
+	}
+	double PatherTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	// Solve with grid pathfinder
+	std::shared_ptr<const _PathGrid> Grid = Map->GetPathGrid();
+	std::vector<uint32_t> Keys;
+	std::vector<int> Path;
+	int Solved = 0;
+	int Mismatched = 0;
+	StartTime = SDL_GetPerformanceCounter();
+	for(std::size_t i = 0; i < Queries.size(); i++) {
+		float Cost = -1.0f;
+		if(Map->Pathfinder->Solve(*Grid, Queries[i].first, Queries[i].second, Path, Keys) == _Pathfinder::SOLVED) {
+			Cost = (float)(Path.size() - 1);
+			Solved++;
+		}
+		if(Cost != PatherCosts[i])
+			Mismatched++;
+	}
+	double GridTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	std::cout << "  regions=" << Grid->RegionCount << " region_time=" << Grid->BuildTime * 1000.0 << "ms" << std::endl;
+	std::cout << "  path micropather=" << PATH_SOLVES / PatherTime << "/s grid=" << PATH_SOLVES / GridTime << "/s speedup=" << PatherTime / GridTime << "x solved=" << Solved << "/" << PATH_SOLVES << " mismatched=" << Mismatched << std::endl;
+}
+
+// Compare nearest event queries against a linear scan
+void _MapToolState::BenchmarkEvents(_Map *Map) {
+	if(Map->IndexedEvents.empty())
+		return;
+
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	ae::RandomGenerator.seed(0);
+
+	// Pick random events and start positions
+	std::vector<_Event> Events;
+	std::size_t PositionCount = 0;
+	for(const auto &Iterator : Map->IndexedEvents) {
+		Events.push_back(Iterator.first);
+		PositionCount += Iterator.second.size();
+	}
+
+	std::vector<std::pair<_Event, glm::ivec2>> Queries(EVENT_QUERIES);
+	for(auto &Query : Queries) {
+		Query.first = Events[(std::size_t)ae::GetRandomInt(0, (int)Events.size() - 1)];
+		Query.second = glm::ivec2(ae::GetRandomInt(0, Map->Size.x - 1), ae::GetRandomInt(0, Map->Size.y - 1));
+	}
+
+	// Linear scan over every position, ties going to the first position in row order
+	std::vector<glm::ivec2> Results(Queries.size());
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+	for(std::size_t i = 0; i < Queries.size(); i++) {
+		const glm::ivec2 &StartPosition = Queries[i].second;
+		int ClosestDistanceSquared = std::numeric_limits<int>::max();
+		for(const auto &Position : Map->IndexedEvents.at(Queries[i].first)) {
+			glm::ivec2 Delta = StartPosition - Position;
+			int DistanceSquared = Delta.x * Delta.x + Delta.y * Delta.y;
+			if(DistanceSquared < ClosestDistanceSquared || (DistanceSquared == ClosestDistanceSquared && (Position.y < Results[i].y || (Position.y == Results[i].y && Position.x < Results[i].x)))) {
+				ClosestDistanceSquared = DistanceSquared;
+				Results[i] = Position;
+			}
+		}
+	}
+	double LinearTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	// Indexed queries
+	int Mismatched = 0;
+	StartTime = SDL_GetPerformanceCounter();
+	for(std::size_t i = 0; i < Queries.size(); i++) {
+		glm::ivec2 Position = Queries[i].second;
+		Map->FindEvent(Queries[i].first, Position);
+		if(Position != Results[i])
+			Mismatched++;
+	}
+	double IndexedTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	std::cout << "  events=" << Events.size() << " positions=" << PositionCount << " find linear=" << EVENT_QUERIES / LinearTime / 1000000.0 << "M/s indexed=" << EVENT_QUERIES / IndexedTime / 1000000.0 << "M/s speedup=" << LinearTime / IndexedTime << "x mismatched=" << Mismatched << std::endl;
+}
+
+// Compare map object lists against a linked list with linear removal
+void _MapToolState::BenchmarkObjects() {
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	ae::RandomGenerator.seed(0);
+
+	std::vector<_Object *> Objects(CHURN_OBJECTS);
+	for(std::size_t i = 0; i < Objects.size(); i++) {
+		Objects[i] = new _Object();
+		Objects[i]->Position = glm::ivec2((int)i, (int)i / 2);
+	}
+
+	// Pick objects that leave and join again
+	std::vector<std::size_t> Leaves(CHURN_STEPS);
+	for(auto &Leave : Leaves)
+		Leave = (std::size_t)ae::GetRandomInt(0, CHURN_OBJECTS - 1);
+
+	// Linked list
+	std::list<_Object *> List;
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+	for(auto &Object : Objects)
+		List.push_back(Object);
+	for(const auto &Leave : Leaves) {
+		List.erase(std::find(List.begin(), List.end(), Objects[Leave]));
+		List.push_back(Objects[Leave]);
+	}
+	double ListChurnTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	int64_t ListSum = 0;
+	StartTime = SDL_GetPerformanceCounter();
+	for(int i = 0; i < ITERATION_TICKS; i++) {
+		for(const auto &Object : List)
+			ListSum += Object->Position.x;
+	}
+	double ListIterationTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	// Map slots
+	_Map *Map = CreateMap();
+	StartTime = SDL_GetPerformanceCounter();
+	for(auto &Object : Objects)
+		Map->AddObject(Object);
+	for(const auto &Leave : Leaves) {
+		Map->RemoveObject(Objects[Leave]);
+		Map->AddObject(Objects[Leave]);
+	}
+	double MapChurnTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	int64_t MapSum = 0;
+	StartTime = SDL_GetPerformanceCounter();
+	for(int i = 0; i < ITERATION_TICKS; i++) {
+		for(const auto &Object : Map->Objects)
+			MapSum += Object->Position.x;
+	}
+	double MapIterationTime = (SDL_GetPerformanceCounter() - StartTime) / Frequency;
+
+	std::cout << "objects=" << CHURN_OBJECTS << " churn list=" << ListChurnTime * 1000.0 << "ms slots=" << MapChurnTime * 1000.0 << "ms speedup=" << ListChurnTime / MapChurnTime << "x" << std::endl;
+	std::cout << "objects=" << CHURN_OBJECTS << " iterate list=" << ListIterationTime * 1000000.0 / ITERATION_TICKS << "us slots=" << MapIterationTime * 1000000.0 / ITERATION_TICKS << "us speedup=" << ListIterationTime / MapIterationTime << "x matched=" << (ListSum == MapSum) << std::endl;
+
+	for(auto &Object : Objects)
+		Map->RemoveObject(Object);
+	delete Map;
+	for(auto &Object : Objects)
+		delete Object;
+}
+
+// Create a headless map that keeps static objects
+_Map *_MapToolState::CreateMap() {
+	_Map *Map = new _Map();
+	Map->Stats = Stats;
+	Map->Headless = true;
+
+	return Map;
+}
+
+// Return true if two maps contain the same data
+bool _MapToolState::CompareMaps(const _Map *Map, const _Map *CompareMap) {
+	if(Map->Size != CompareMap->Size)
+		return false;
+
+	for(int j = 0; j < Map->Size.y; j++) {
+		for(int i = 0; i < Map->Size.x; i++) {
+			_Tile Tile = Map->GetTile(glm::ivec2(i, j));
+			_Tile CompareTile = CompareMap->GetTile(glm::ivec2(i, j));
+			if(Tile.TextureIndex[0] != CompareTile.TextureIndex[0] || Tile.TextureIndex[1] != CompareTile.TextureIndex[1])
+				return false;
+			if(Tile.Zone != CompareTile.Zone || !(Tile.Event == CompareTile.Event))
+				return false;
+			if(Tile.Wall != CompareTile.Wall || Tile.PVP != CompareTile.PVP)
+				return false;
+		}
+	}
+
+	if(Map->StaticObjects.size() != CompareMap->StaticObjects.size())
+		return false;
+
+	auto CompareIterator = CompareMap->StaticObjects.begin();
+	for(const auto &Object : Map->StaticObjects) {
+		if(Object->Position != (*CompareIterator)->Position || Object->Light != (*CompareIterator)->Light)
+			return false;
+		++CompareIterator;
+	}
+
+	return true;
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <ae/state.h>
+#include <string>
+
+// Forward Declarations
+class _Map;
+class _Stats;
+
+// Headless tools that operate on every shipped map
+class _MapToolState : public ae::_State {
+
+	public:
+
+		enum ModeType {
+			MODE_CONVERT,
+			MODE_BENCHMARK,
+		};
+
+		// Setup
+		_MapToolState();
+		void Init() override;
+		void Close() override;
+
+		// Update
+		void Update(double FrameTime) override;
+
+		// State parameters
+		void SetMode(ModeType Value) { Mode = Value; }
+
+	protected:
+
+		void ConvertMaps();
+		void BenchmarkMaps();
+		void BenchmarkTiles(_Map *Map);
+		void BenchmarkEvents(_Map *Map);
+		void BenchmarkObjects();
+
+		_Map *CreateMap();
+		bool CompareMaps(const _Map *Map, const _Map *CompareMap);
+
+		// Parameters
+		ModeType Mode;
+
+		// Data
+		_Stats *Stats;
+
+};
+
+extern _MapToolState MapToolState;
@@ -0,0 +1,183 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/netbench.h>
+#include <ae/clientnetwork.h>
+#include <ae/servernetwork.h>
+#include <ae/buffer.h>
+#include <framework.h>
+#include <networkthread.h>
+#include <server.h>
+#include <packet.h>
+#include <config.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstdio>
+
+const double CONNECT_TIME = 30.0;
+const double MEASURE_TIME = 60.0;
+const double SEND_PERIOD = 0.1;
+
+_NetBenchState NetBenchState;
+
+// Constructor
+_NetBenchState::_NetBenchState() :
+	PeerCount(500) {
+}
+
+// Initialize
+void _NetBenchState::Init() {
+	try {
+		bool NetworkThread = Config.NetworkThread;
+		std::size_t MaxClients = Config.MaxClients;
+		Config.MaxClients = std::max(MaxClients, (std::size_t)PeerCount);
+		RunPeers(false);
+		RunPeers(true);
+		Config.NetworkThread = NetworkThread;
+		Config.MaxClients = MaxClients;
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	Framework.Done = true;
+}
+
+// Close
+void _NetBenchState::Close() {
+}
+
+// Update
+void _NetBenchState::Update(double FrameTime) {
+}
+
+// Run server with local clients sending packets in real time and report server tick cost
+void _NetBenchState::RunPeers(bool NetworkThread) {
+	Config.NetworkThread = NetworkThread;
+
+	// Start with fresh save
+	std::string SavePath = Config.ConfigPath + "netbench.db";
+	std::remove(SavePath.c_str());
+	_Server *Server = new _Server(0, SavePath, false);
+
+	// Connect clients
+	std::vector<std::unique_ptr<ae::_ClientNetwork>> Clients;
+	for(int i = 0; i < PeerCount; i++) {
+		Clients.push_back(std::make_unique<ae::_ClientNetwork>());
+		Clients.back()->Connect("127.0.0.1", Server->Network->GetListenPort());
+	}
+
+	// Service clients, returning how many connected
+	auto UpdateClients = [&Clients](double FrameTime) {
+		int Connected = 0;
+		for(auto &Client : Clients) {
+			Client->Update(FrameTime);
+
+			ae::_NetworkEvent NetworkEvent;
+			while(Client->GetNetworkEvent(NetworkEvent)) {
+				if(NetworkEvent.Type == ae::_NetworkEvent::CONNECT)
+					Connected++;
+				else if(NetworkEvent.Type == ae::_NetworkEvent::PACKET)
+					delete NetworkEvent.Data;
+			}
+		}
+
+		return Connected;
+	};
+
+	// Run server and clients at the real tick rate
+	auto Sleep = [](Uint64 StartTime) {
+		double Elapsed = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+		if(Elapsed < DEFAULT_TIMESTEP)
+			std::this_thread::sleep_for(std::chrono::duration<double>(DEFAULT_TIMESTEP - Elapsed));
+	};
+
+	// Wait for connections
+	int Connected = 0;
+	for(double Time = 0.0; Time < CONNECT_TIME && Connected < PeerCount; Time += DEFAULT_TIMESTEP) {
+		Uint64 StartTime = SDL_GetPerformanceCounter();
+		Connected += UpdateClients(DEFAULT_TIMESTEP);
+		Server->Update(DEFAULT_TIMESTEP);
+		Sleep(StartTime);
+	}
+
+	// Measure while each client sends an update id every period
+	int Ticks = 0;
+	uint64_t Sent = 0;
+	double ServerTime = 0.0;
+	double SendTimer = 0.0;
+	double Frequency = (double)SDL_GetPerformanceFrequency();
+	if(Server->NetworkThread) {
+		Server->NetworkThread->EventStalls = 0;
+		Server->NetworkThread->CommandStalls = 0;
+		Server->NetworkThread->ServiceTime = 0;
+		Server->NetworkThread->ServicePasses = 0;
+	}
+	Server->NetworkTime = 0.0;
+	Server->ServiceTime = 0.0;
+	for(double Time = 0.0; Time < MEASURE_TIME; Time += DEFAULT_TIMESTEP) {
+		Uint64 StartTime = SDL_GetPerformanceCounter();
+
+		SendTimer += DEFAULT_TIMESTEP;
+		if(SendTimer >= SEND_PERIOD) {
+			SendTimer -= SEND_PERIOD;
+			for(auto &Client : Clients) {
+				ae::_Buffer Packet;
+				Packet.Write<PacketType>(PacketType::WORLD_UPDATEID);
+				Packet.Write<uint8_t>(0);
+				Client->SendPacket(Packet);
+				Sent++;
+			}
+		}
+		UpdateClients(DEFAULT_TIMESTEP);
+
+		Uint64 ServerStart = SDL_GetPerformanceCounter();
+		Server->Update(DEFAULT_TIMESTEP);
+		ServerTime += (SDL_GetPerformanceCounter() - ServerStart) / Frequency;
+		Ticks++;
+
+		Sleep(StartTime);
+	}
+
+	// Service time is measured per pass on the network thread and per tick without it
+	double ServiceTime = Server->ServiceTime;
+	uint64_t Passes = Ticks;
+	uint64_t EventStalls = 0;
+	uint64_t CommandStalls = 0;
+	if(Server->NetworkThread) {
+		ServiceTime = Server->NetworkThread->ServiceTime / 1000000.0;
+		Passes = std::max((uint64_t)1, (uint64_t)Server->NetworkThread->ServicePasses);
+		EventStalls = Server->NetworkThread->EventStalls;
+		CommandStalls = Server->NetworkThread->CommandStalls;
+	}
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "threaded=" << NetworkThread << " peers=" << PeerCount << " connected=" << Connected << " packets=" << Sent << " ticks=" << Ticks;
+	std::cout << " server_ms_per_tick=" << ServerTime * 1000.0 / Ticks << " handle_ms_per_tick=" << Server->NetworkTime * 1000.0 / Ticks;
+	std::cout << " service_ms_per_pass=" << ServiceTime * 1000.0 / Passes << " service_passes=" << Passes;
+	std::cout << " event_stalls=" << EventStalls << " command_stalls=" << CommandStalls << std::endl;
+
+	Clients.clear();
+	delete Server;
+	std::remove(SavePath.c_str());
+}
@@ -1550,7 +1550,7 @@ void _PlayState::HandleBattleEnd(ae::_Buffer &Data) {
 	// Get ending stats
 	double BossCooldown = Data.Read<float>();
 	if(BossCooldown && Battle->Zone)
-		Player->Character->BossCooldowns[Battle->Zone] = BossCooldown;
+		Player->Character->SetBossCooldown(Battle->Zone, BossCooldown);
 	Player->Character->Attributes["PlayerKills"].Int = Data.Read<int>();
 	Player->Character->Attributes["MonsterKills"].Int = Data.Read<int>();
 	Player->Character->Attributes["GoldLost"].Int64 = Data.Read<int64_t>();
@@ -1638,8 +1638,8 @@ void _PlayState::HandleActionResults(ae::_Buffer &Data) {
 	const _Item *ItemUsed = ActionResult.ActionUsed.Item;
 	if(ItemUsed) {
 		if(SourceObject && !SkillUnlocked && ItemUsed->Cooldown > 0.0) {
-			SourceObject->Character->Cooldowns[ItemUsed->ID].Duration = ItemUsed->Cooldown * SourceObject->Character->Attributes["Cooldowns"].Mult();
-			SourceObject->Character->Cooldowns[ItemUsed->ID].MaxDuration = ItemUsed->Cooldown * SourceObject->Character->Attributes["Cooldowns"].Mult();
+			double Duration = ItemUsed->Cooldown * SourceObject->Character->Attributes["Cooldowns"].Mult();
+			SourceObject->Character->SetCooldown(ItemUsed->ID, Duration, Duration);
 		}
 
 		// Set texture
@@ -0,0 +1,162 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/replay.h>
+#include <ae/network.h>
+#include <ae/buffer.h>
+#include <ae/random.h>
+#include <ae/peer.h>
+#include <framework.h>
+#include <capture.h>
+#include <server.h>
+#include <config.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+_ReplayState ReplayState;
+
+// Initialize
+void _ReplayState::Init() {
+	std::unordered_map<uint32_t, ae::_Peer *> Peers;
+	std::vector<double> TickTimes;
+	_Server *Server = nullptr;
+	double TotalTime = 0.0;
+
+	try {
+
+		// Open capture and restore save database
+		_Capture Capture;
+		std::string SavePath = Config.ConfigPath + "replay.db";
+		Capture.StartPlayback(CapturePath, SavePath);
+
+		// Use the recorded config options
+		const _CaptureSettings &Settings = Capture.Settings;
+		Config.NetworkRate = Settings.NetworkRate;
+		Config.AutoSavePeriod = Settings.AutoSavePeriod;
+		Config.MapIdleTimeout = Settings.MapIdleTimeout;
+		Config.BotDecisionPeriod = Settings.BotDecisionPeriod;
+		Config.PathThreads = Settings.PathThreads;
+		Config.PathBudget = Settings.PathBudget;
+		Config.MinigameThreads = Settings.MinigameThreads;
+		Config.ObjectPool = Settings.ObjectPool;
+		Config.UpdateTiers = Settings.UpdateTiers;
+		Config.NativeBots = Settings.NativeBots;
+		Config.BatchMonsterAI = Settings.BatchMonsterAI;
+		Config.PreloadMaps = Settings.PreloadMaps;
+
+		// Create server on any free port without answering pings
+		Server = new _Server(0, SavePath, false);
+		Server->IsTesting = Settings.IsTesting;
+		Server->Hardcore = Settings.Hardcore;
+		Server->NoPVP = Settings.NoPVP;
+		std::istringstream RandomState(Capture.RandomState);
+		RandomState >> ae::RandomGenerator;
+		std::cout << "Replaying " << CapturePath << std::endl;
+
+		// Feed events into the server tick they were received on
+		_CaptureEvent Event;
+		bool HasEvent = Capture.ReadEvent(Event);
+		uint32_t Tick = 0;
+		while(HasEvent) {
+			Uint64 StartTime = SDL_GetPerformanceCounter();
+
+			while(HasEvent && Event.Tick == Tick) {
+
+				// Get fake peer
+				ae::_Peer *&Peer = Peers[Event.PeerID];
+				if(!Peer)
+					Peer = new ae::_Peer(nullptr);
+
+				// Build network event
+				ae::_NetworkEvent NetworkEvent;
+				NetworkEvent.Type = (decltype(NetworkEvent.Type))Event.Type;
+				NetworkEvent.EventData = Event.EventData;
+				NetworkEvent.Peer = Peer;
+				NetworkEvent.Data = nullptr;
+				if(NetworkEvent.Type == ae::_NetworkEvent::PACKET) {
+					NetworkEvent.Data = new ae::_Buffer();
+					NetworkEvent.Data->WriteData(Event.Data.data(), (unsigned int)Event.Data.size());
+					NetworkEvent.Data->StartRead();
+				}
+
+				Server->HandleNetworkEvent(NetworkEvent);
+
+				// Remove disconnected peer
+				if(NetworkEvent.Type == ae::_NetworkEvent::DISCONNECT) {
+					delete Peer;
+					Peers.erase(Event.PeerID);
+				}
+
+				HasEvent = Capture.ReadEvent(Event);
+			}
+
+			Server->Update(DEFAULT_TIMESTEP);
+
+			double TickTime = (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+			TickTimes.push_back(TickTime);
+			TotalTime += TickTime;
+			Tick++;
+		}
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	delete Server;
+	for(auto &Peer : Peers)
+		delete Peer.second;
+
+	ShowResults(TickTimes, TotalTime);
+
+	Framework.Done = true;
+}
+
+// Close
+void _ReplayState::Close() {
+}
+
+// Update
+void _ReplayState::Update(double FrameTime) {
+}
+
+// Print tick time distribution
+void _ReplayState::ShowResults(std::vector<double> &TickTimes, double TotalTime) {
+	if(TickTimes.empty())
+		return;
+
+	std::sort(TickTimes.begin(), TickTimes.end());
+	auto GetPercentile = [&TickTimes](double Percent) {
+		return TickTimes[std::min(TickTimes.size() - 1, (std::size_t)(TickTimes.size() * Percent))] * 1000.0;
+	};
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "ticks=" << TickTimes.size() << std::endl;
+	std::cout << "total=" << TotalTime << "s" << std::endl;
+	std::cout << "speedup=" << TickTimes.size() * DEFAULT_TIMESTEP / TotalTime << "x" << std::endl;
+	std::cout << "mean=" << TotalTime * 1000.0 / TickTimes.size() << "ms" << std::endl;
+	std::cout << "min=" << TickTimes.front() * 1000.0 << "ms" << std::endl;
+	std::cout << "p50=" << GetPercentile(0.5) << "ms" << std::endl;
+	std::cout << "p90=" << GetPercentile(0.9) << "ms" << std::endl;
+	std::cout << "p99=" << GetPercentile(0.99) << "ms" << std::endl;
+	std::cout << "p99.9=" << GetPercentile(0.999) << "ms" << std::endl;
+	std::cout << "max=" << TickTimes.back() * 1000.0 << "ms" << std::endl;
+}
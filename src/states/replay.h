@@ -0,0 +1,49 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <ae/state.h>
+#include <string>
+#include <vector>
+
+// Headless replay of a network capture
+class _ReplayState : public ae::_State {
+
+	public:
+
+		// Setup
+		void Init() override;
+		void Close() override;
+
+		// Update
+		void Update(double FrameTime) override;
+
+		// State parameters
+		void SetCapturePath(const std::string &Value) { this->CapturePath = Value; }
+
+	protected:
+
+		void ShowResults(std::vector<double> &TickTimes, double TotalTime);
+
+		// Parameters
+		std::string CapturePath;
+
+};
+
+extern _ReplayState ReplayState;
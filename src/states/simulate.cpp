@@ -0,0 +1,370 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <states/simulate.h>
+#include <ae/database.h>
+#include <objects/minigame.h>
+#include <framework.h>
+#include <stats.h>
+#include <constants.h>
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <map>
+
+const std::size_t MINIGAME_BUCKETS = 8;
+
+_SimulateState SimulateState;
+
+// Drop strategies
+enum MinigameStrategyType {
+	MINIGAME_RANDOM,
+	MINIGAME_BEST,
+	MINIGAME_STRATEGY_COUNT,
+};
+
+static const char *MinigameStrategyNames[MINIGAME_STRATEGY_COUNT] = { "random", "best" };
+
+// Minigame results from one thread
+struct _MinigameTotals {
+	_MinigameTotals() : Games(0), Payout(0), Time(0.0), Buckets(MINIGAME_BUCKETS + 1, 0) { }
+
+	int64_t Games;
+	int64_t Payout;
+	double Time;
+	std::vector<int64_t> Buckets;
+};
+
+// Battle rewards from one thread
+struct _RewardTotals {
+	_RewardTotals() : Battles(0), Monsters(0), Experience(0.0), Gold(0.0), Drops(0), MonsterCounts(BATTLE_MAX_OBJECTS_PER_SIDE + 1, 0) { }
+
+	int64_t Battles;
+	int64_t Monsters;
+	double Experience;
+	double Gold;
+	int64_t Drops;
+	std::vector<int64_t> MonsterCounts;
+};
+
+// Rewards given by a monster
+struct _MonsterReward {
+	int Experience;
+	int Gold;
+	std::vector<_ItemDrop> Drops;
+};
+
+// Open csv file for writing
+static void OpenFile(std::ofstream &File, const std::string &Path) {
+	File.open(Path, std::ios::out | std::ios::trunc);
+	if(!File)
+		throw std::runtime_error("Error opening file: " + Path);
+}
+
+// Get seconds since start time
+static double GetElapsedTime(Uint64 StartTime) {
+	return (SDL_GetPerformanceCounter() - StartTime) / (double)SDL_GetPerformanceFrequency();
+}
+
+// Constructor
+_SimulateState::_SimulateState() :
+	Count(10000),
+	ThreadCount(1),
+	Seed(0),
+	Stats(nullptr) {
+}
+
+// Initialize
+void _SimulateState::Init() {
+	try {
+		Stats = new _Stats(true);
+		ThreadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		Seed = SDL_GetPerformanceCounter();
+		std::cout << "count=" << Count << " threads=" << ThreadCount << " seed=" << Seed << std::endl;
+
+		SimulateMinigames();
+		SimulateItemDrops();
+		SimulateRewards();
+	}
+	catch(std::exception &Error) {
+		std::cerr << Error.what() << std::endl;
+	}
+
+	Framework.Done = true;
+}
+
+// Close
+void _SimulateState::Close() {
+	delete Stats;
+	Stats = nullptr;
+}
+
+// Update
+void _SimulateState::Update(double FrameTime) {
+}
+
+// Split jobs across threads, each with its own random stream
+void _SimulateState::RunThreads(const WorkType &Work) {
+	std::vector<std::thread> Threads;
+	for(int i = 0; i < ThreadCount; i++) {
+		int Jobs = Count / ThreadCount + (i < Count % ThreadCount);
+		Threads.emplace_back([this, &Work, i, Jobs] {
+			std::seed_seq Sequence{ (uint32_t)Seed, (uint32_t)(Seed >> 32), (uint32_t)i };
+			std::mt19937 Random(Sequence);
+			Work(i, Jobs, Random);
+		});
+	}
+
+	for(auto &Thread : Threads)
+		Thread.join();
+}
+
+// Play minigames with each strategy and record prize buckets
+void _SimulateState::SimulateMinigames() {
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+
+	// Sort by id
+	std::map<uint32_t, const _MinigameType *> Minigames;
+	for(const auto &Minigame : Stats->Minigames)
+		Minigames[Minigame.first] = &Minigame.second;
+
+	std::ofstream File;
+	OpenFile(File, "simulate_minigames.csv");
+	File << "minigame_id,name,strategy,games,cost,mean_payout,return,mean_time";
+	for(std::size_t i = 0; i < MINIGAME_BUCKETS; i++)
+		File << ",bucket_" << i;
+	File << ",miss" << std::endl;
+
+	for(const auto &Iterator : Minigames) {
+		const _MinigameType *Minigame = Iterator.second;
+		for(int Strategy = 0; Strategy < MINIGAME_STRATEGY_COUNT; Strategy++) {
+			std::vector<_MinigameTotals> Totals((std::size_t)ThreadCount);
+			RunThreads([&](int Thread, int Jobs, std::mt19937 &Random) {
+				_MinigameTotals &Total = Totals[(std::size_t)Thread];
+				std::uniform_int_distribution<uint32_t> SeedDistribution(1, std::numeric_limits<uint32_t>::max());
+				std::uniform_real_distribution<float> DropDistribution(-7.65f, 7.65f);
+				for(int i = 0; i < Jobs; i++) {
+					_Minigame Game(Minigame, true);
+					Game.StartGame(SeedDistribution(Random));
+
+					// Drop randomly or over highest value prize
+					float X = DropDistribution(Random);
+					if(Strategy == MINIGAME_BEST) {
+						int HighestPrizeIndex = 0;
+						int64_t HighestPrizeValue = 0;
+						for(std::size_t j = 0; j < Game.Prizes.size(); j++) {
+							const _MinigameItem *Prize = Game.Prizes[j];
+							if(Prize && Prize->Item && Prize->Item->Cost > HighestPrizeValue) {
+								HighestPrizeValue = Prize->Item->Cost;
+								HighestPrizeIndex = (int)j;
+							}
+						}
+
+						X = Game.Boundary.Start.x + 1 + HighestPrizeIndex * 2;
+					}
+					Game.Drop(X);
+
+					double Time = 0;
+					while(Time < MINIGAME_MAX_TIME) {
+						Game.Update(DEFAULT_TIMESTEP);
+						if(Game.State == _Minigame::StateType::DONE)
+							break;
+						Time += DEFAULT_TIMESTEP;
+					}
+
+					// Record bucket and prize value
+					Total.Games++;
+					Total.Time += Time;
+					if(Game.Bucket < Game.Prizes.size() && Game.Bucket < MINIGAME_BUCKETS) {
+						Total.Buckets[Game.Bucket]++;
+						const _MinigameItem *Prize = Game.Prizes[Game.Bucket];
+						if(Prize && Prize->Item)
+							Total.Payout += (int64_t)Prize->Item->Cost * Prize->Count;
+					}
+					else
+						Total.Buckets[MINIGAME_BUCKETS]++;
+				}
+			});
+
+			// Merge thread results
+			_MinigameTotals Sum;
+			for(const auto &Total : Totals) {
+				Sum.Games += Total.Games;
+				Sum.Payout += Total.Payout;
+				Sum.Time += Total.Time;
+				for(std::size_t i = 0; i < Sum.Buckets.size(); i++)
+					Sum.Buckets[i] += Total.Buckets[i];
+			}
+
+			double Games = std::max((int64_t)1, Sum.Games);
+			double MeanPayout = Sum.Payout / Games;
+			File << Minigame->ID << "," << Minigame->Name << "," << MinigameStrategyNames[Strategy] << "," << Sum.Games << "," << Minigame->Cost << "," << MeanPayout;
+			File << "," << (Minigame->Cost > 0 ? MeanPayout / Minigame->Cost : 0.0) << "," << Sum.Time / Games;
+			for(const auto &Bucket : Sum.Buckets)
+				File << "," << Bucket;
+			File << std::endl;
+		}
+	}
+
+	std::cout << "minigames=" << Minigames.size() << " time=" << GetElapsedTime(StartTime) << "s" << std::endl;
+}
+
+// Kill each monster with drops and count items
+void _SimulateState::SimulateItemDrops() {
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+
+	// Get monsters with drops
+	std::vector<uint32_t> MonsterIDs;
+	Stats->Database->PrepareQuery("SELECT DISTINCT monster_id FROM monsterdrop ORDER BY monster_id");
+	while(Stats->Database->FetchRow())
+		MonsterIDs.push_back(Stats->Database->GetInt<uint32_t>("monster_id"));
+	Stats->Database->CloseQuery();
+
+	// Load drop tables before starting threads
+	std::vector<std::vector<_ItemDrop>> Tables(MonsterIDs.size());
+	for(std::size_t i = 0; i < MonsterIDs.size(); i++)
+		Stats->GetItemDropTable(MonsterIDs[i], Tables[i]);
+
+	// Roll drops
+	std::vector<std::vector<std::map<uint32_t, int64_t>>> Counts((std::size_t)ThreadCount, std::vector<std::map<uint32_t, int64_t>>(MonsterIDs.size()));
+	RunThreads([&](int Thread, int Jobs, std::mt19937 &Random) {
+		std::vector<uint32_t> ItemDrops;
+		for(std::size_t i = 0; i < Tables.size(); i++) {
+			ItemDrops.clear();
+			_Stats::RollItemDrops(Tables[i], Jobs, 1.0f, ItemDrops, Random);
+			for(const auto &ItemID : ItemDrops)
+				Counts[(std::size_t)Thread][i][ItemID]++;
+		}
+	});
+
+	// Merge thread results and write
+	std::ofstream File;
+	OpenFile(File, "simulate_drops.csv");
+	File << "monster_id,item_id,kills,count,per_kill" << std::endl;
+	for(std::size_t i = 0; i < MonsterIDs.size(); i++) {
+		std::map<uint32_t, int64_t> Sum;
+		for(const auto &ThreadCounts : Counts) {
+			for(const auto &ItemCount : ThreadCounts[i])
+				Sum[ItemCount.first] += ItemCount.second;
+		}
+
+		for(const auto &ItemCount : Sum)
+			File << MonsterIDs[i] << "," << ItemCount.first << "," << Count << "," << ItemCount.second << "," << ItemCount.second / (double)std::max(1, Count) << std::endl;
+	}
+
+	std::cout << "monsters=" << MonsterIDs.size() << " time=" << GetElapsedTime(StartTime) << "s" << std::endl;
+}
+
+// Generate battles in each zone and total their rewards
+void _SimulateState::SimulateRewards() {
+	Uint64 StartTime = SDL_GetPerformanceCounter();
+
+	// Get zones with random spawns
+	std::vector<uint32_t> ZoneIDs;
+	Stats->Database->PrepareQuery("SELECT id FROM zone WHERE boss = 0 ORDER BY id");
+	while(Stats->Database->FetchRow())
+		ZoneIDs.push_back(Stats->Database->GetInt<uint32_t>("id"));
+	Stats->Database->CloseQuery();
+
+	// Load spawn tables
+	std::vector<_ZoneSpawns> Spawns(ZoneIDs.size());
+	for(std::size_t i = 0; i < ZoneIDs.size(); i++)
+		Stats->GetZoneSpawns(ZoneIDs[i], 0, 1.0f, Spawns[i]);
+
+	// Load monster rewards
+	std::unordered_map<uint32_t, _MonsterReward> Rewards;
+	Stats->Database->PrepareQuery("SELECT id, experience, gold FROM monster");
+	while(Stats->Database->FetchRow()) {
+		_MonsterReward &Reward = Rewards[Stats->Database->GetInt<uint32_t>("id")];
+		Reward.Experience = Stats->Database->GetInt<int>("experience");
+		Reward.Gold = Stats->Database->GetInt<int>("gold");
+	}
+	Stats->Database->CloseQuery();
+	for(auto &Reward : Rewards)
+		Stats->GetItemDropTable(Reward.first, Reward.second.Drops);
+
+	// Run battles
+	std::vector<std::vector<_RewardTotals>> Totals((std::size_t)ThreadCount, std::vector<_RewardTotals>(ZoneIDs.size()));
+	RunThreads([&](int Thread, int Jobs, std::mt19937 &Random) {
+		std::vector<_Zone> Monsters;
+		std::vector<uint32_t> ItemDrops;
+		Monsters.reserve(BATTLE_MAX_OBJECTS_PER_SIDE);
+		for(std::size_t i = 0; i < Spawns.size(); i++) {
+			_RewardTotals &Total = Totals[(std::size_t)Thread][i];
+			for(int j = 0; j < Jobs; j++) {
+				Monsters.clear();
+				_Stats::RollZoneMonsters(Spawns[i], Monsters, Random);
+
+				// Sum rewards like _Battle::ServerEndBattle
+				float Experience = 0.0f;
+				float Gold = 0.0f;
+				ItemDrops.clear();
+				for(const auto &Monster : Monsters) {
+					const auto &Iterator = Rewards.find(Monster.MonsterID);
+					if(Iterator == Rewards.end())
+						continue;
+
+					float DifficultyMultiplier = (100 + Monster.Difficulty) * 0.01f;
+					Experience += Iterator->second.Experience * DifficultyMultiplier;
+					Gold += Iterator->second.Gold * DifficultyMultiplier;
+					_Stats::RollItemDrops(Iterator->second.Drops, 1, 1.0f, ItemDrops, Random);
+				}
+
+				Total.Battles++;
+				Total.Monsters += (int64_t)Monsters.size();
+				Total.Experience += std::ceil(Experience);
+				Total.Gold += std::ceil(Gold);
+				Total.Drops += (int64_t)ItemDrops.size();
+				Total.MonsterCounts[std::min(Monsters.size(), (std::size_t)BATTLE_MAX_OBJECTS_PER_SIDE)]++;
+			}
+		}
+	});
+
+	// Merge thread results and write
+	std::ofstream File;
+	OpenFile(File, "simulate_rewards.csv");
+	File << "zone_id,battles,mean_monsters,mean_experience,mean_gold,mean_drops";
+	for(int i = 0; i <= BATTLE_MAX_OBJECTS_PER_SIDE; i++)
+		File << ",monsters_" << i;
+	File << std::endl;
+	for(std::size_t i = 0; i < ZoneIDs.size(); i++) {
+		_RewardTotals Sum;
+		for(const auto &ThreadTotals : Totals) {
+			const _RewardTotals &Total = ThreadTotals[i];
+			Sum.Battles += Total.Battles;
+			Sum.Monsters += Total.Monsters;
+			Sum.Experience += Total.Experience;
+			Sum.Gold += Total.Gold;
+			Sum.Drops += Total.Drops;
+			for(std::size_t j = 0; j < Sum.MonsterCounts.size(); j++)
+				Sum.MonsterCounts[j] += Total.MonsterCounts[j];
+		}
+
+		double Battles = std::max((int64_t)1, Sum.Battles);
+		File << ZoneIDs[i] << "," << Sum.Battles << "," << Sum.Monsters / Battles << "," << Sum.Experience / Battles << "," << Sum.Gold / Battles << "," << Sum.Drops / Battles;
+		for(const auto &MonsterCount : Sum.MonsterCounts)
+			File << "," << MonsterCount;
+		File << std::endl;
+	}
+
+	std::cout << "zones=" << ZoneIDs.size() << " time=" << GetElapsedTime(StartTime) << "s" << std::endl;
+}
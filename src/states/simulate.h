@@ -0,0 +1,65 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <ae/state.h>
+#include <functional>
+#include <random>
+#include <cstdint>
+
+// Forward Declarations
+class _Stats;
+
+// Headless monte carlo runs for minigame and economy balancing
+class _SimulateState : public ae::_State {
+
+	public:
+
+		_SimulateState();
+
+		// Setup
+		void Init() override;
+		void Close() override;
+
+		// Update
+		void Update(double FrameTime) override;
+
+		// State parameters
+		void SetCount(int Value) { Count = Value; }
+
+	protected:
+
+		typedef std::function<void(int Thread, int Jobs, std::mt19937 &Random)> WorkType;
+
+		void SimulateMinigames();
+		void SimulateItemDrops();
+		void SimulateRewards();
+		void RunThreads(const WorkType &Work);
+
+		// Parameters
+		int Count;
+		int ThreadCount;
+		uint64_t Seed;
+
+		// Data
+		_Stats *Stats;
+
+};
+
+extern _SimulateState SimulateState;
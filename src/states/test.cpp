@@ -30,6 +30,7 @@
 #include <SDL_mouse.h>
 #include <SDL_timer.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <iostream>
 
 _TestState TestState;
 
@@ -37,7 +38,8 @@ _TestState TestState;
 _TestState::_TestState() :
 	Camera(nullptr),
 	Stats(nullptr),
-	Minigame(nullptr) {
+	Minigame(nullptr),
+	Verify(false) {
 }
 
 // Initialize
@@ -60,7 +62,7 @@ void _TestState::Init() {
 		std::map<uint32_t, int> Count;
 		std::vector<uint32_t> ItemDrops;
 		ItemDrops.reserve(Samples * Rate);
-		Stats->GenerateItemDrops(MonsterID, Samples, ItemDrops, Rate);
+		Stats->GenerateItemDrops(MonsterID, Samples, ItemDrops, Rate, ae::RandomGenerator);
 		for(std::size_t j = 0; j < ItemDrops.size(); j++) {
 			Count[ItemDrops[j]]++;
 		}
@@ -83,12 +85,13 @@ void _TestState::Init() {
 
 	// time ./choria -test | gawk 'BEGIN{cost=10;IFS=OFS="\t";print "runs", "time", "cost", "sold", "profit", "gold/min"} { time+=$1; total+=int($2/2) } END{ prof=(total-NR*cost); print NR, time, NR*cost, total, prof, 60*prof/time }'
 	int Simulations = 100000;
+	int Mismatches = 0;
+	Uint64 SimulationStartTime = SDL_GetPerformanceCounter();
 	for(int i = 0; i < Simulations; i++) {
 		//double StartTime = SDL_GetPerformanceCounter();
-		uint32_t Seed = ae::GetRandomInt((uint32_t)1, std::numeric_limits<uint32_t>::max());
+		uint32_t Seed = Verify ? (uint32_t)(i + 1) : ae::GetRandomInt((uint32_t)1, std::numeric_limits<uint32_t>::max());
 
-		Minigame = new _Minigame(&Stats->Minigames.at(1));
-		Minigame->IsServer = true;
+		Minigame = new _Minigame(&Stats->Minigames.at(1), true);
 		Minigame->Debug = 0;
 		Minigame->StartGame(Seed);
 
@@ -142,6 +145,27 @@ void _TestState::Init() {
 
 		//std::cout << Minigame->Bounces << std::endl;
 
+		// Compare against sprite list physics
+		if(Verify) {
+			_Minigame Reference(&Stats->Minigames.at(1), true);
+			Reference.ReferencePhysics = true;
+			Reference.StartGame(Seed);
+			Reference.Drop(X);
+
+			double ReferenceTime = 0;
+			while(ReferenceTime < 30) {
+				Reference.Update(DEFAULT_TIMESTEP);
+				if(Reference.State == _Minigame::StateType::DONE)
+					break;
+				ReferenceTime += DEFAULT_TIMESTEP;
+			}
+
+			if(Reference.Bucket != Minigame->Bucket || Reference.Bounces != Minigame->Bounces || ReferenceTime != Time) {
+				std::cerr << "mismatch seed=" << Seed << " x=" << X << " bucket=" << Minigame->Bucket << " reference_bucket=" << Reference.Bucket << std::endl;
+				Mismatches++;
+			}
+		}
+
 		if(Minigame->Bucket < Minigame->Prizes.size()) {
 			const _MinigameItem *MinigameItem = Minigame->Prizes[Minigame->Bucket];
 			if(MinigameItem && MinigameItem->Item) {
@@ -159,6 +183,16 @@ void _TestState::Init() {
 
 	Minigame = nullptr;
 
+	double SimulationTime = (SDL_GetPerformanceCounter() - SimulationStartTime) / (double)SDL_GetPerformanceFrequency();
+	std::cerr << "simulations=" << Simulations << " time=" << SimulationTime << "s";
+	if(Verify)
+		std::cerr << " mismatches=" << Mismatches;
+	std::cerr << std::endl;
+
+	// Fail verify runs on any mismatch
+	if(Mismatches)
+		Framework.ExitCode = 1;
+
 	Framework.Done = true;
 
 	//Minigame = new _Minigame(&Stats->Minigames.at(1));
@@ -58,6 +58,7 @@ class _TestState : public ae::_State {
 		const _Stats *Stats;
 		_Minigame *Minigame;
 		double Time;
+		bool Verify;
 
 	protected:
 
@@ -728,184 +728,90 @@ void _Stats::GetZone(uint32_t ZoneID, _Zone &Zone) const {
 }
 
 // Randomly generates a list of monsters from a zone
-void _Stats::GenerateMonsterListFromZone(int AdditionalCount, float MonsterCountModifier, uint32_t ZoneID, std::list<_Zone> &Monsters, bool &Boss, double &Cooldown) const {
+void _Stats::GenerateMonsterListFromZone(int AdditionalCount, float MonsterCountModifier, uint32_t ZoneID, _ScratchList<_Zone> &Monsters, bool &Boss, double &Cooldown, std::mt19937 &Random) const {
 	if(ZoneID == 0)
 		return;
 
+	_ZoneSpawns Spawns;
+	GetZoneSpawns(ZoneID, AdditionalCount, MonsterCountModifier, Spawns);
+	Boss = Spawns.Boss;
+	Cooldown = Spawns.Cooldown;
+
+	RollZoneMonsters(Spawns, Monsters, Random);
+}
+
+// Load spawn table for a zone
+void _Stats::GetZoneSpawns(uint32_t ZoneID, int AdditionalCount, float MonsterCountModifier, _ZoneSpawns &Spawns) const {
+	Spawns.AdditionalCount = AdditionalCount;
+	Spawns.MonsterCountModifier = MonsterCountModifier;
+
 	// Get zone info
 	Database->PrepareQuery("SELECT boss, cooldown, minspawn, maxspawn FROM zone WHERE id = @zone_id");
 	Database->BindInt(1, ZoneID);
-
-	// Get spawn range
-	int MinSpawn = 0;
-	int MaxSpawn = 0;
 	if(Database->FetchRow()) {
-		Boss = Database->GetInt<int>("boss");
-		Cooldown = Database->GetReal("cooldown");
-		MinSpawn = Database->GetInt<int>("minspawn");
-		MaxSpawn = Database->GetInt<int>("maxspawn");
+		Spawns.Boss = Database->GetInt<int>("boss");
+		Spawns.Cooldown = Database->GetReal("cooldown");
+		Spawns.MinSpawn = Database->GetInt<int>("minspawn");
+		Spawns.MaxSpawn = Database->GetInt<int>("maxspawn");
 	}
 	Database->CloseQuery();
 
-	// If boss zone then use odds parameter as monster count
-	if(Boss) {
-
-		for(int i = 0; i < (int)MonsterCountModifier; i++) {
-
-			// Run query
-			Database->PrepareQuery("SELECT monster_id, odds, difficulty FROM zonedata WHERE zone_id = @zone_id");
-			Database->BindInt(1, ZoneID);
-			while(Database->FetchRow()) {
-				_Zone ZoneData;
-				ZoneData.MonsterID = Database->GetInt<uint32_t>("monster_id");
-				ZoneData.Difficulty = Database->GetInt<int>("difficulty");
-				uint32_t Count = Database->GetInt<uint32_t>("odds");
-
-				// Populate monster list
-				for(uint32_t i = 0; i < Count; i++) {
-					if(Monsters.size() < BATTLE_MAX_OBJECTS_PER_SIDE)
-						Monsters.push_back(ZoneData);
-					else
-						break;
-				}
-			}
-			Database->CloseQuery();
+	// Get monsters in zone
+	Database->PrepareQuery("SELECT * FROM zonedata WHERE zone_id = @zone_id");
+	Database->BindInt(1, ZoneID);
+	while(Database->FetchRow()) {
+		_Zone ZoneData;
+		ZoneData.MonsterID = Database->GetInt<uint32_t>("monster_id");
+		ZoneData.Odds = Database->GetInt<uint32_t>("odds");
+		ZoneData.Max = Database->GetInt<int>("max");
+		ZoneData.Difficulty = Database->GetInt<int>("difficulty");
+
+		// Boss zones use odds as monster count
+		if(Spawns.Boss) {
+			Spawns.Monsters.push_back(ZoneData);
+			continue;
 		}
-	}
-	else {
-
-		// Get monster count
-		int MonsterCount = ae::GetRandomInt(MinSpawn, MaxSpawn);
-		MonsterCount *= MonsterCountModifier;
-
-		// No monsters
-		if(MonsterCount <= 0)
-			return;
-
-		MonsterCount += AdditionalCount;
-
-		// Cap monster count
-		MonsterCount = std::min(MonsterCount, BATTLE_MAX_OBJECTS_PER_SIDE);
-
-		// Run query
-		Database->PrepareQuery("SELECT * FROM zonedata WHERE zone_id = @zone_id");
-		Database->BindInt(1, ZoneID);
-
-		// Get monsters in zone
-		std::vector<_Zone> Zone;
-		uint32_t OddsSum = 0;
-		int MaxTotal = 0;
-		bool AllMaxCount = true;
-		while(Database->FetchRow()) {
-
-			// Get zone data
-			_Zone ZoneData;
-			ZoneData.MonsterID = Database->GetInt<uint32_t>("monster_id");
-			ZoneData.Odds = Database->GetInt<uint32_t>("odds");
-			ZoneData.Max = Database->GetInt<int>("max");
-			ZoneData.Difficulty = Database->GetInt<int>("difficulty");
-
-			// Increase max
-			ZoneData.Max *= MonsterCountModifier;
-
-			// Increase max for each player if set
-			if(ZoneData.Max > 0) {
-				MaxTotal += ZoneData.Max + AdditionalCount;
-				ZoneData.Max += AdditionalCount;
-			}
-			else
-				AllMaxCount = false;
 
-			OddsSum += ZoneData.Odds;
-			ZoneData.Odds = OddsSum;
-			Zone.push_back(ZoneData);
-		}
-		Database->CloseQuery();
-
-		// Check for monsters in zone
-		if(OddsSum > 0) {
-
-			// Cap monster count if all monsters have a max set
-			if(AllMaxCount)
-				MonsterCount = std::min(MaxTotal, MonsterCount);
-
-			// Generate monsters
-			std::unordered_map<uint32_t, int> MonsterTotals;
-			while((int)Monsters.size() < MonsterCount) {
-
-				// Find monster in CDT
-				uint32_t RandomNumber = ae::GetRandomInt((uint32_t)1, OddsSum);
-				for(const auto &ZoneData : Zone) {
-					if(RandomNumber <= ZoneData.Odds) {
-
-						// Check monster max
-						if(ZoneData.Max == 0 || (ZoneData.Max > 0 && MonsterTotals[ZoneData.MonsterID] < ZoneData.Max)) {
-							MonsterTotals[ZoneData.MonsterID]++;
-							Monsters.push_back(ZoneData);
-						}
-						break;
-					}
-				}
-			}
+		// Increase max
+		ZoneData.Max *= MonsterCountModifier;
+
+		// Increase max for each player if set
+		if(ZoneData.Max > 0) {
+			Spawns.MaxTotal += ZoneData.Max + AdditionalCount;
+			ZoneData.Max += AdditionalCount;
 		}
+		else
+			Spawns.AllMaxCount = false;
+
+		// Build CDT
+		Spawns.OddsSum += ZoneData.Odds;
+		ZoneData.Odds = Spawns.OddsSum;
+		Spawns.Monsters.push_back(ZoneData);
 	}
+	Database->CloseQuery();
 }
 
 // Generates a list of items dropped from a monster
-void _Stats::GenerateItemDrops(uint32_t MonsterID, int Count, std::vector<uint32_t> &ItemDrops, float DropRate) const {
+void _Stats::GenerateItemDrops(uint32_t MonsterID, int Count, std::vector<uint32_t> &ItemDrops, float DropRate, std::mt19937 &Random) const {
 	if(MonsterID == 0)
 		return;
 
-	// Run query to generate CDT
+	std::vector<_ItemDrop> Table;
+	GetItemDropTable(MonsterID, Table);
+	RollItemDrops(Table, Count, DropRate, ItemDrops, Random);
+}
+
+// Load cumulative drop table for a monster
+void _Stats::GetItemDropTable(uint32_t MonsterID, std::vector<_ItemDrop> &Table) const {
 	Database->PrepareQuery("SELECT item_id, SUM(odds) OVER (ROWS UNBOUNDED PRECEDING) AS cdt FROM monsterdrop WHERE monster_id = @monster_id");
 	Database->BindInt(1, MonsterID);
-
-	// Get list of possible drops
-	std::vector<_ItemDrop> PossibleItemDrops;
-	PossibleItemDrops.reserve(10);
-	int OddsSum = 0;
+	Table.reserve(10);
 	while(Database->FetchRow()) {
 		uint32_t ItemID = Database->GetInt<uint32_t>("item_id");
-		OddsSum = Database->GetInt<int>("cdt");
-		PossibleItemDrops.push_back(_ItemDrop(ItemID, OddsSum));
+		int OddsSum = Database->GetInt<int>("cdt");
+		Table.push_back(_ItemDrop(ItemID, OddsSum));
 	}
 	Database->CloseQuery();
-
-	// Check for items
-	if(OddsSum <= 0)
-		return;
-
-	// Generate items
-	for(int i = 0; i < Count; i++) {
-		int Rolls = (int)DropRate;
-
-		// Check for extra roll
-		double MultiOdds = DropRate - (int)DropRate;
-		double MultiRoll = ae::GetRandomReal(0, 1);
-		if(MultiRoll <= MultiOdds)
-			Rolls++;
-
-		// Roll for drops
-		for(int j = 0; j < Rolls; j++) {
-			int Roll = ae::GetRandomInt(1, OddsSum);
-
-			// Find item id in CDT
-			for(auto &MonsterDrop : PossibleItemDrops) {
-
-				// Check roll
-				if(Roll > MonsterDrop.Odds)
-					continue;
-
-				// Got nothing
-				if(!MonsterDrop.ItemID)
-					break;
-
-				// Add item
-				ItemDrops.push_back(MonsterDrop.ItemID);
-				break;
-			}
-		}
-	}
 }
 
 // Get map id by path
@@ -19,7 +19,11 @@
 
 // Libraries
 #include <objects/item.h>
+#include <arena.h>
+#include <constants.h>
 #include <unordered_map>
+#include <algorithm>
+#include <random>
 #include <list>
 #include <vector>
 #include <glm/vec3.hpp>
@@ -165,6 +169,21 @@ struct _ItemDrop {
 	int Odds;
 };
 
+struct _ZoneSpawns {
+	_ZoneSpawns() : OddsSum(0), MinSpawn(0), MaxSpawn(0), MaxTotal(0), AllMaxCount(true), Boss(false), Cooldown(0.0), AdditionalCount(0), MonsterCountModifier(1.0f) { }
+
+	std::vector<_Zone> Monsters;
+	uint32_t OddsSum;
+	int MinSpawn;
+	int MaxSpawn;
+	int MaxTotal;
+	bool AllMaxCount;
+	bool Boss;
+	double Cooldown;
+	int AdditionalCount;
+	float MonsterCountModifier;
+};
+
 struct _LightType {
 	uint32_t ID;
 	std::string Name;
@@ -207,8 +226,12 @@ class _Stats {
 
 		// Monsters
 		void GetZone(uint32_t ZoneID, _Zone &Zone) const;
-		void GenerateMonsterListFromZone(int AdditionalCount, float MonsterCountModifier, uint32_t ZoneID, std::list<_Zone> &Monsters, bool &Boss, double &Cooldown) const;
-		void GenerateItemDrops(uint32_t MonsterID, int Count, std::vector<uint32_t> &ItemDrops, float DropRate) const;
+		void GenerateMonsterListFromZone(int AdditionalCount, float MonsterCountModifier, uint32_t ZoneID, _ScratchList<_Zone> &Monsters, bool &Boss, double &Cooldown, std::mt19937 &Random) const;
+		void GenerateItemDrops(uint32_t MonsterID, int Count, std::vector<uint32_t> &ItemDrops, float DropRate, std::mt19937 &Random) const;
+		void GetZoneSpawns(uint32_t ZoneID, int AdditionalCount, float MonsterCountModifier, _ZoneSpawns &Spawns) const;
+		void GetItemDropTable(uint32_t MonsterID, std::vector<_ItemDrop> &Table) const;
+		template<typename ListType, typename GeneratorType> static void RollZoneMonsters(const _ZoneSpawns &Spawns, ListType &Monsters, GeneratorType &Random);
+		template<typename GeneratorType> static void RollItemDrops(const std::vector<_ItemDrop> &Table, int Count, float DropRate, std::vector<uint32_t> &ItemDrops, GeneratorType &Random);
 
 		// Maps
 		uint32_t GetMapIDByPath(const std::string &Path) const;
@@ -269,3 +292,101 @@ class _Stats {
 		void LoadLights();
 
 };
+
+// Roll a list of monsters from a zone spawn table
+template<typename ListType, typename GeneratorType> void _Stats::RollZoneMonsters(const _ZoneSpawns &Spawns, ListType &Monsters, GeneratorType &Random) {
+
+	// Boss zones use odds as monster count
+	if(Spawns.Boss) {
+		for(int i = 0; i < (int)Spawns.MonsterCountModifier; i++) {
+			for(const auto &ZoneData : Spawns.Monsters) {
+				for(uint32_t j = 0; j < ZoneData.Odds; j++) {
+					if((int)Monsters.size() < BATTLE_MAX_OBJECTS_PER_SIDE)
+						Monsters.push_back(ZoneData);
+					else
+						break;
+				}
+			}
+		}
+
+		return;
+	}
+
+	// Get monster count
+	int MonsterCount = std::uniform_int_distribution<int>(Spawns.MinSpawn, Spawns.MaxSpawn)(Random);
+	MonsterCount *= Spawns.MonsterCountModifier;
+
+	// No monsters
+	if(MonsterCount <= 0 || Spawns.OddsSum == 0)
+		return;
+
+	MonsterCount += Spawns.AdditionalCount;
+
+	// Cap monster count
+	MonsterCount = std::min(MonsterCount, BATTLE_MAX_OBJECTS_PER_SIDE);
+	if(Spawns.AllMaxCount)
+		MonsterCount = std::min(Spawns.MaxTotal, MonsterCount);
+
+	// Generate monsters
+	std::uniform_int_distribution<uint32_t> Distribution(1, Spawns.OddsSum);
+	std::unordered_map<uint32_t, int> MonsterTotals;
+	while((int)Monsters.size() < MonsterCount) {
+
+		// Find monster in CDT
+		uint32_t RandomNumber = Distribution(Random);
+		for(const auto &ZoneData : Spawns.Monsters) {
+			if(RandomNumber <= ZoneData.Odds) {
+
+				// Check monster max
+				if(ZoneData.Max == 0 || (ZoneData.Max > 0 && MonsterTotals[ZoneData.MonsterID] < ZoneData.Max)) {
+					MonsterTotals[ZoneData.MonsterID]++;
+					Monsters.push_back(ZoneData);
+				}
+				break;
+			}
+		}
+	}
+}
+
+// Roll item drops from a monster drop table
+template<typename GeneratorType> void _Stats::RollItemDrops(const std::vector<_ItemDrop> &Table, int Count, float DropRate, std::vector<uint32_t> &ItemDrops, GeneratorType &Random) {
+
+	// Check for items
+	int OddsSum = Table.empty() ? 0 : Table.back().Odds;
+	if(OddsSum <= 0)
+		return;
+
+	// Generate items
+	std::uniform_real_distribution<double> MultiDistribution(0.0, 1.0);
+	std::uniform_int_distribution<int> RollDistribution(1, OddsSum);
+	for(int i = 0; i < Count; i++) {
+		int Rolls = (int)DropRate;
+
+		// Check for extra roll
+		double MultiOdds = DropRate - (int)DropRate;
+		double MultiRoll = MultiDistribution(Random);
+		if(MultiRoll <= MultiOdds)
+			Rolls++;
+
+		// Roll for drops
+		for(int j = 0; j < Rolls; j++) {
+			int Roll = RollDistribution(Random);
+
+			// Find item id in CDT
+			for(auto &MonsterDrop : Table) {
+
+				// Check roll
+				if(Roll > MonsterDrop.Odds)
+					continue;
+
+				// Got nothing
+				if(!MonsterDrop.ItemID)
+					break;
+
+				// Add item
+				ItemDrops.push_back(MonsterDrop.ItemID);
+				break;
+			}
+		}
+	}
+}
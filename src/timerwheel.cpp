@@ -0,0 +1,79 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#include <timerwheel.h>
+#include <algorithm>
+#include <cmath>
+
+// Constructor
+_TimerWheel::_TimerWheel(double Resolution) :
+	Count(0),
+	CurrentTick(0),
+	Resolution(Resolution) {
+}
+
+// Schedule an event to fire after a delay, events past the last level fire early and must be rescheduled
+void _TimerWheel::Schedule(double Time, double Delay, const _TimerEvent &Event) {
+	_Entry Entry;
+	Entry.Tick = std::max((uint64_t)std::ceil((Time + Delay) / Resolution), CurrentTick + 1);
+	Entry.Event = Event;
+	Insert(Entry);
+	Count++;
+}
+
+// Advance to a time and collect events that fired
+void _TimerWheel::Update(double Time, std::vector<_TimerEvent> &Expired) {
+	uint64_t TargetTick = (uint64_t)(Time / Resolution);
+	while(CurrentTick < TargetTick) {
+		CurrentTick++;
+
+		// Move entries down from higher levels when a lower level wraps
+		for(int Level = 1; Level < LEVELS; Level++) {
+			if(CurrentTick & ((1ull << (SLOT_BITS * Level)) - 1))
+				break;
+
+			std::vector<_Entry> Entries;
+			Entries.swap(Slots[Level][(CurrentTick >> (SLOT_BITS * Level)) & SLOT_MASK]);
+			for(const auto &Entry : Entries)
+				Insert(Entry);
+		}
+
+		// Fire current slot
+		std::vector<_Entry> &Slot = Slots[0][CurrentTick & SLOT_MASK];
+		for(const auto &Entry : Slot)
+			Expired.push_back(Entry.Event);
+
+		Count -= Slot.size();
+		Slot.clear();
+	}
+}
+
+// Place an entry in the lowest level that can hold its delay
+void _TimerWheel::Insert(const _Entry &Entry) {
+	_Entry Placed = Entry;
+
+	// Clamp delays beyond the top level
+	uint64_t MaxDelay = (1ull << (SLOT_BITS * LEVELS)) - 1;
+	if(Placed.Tick - CurrentTick > MaxDelay)
+		Placed.Tick = CurrentTick + MaxDelay;
+
+	int Level = 0;
+	while(Level < LEVELS - 1 && Placed.Tick - CurrentTick >= (1ull << (SLOT_BITS * (Level + 1))))
+		Level++;
+
+	Slots[Level][(Placed.Tick >> (SLOT_BITS * Level)) & SLOT_MASK].push_back(Placed);
+}
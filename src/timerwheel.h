@@ -0,0 +1,63 @@
+/******************************************************************************
+* choria - https://github.com/jazztickets/choria
+* Copyright (C) 2021 Alan Witkowski
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#pragma once
+
+// Libraries
+#include <cstdint>
+#include <vector>
+
+// Timer that fired
+struct _TimerEvent {
+	uint32_t ObjectID;
+	uint32_t Type;
+	uint32_t ID;
+};
+
+// Hierarchical timer wheel, scheduling cost does not depend on the number of timers
+class _TimerWheel {
+
+	public:
+
+		_TimerWheel(double Resolution);
+
+		void Schedule(double Time, double Delay, const _TimerEvent &Event);
+		void Update(double Time, std::vector<_TimerEvent> &Expired);
+
+		// Attributes
+		std::size_t Count;
+
+	private:
+
+		static const int LEVELS = 4;
+		static const int SLOT_BITS = 6;
+		static const uint64_t SLOT_COUNT = 1 << SLOT_BITS;
+		static const uint64_t SLOT_MASK = SLOT_COUNT - 1;
+
+		struct _Entry {
+			uint64_t Tick;
+			_TimerEvent Event;
+		};
+
+		void Insert(const _Entry &Entry);
+
+		// Slots for each level
+		std::vector<_Entry> Slots[LEVELS][SLOT_COUNT];
+		uint64_t CurrentTick;
+		double Resolution;
+
+};